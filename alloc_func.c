@@ -0,0 +1,394 @@
+/*
+*  alloc_func.c
+*  airflow allocation functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO SHARE AIRFLOW BETWEEN FANS       */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "alloc_func.h"
+
+// Including other necessary custom headers
+#include "globals.h"
+
+static struct AllocFan Fans[AllocMaxFans];     // Models of the fans
+static int FanCount;                            // Fans sharing the airflow
+static float Cube[AllocMaxFans];               // Power per RPM cubed
+static float Weight[AllocMaxFans];             // Speed per unit of the allocation scale
+static float Limit[AllocMaxFans];              // Scale at which each fan reaches full speed
+static int Stalled[AllocMaxFans];              // AllocTurning, AllocRestarting or AllocStopped
+static float Allocated[AllocMaxFans];          // Allocated speed of each fan in RPM
+
+// Solution kept from one allocation to the next
+static int Order[AllocMaxFans];    // Fans in use, in the order in which they reach full speed
+static int InUse;                   // Number of fans in Order
+static int Knee;                    // Fans at full speed in the last allocation
+static float Demand = -1;           // Airflow last allocated
+
+/*
+* Function: Root
+* --------------------------------
+* Takes the square root of a positive number by Newton's method, so
+* that the maths library is not needed. Only used when the models are
+* read.
+*
+* Value: The number.
+*
+* Returns: Its square root.
+*/
+
+static float Root(float Value)
+{
+
+    float Estimate = (Value > 1) ? Value : 1;
+    int i;
+
+    for (i = 0; i < 64; i++)
+    {
+        Estimate = 0.5f*(Estimate + Value/Estimate);
+    }
+
+    return Estimate;
+}
+
+/*
+* Function: Arrange
+* --------------------------------
+* Lists the fans that are not stalled in the order in which they reach
+* full speed as the allocation scale grows.
+*/
+
+static void Arrange(void)
+{
+
+    int Fan;
+    int i;
+
+    InUse = 0;
+    for (Fan = 0; Fan < FanCount; Fan++)
+    {
+        if (Stalled[Fan])
+        {
+            continue;
+        }
+        for (i = InUse; i > 0 && Limit[Order[i - 1]] > Limit[Fan]; i--)
+        {
+            Order[i] = Order[i - 1];
+        }
+        Order[i] = Fan;
+        InUse++;
+    }
+    Knee = (Knee > InUse) ? InUse : Knee;
+
+}
+
+/*
+* Function: Solve
+* --------------------------------
+* Shares the demanded airflow between the fans in use at the least
+* total power. With power growing with the cube of the speed and
+* airflow in proportion to it, the marginal power per unit of airflow
+* is equal across the fans when each turns at Weight times a common
+* scale, the square root of its airflow per unit of power; fans that
+* would pass full speed are held there and the scale is raised for the
+* rest. The fans at full speed are kept from the last allocation and
+* moved one at a time, so a small change of demand is solved in one or
+* two steps and no solve takes more than about 2*AllocMaxFans.
+*/
+
+static void Solve(void)
+{
+
+    float Saturated = 0; // Airflow of the fans at full speed
+    float Free = 0; // Airflow per unit of scale of the other fans
+    float Scale = 0; // Common scale of the other fans
+    int Step; // Fans moved to or from full speed, bounded against rounding
+    int Fan;
+    int i;
+
+    for (i = 0; i < InUse; i++)
+    {
+        Fan = Order[i];
+        if (i < Knee)
+        {
+            Saturated += Fans[Fan].Airflow*Fans[Fan].Speed[AllocCurvePoints - 1];
+        }
+        else
+        {
+            Free += Fans[Fan].Airflow*Weight[Fan];
+        }
+    }
+
+    for (Step = 0; Step <= 2*AllocMaxFans && Demand > 0; Step++)
+    {
+        Scale = (Knee < InUse) ? (Demand - Saturated)/Free : 0;
+        // The next fan in the order would pass full speed
+        if (Knee < InUse && Scale > Limit[Order[Knee]])
+        {
+            Fan = Order[Knee++];
+            Saturated += Fans[Fan].Airflow*Fans[Fan].Speed[AllocCurvePoints - 1];
+            Free -= Fans[Fan].Airflow*Weight[Fan];
+        }
+        // The last fan at full speed is no longer needed there
+        else if (Knee > 0 && ((Knee == InUse) ? (Demand < Saturated) : (Scale < Limit[Order[Knee - 1]])))
+        {
+            Fan = Order[--Knee];
+            Saturated -= Fans[Fan].Airflow*Fans[Fan].Speed[AllocCurvePoints - 1];
+            Free += Fans[Fan].Airflow*Weight[Fan];
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    for (Fan = 0; Fan < FanCount; Fan++)
+    {
+        Allocated[Fan] = 0;
+    }
+    for (i = 0; i < InUse && Demand > 0; i++)
+    {
+        Fan = Order[i];
+        Allocated[Fan] = (i < Knee) ? Fans[Fan].Speed[AllocCurvePoints - 1] : Scale*Weight[Fan];
+    }
+
+}
+
+/*
+* Function: AllocLoad
+* --------------------------------
+* Reads the models of the fans from a file, one fan per line in the
+* order the fans are driven:
+*
+*   AIRFLOW POWER S0 S10 S20 ... S100
+*
+* AIRFLOW is the airflow per RPM (in any unit, the same for every
+* fan), POWER the power at full speed in watts and S0 to S100 the
+* speed in RPM measured at duty cycles of 0 to 100 percent in steps of
+* 10, which must not fall. Lines starting with # are ignored.
+*
+* Path: The file.
+* Count: The number of fans.
+*
+* Returns: 1 if a model was read for every fan or 0 if not.
+*/
+
+int AllocLoad(const char *Path, int Count)
+{
+
+    FILE *File = fopen(Path, "r");
+    char Line[256];
+    struct AllocFan *Model;
+    float Full; // Speed at full duty
+    int Fields;
+    int i;
+
+    if (File == NULL || Count > AllocMaxFans)
+    {
+        if (File != NULL)
+        {
+            fclose(File);
+        }
+        return 0;
+    }
+
+    FanCount = 0;
+    while (FanCount < Count && fgets(Line, sizeof(Line), File) != NULL)
+    {
+        Model = &Fans[FanCount];
+        Fields = sscanf(Line, "%f %f %d %d %d %d %d %d %d %d %d %d %d", &Model->Airflow, &Model->Power,
+                        &Model->Speed[0], &Model->Speed[1], &Model->Speed[2], &Model->Speed[3],
+                        &Model->Speed[4], &Model->Speed[5], &Model->Speed[6], &Model->Speed[7],
+                        &Model->Speed[8], &Model->Speed[9], &Model->Speed[10]);
+        if (Line[0] == '#' || Fields <= 0)
+        {
+            continue;
+        }
+        if (Fields != 2 + AllocCurvePoints || Model->Airflow <= 0 || Model->Power <= 0 ||
+            Model->Speed[AllocCurvePoints - 1] <= 0)
+        {
+            break;
+        }
+        for (i = 1; i < AllocCurvePoints && Model->Speed[i] >= Model->Speed[i - 1]; i++)
+        {
+        }
+        if (i < AllocCurvePoints || Model->Speed[0] < 0)
+        {
+            break;
+        }
+
+        Full = Model->Speed[AllocCurvePoints - 1];
+        Cube[FanCount] = Model->Power/(Full*Full*Full);
+        Weight[FanCount] = Root(Model->Airflow/Cube[FanCount]);
+        Limit[FanCount] = Full/Weight[FanCount];
+        Stalled[FanCount] = 0;
+        FanCount++;
+    }
+    fclose(File);
+
+    Knee = 0;
+    Demand = -1;
+    Arrange();
+
+    return FanCount == Count;
+}
+
+/*
+* Function: AllocMaxAirflow
+* --------------------------------
+* Gives the airflow of all the fans at full speed, stalled or not, so
+* that demands can be given as a fraction of it.
+*
+* Returns: The airflow.
+*/
+
+float AllocMaxAirflow(void)
+{
+
+    float Total = 0;
+    int Fan;
+
+    for (Fan = 0; Fan < FanCount; Fan++)
+    {
+        Total += Fans[Fan].Airflow*Fans[Fan].Speed[AllocCurvePoints - 1];
+    }
+
+    return Total;
+}
+
+/*
+* Function: AllocDemand
+* --------------------------------
+* Shares an airflow between the fans that are not stalled at the least
+* total power. Nothing is solved if the demand has not changed, so
+* this can be called on every pass. A demand beyond what the fans can
+* give runs them all at full speed.
+*
+* Airflow: The airflow demanded.
+*
+* Returns: 1 if the allocation changed or 0 if not.
+*/
+
+int AllocDemand(float Airflow)
+{
+
+    if (Airflow == Demand)
+    {
+        return 0;
+    }
+
+    Demand = Airflow;
+    Solve();
+
+    return 1;
+}
+
+/*
+* Function: AllocStall
+* --------------------------------
+* Takes a stalled fan out of the allocation, sharing its airflow among
+* the others, or puts a fan that turns again back in. A stalled fan is
+* either being restarted or left stopped between restarts.
+*
+* Fan: The fan.
+* State: AllocTurning, AllocRestarting or AllocStopped.
+*
+* Returns: 1 if the state of the fan changed or 0 if not.
+*/
+
+int AllocStall(int Fan, int State)
+{
+
+    if (Fan < 0 || Fan >= FanCount || Stalled[Fan] == State)
+    {
+        return 0;
+    }
+
+    Stalled[Fan] = State;
+    Arrange();
+    Solve();
+
+    return 1;
+}
+
+/*
+* Function: AllocDuty
+* --------------------------------
+* Gives the duty cycle that drives a fan at its allocated speed by
+* interpolating its duty-to-speed curve. A fan given any airflow runs
+* at least at the first point of its curve where it turns, since below
+* it the fan may not start. A stalled fan is driven at full duty while
+* it is being restarted and is otherwise left stopped. Nothing is
+* driven while no airflow is demanded.
+*
+* Fan: The fan.
+*
+* Returns: The duty cycle (0-100).
+*/
+
+int AllocDuty(int Fan)
+{
+
+    const int *Speed = Fans[Fan].Speed;
+    float Target = Allocated[Fan];
+    int First; // First point of the curve where the fan turns
+    int i;
+
+    if (Demand <= 0)
+    {
+        return 0;
+    }
+    if (Stalled[Fan] != AllocTurning)
+    {
+        return (Stalled[Fan] == AllocRestarting) ? 100 : 0;
+    }
+    if (Target <= 0)
+    {
+        return 0;
+    }
+
+    for (First = 0; First < AllocCurvePoints - 1 && Speed[First] == 0; First++)
+    {
+    }
+    if (First == AllocCurvePoints - 1)
+    {
+        return 100;
+    }
+    Target = (Target < Speed[First]) ? Speed[First] : Target;
+
+    // Finding the segment of the curve that holds the target
+    for (i = First + 1; i < AllocCurvePoints - 1 && Speed[i] < Target; i++)
+    {
+    }
+    if (Speed[i] == Speed[i - 1])
+    {
+        return i*10;
+    }
+
+    return (int)(10*(i - 1) + 10*(Target - Speed[i - 1])/(Speed[i] - Speed[i - 1]) + 0.5f);
+}
+
+/*
+* Function: AllocAirflow
+* --------------------------------
+* Gives the airflow of a fan turning at a measured speed.
+*
+* Fan: The fan.
+* Rpm: The measured speed in RPM.
+*
+* Returns: The airflow.
+*/
+
+float AllocAirflow(int Fan, int Rpm)
+{
+
+    return Fans[Fan].Airflow*Rpm;
+}
@@ -0,0 +1,62 @@
+/*
+*  alloc_func.h
+*  airflow allocation functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO SHARE AIRFLOW BETWEEN FANS       */
+/* ------------------------------------------------------------------ */
+
+#ifndef ALLOC_FUNC_H
+#define ALLOC_FUNC_H
+
+// Allocation constants
+#define AllocMaxFans 8              // Largest number of fans sharing the airflow
+#define AllocCurvePoints 11         // Points of a duty-to-speed curve (every 10 percent)
+
+// States of a fan (see AllocStall)
+#define AllocTurning 0              // In the allocation
+#define AllocRestarting 1           // Stalled and driven at full duty to start it again
+#define AllocStopped 2              // Stalled and left stopped between restarts
+
+/*
+* Model of one fan. The speed follows the measured curve of the duty
+* cycle, the airflow is proportional to the speed and the power grows
+* with the cube of the speed.
+*/
+
+struct AllocFan
+{
+    float Airflow;                      // Airflow per RPM
+    float Power;                        // Electrical power at full speed in watts
+    int Speed[AllocCurvePoints];        // Speed in RPM at duty cycles of 0, 10, ..., 100 percent
+};
+
+// FUNCTION DECLARATIONS //
+
+int AllocLoad(const char *, int);    // Reads the models of the fans
+                                     // from a file.
+
+
+float AllocMaxAirflow(void);    // Gives the airflow of all the fans at
+                                // full speed.
+
+
+int AllocDemand(float);    // Shares an airflow between the fans at the
+                           // least total power.
+
+
+int AllocStall(int, int);    // Takes a fan out of the allocation while it
+                             // is stalled, or puts it back.
+
+
+int AllocDuty(int);    // Gives the duty cycle that drives a fan at its
+                       // allocated speed.
+
+
+float AllocAirflow(int, int);    // Gives the airflow of a fan turning at
+                                 // a measured speed.
+
+#endif
@@ -0,0 +1,404 @@
+/*
+*  autof_func.c
+*  automatic frequency functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO CHOOSE THE PWM FREQUENCY         */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "autof_func.h"
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "wdog_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Phases of the evaluation of a frequency
+#define AutofSettle 0           // Waiting for the fan to settle
+#define AutofMeasure 1          // Taking samples
+
+static int Forced;                                      // Set by AutofConfig
+static int Active;                                      // Set while the frequency is being chosen
+static int Candidates[FreqChoiceCount];                 // Distinct frequencies of FreqChoices, lowest first
+static int CandidateCount;
+static struct AutofResult Results[FreqChoiceCount];     // Last evaluation of each candidate
+static int Index;                                       // Candidate in use
+static int Ceiling;                                     // Lowest candidate that failed since the last probe
+static int Phase;                                       // AutofSettle or AutofMeasure
+static unsigned long long PhaseStart;                   // Time the phase started
+static unsigned long long NextSample;                   // Time of the next sample
+static unsigned long long NextProbe;                    // Time the higher frequencies may be tried again
+static int PrevMode;                                    // Mode at the previous pass
+static int PrevDesired;                                 // Desired speed the fan last settled for
+
+// Samples of the frequency being measured
+static int Samples;                     // Samples taken while the fan was driven
+static int Dropouts;                    // Samples reading 0 RPS
+static long long ErrorSquares;          // Sum of the squared tracking errors
+static long long SpeedSum;              // Sum of the speeds
+static long long SpeedSquares;          // Sum of the squared speeds
+static unsigned int StartMisses;        // Deadline misses when the measurement started
+
+/*
+* Function: SquareRoot
+* --------------------------------
+* Takes the integer square root of a number, bit by bit.
+*
+* Value: The number.
+*
+* Returns: The largest integer whose square is at most Value.
+*/
+
+static int SquareRoot(unsigned long long Value)
+{
+
+    unsigned long long Root = 0;
+    unsigned long long Bit = 1ULL << 62;
+
+    while (Bit > Value)
+    {
+        Bit >>= 2;
+    }
+    while (Bit != 0)
+    {
+        if (Value >= Root + Bit)
+        {
+            Value -= Root + Bit;
+            Root = (Root >> 1) + Bit;
+        }
+        else
+        {
+            Root >>= 1;
+        }
+        Bit >>= 2;
+    }
+
+    return (int)Root;
+}
+
+/*
+* Function: TotalMisses
+* --------------------------------
+* Adds up the deadline misses blamed on the control path and the user
+* interface (WdogControl to WdogMetrics). Misses blamed on WdogIdle
+* only measure how late the loop woke up, not whether the PWM
+* frequency can be kept up, so they are left out.
+*
+* Returns: The total, which wraps around.
+*/
+
+static unsigned int TotalMisses(void)
+{
+
+    const struct WdogStats *Watchdog = WdogStatsGet();
+    unsigned int Total = 0;
+    int i;
+
+    for (i = WdogControl; i <= WdogMetrics; i++)
+    {
+        Total += Watchdog->Misses[i];
+    }
+
+    return Total;
+}
+
+/*
+* Function: Arrange
+* --------------------------------
+* Lists the distinct frequencies of FreqChoices from the lowest up,
+* keeping the frequency in use selected where it is still listed.
+*
+* Frequency: The frequency in use.
+*/
+
+static void Arrange(int Frequency)
+{
+
+    int Sorted[FreqChoiceCount];
+    int Count = 0;
+    struct AutofResult Kept[FreqChoiceCount];
+    int Choice;
+    int i, j;
+
+    for (Choice = 0; Choice < FreqChoiceCount; Choice++)
+    {
+        for (i = 0; i < Count && Sorted[i] != FreqChoices[Choice]; i++)
+        {
+        }
+        if (i < Count)
+        {
+            continue;
+        }
+        for (i = Count; i > 0 && Sorted[i - 1] > FreqChoices[Choice]; i--)
+        {
+            Sorted[i] = Sorted[i - 1];
+        }
+        Sorted[i] = FreqChoices[Choice];
+        Count++;
+    }
+
+    // Keeping the evaluations of the frequencies that are still listed
+    for (i = 0; i < Count; i++)
+    {
+        Kept[i].Frequency = Sorted[i];
+        Kept[i].Samples = 0;
+        for (j = 0; j < CandidateCount; j++)
+        {
+            if (Candidates[j] == Sorted[i])
+            {
+                Kept[i] = Results[j];
+            }
+        }
+    }
+    for (i = 0; i < Count; i++)
+    {
+        Candidates[i] = Sorted[i];
+        Results[i] = Kept[i];
+    }
+    CandidateCount = Count;
+
+    // Starting from the highest candidate not above the frequency in use
+    for (Index = 0; Index + 1 < CandidateCount && Candidates[Index + 1] <= Frequency; Index++)
+    {
+    }
+    Ceiling = (Ceiling > CandidateCount || Ceiling <= Index) ? CandidateCount : Ceiling;
+
+}
+
+/*
+* Function: Begin
+* --------------------------------
+* Starts the evaluation of the candidate in use, after letting the fan
+* settle if the frequency or the setpoint has just changed.
+*
+* Settle: Set if the fan should settle first.
+*/
+
+static void Begin(int Settle)
+{
+
+    Phase = Settle ? AutofSettle : AutofMeasure;
+    PhaseStart = TimeNow();
+    NextSample = PhaseStart;
+    Samples = 0;
+    Dropouts = 0;
+    ErrorSquares = 0;
+    SpeedSum = 0;
+    SpeedSquares = 0;
+    StartMisses = TotalMisses();
+
+}
+
+/*
+* Function: Sample
+* --------------------------------
+* Takes one sample of the tracking error and the speed shown to the
+* user interface. Nothing is sampled while the fan is not driven.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+static void Sample(const struct UiState *Ui)
+{
+
+    int Error = Ui->Shown.DesiredSpeed - (Ui->Shown.RPS*50)/MaxRPS; // Tracking error (0-50 scale)
+
+    if (Ui->Shown.OnTime == 0)
+    {
+        return;
+    }
+
+    Samples++;
+    Dropouts += (Ui->Shown.RPS == 0);
+    ErrorSquares += (long long)Error*Error;
+    SpeedSum += Ui->Shown.RPS;
+    SpeedSquares += (long long)Ui->Shown.RPS*Ui->Shown.RPS;
+
+}
+
+/*
+* Function: Judge
+* --------------------------------
+* Judges the candidate in use from the samples of its measurement: the
+* tachometer must read steadily and rarely drop to 0 RPS, the loop
+* must rarely miss its deadlines and, in the modes that track a
+* desired speed (2, 4 and 6), the RMS tracking error must be small.
+*
+* Mode: The selected mode.
+* Ticks: Length of the measurement in counter ticks.
+*
+* Returns: 1 if every target was met or 0 if not.
+*/
+
+static int Judge(int Mode, unsigned long long Ticks)
+{
+
+    struct AutofResult *Result = &Results[Index];
+    long long Spread = SpeedSquares*Samples - SpeedSum*SpeedSum; // Samples squared times the variance
+    unsigned int Misses = TotalMisses() - StartMisses;
+
+    Result->Samples = Samples;
+    Result->Error = (Mode == 2 || Mode == 4 || Mode == 6) ? SquareRoot(ErrorSquares*10000/Samples) : -1;
+    Result->Jitter = SquareRoot((Spread > 0 ? Spread : 0)*10000/((long long)Samples*Samples));
+    Result->Dropouts = (Dropouts*100)/Samples;
+    Result->Misses = (int)((unsigned long long)Misses*100*ClockFrequency/Ticks);
+    Result->Pass = Result->Error <= AutofErrorLimit && Result->Jitter <= AutofJitterLimit &&
+                   Result->Dropouts <= AutofDropoutLimit && Result->Misses <= AutofMissLimit;
+
+    return Result->Pass;
+}
+
+/*
+* Function: AutofConfig
+* --------------------------------
+* Selects the PWM frequency automatically whatever the switches (it is
+* otherwise selected with SW4 to SW0 set to AutofSwitches).
+*
+* On: 1 to always select the frequency automatically, 0 to follow the
+* switches.
+*/
+
+void AutofConfig(int On)
+{
+
+    Forced = On;
+
+}
+
+/*
+* Function: AutofTick
+* --------------------------------
+* Called by the user interface on every pass. While automatic
+* selection is on, the PWM frequency climbs through the candidates of
+* FreqChoices, from the frequency in use up, as long as each one meets
+* the targets (see Judge) after the fan has settled. A frequency that
+* fails is left for the one below, and nothing above it is tried again
+* for AutofProbeTicks; the frequency in use keeps being judged, so it
+* is also left if it stops meeting the targets. After AutofProbeTicks
+* the next higher frequency is tried again. The fan therefore runs at
+* the highest, and quietest, frequency that still controls well.
+* Nothing is judged while the fan is off, and the fan settles again
+* after a change of mode or of the desired speed. When automatic
+* selection is turned off, the frequency selected by the switches is
+* restored.
+*
+* *Ui: Pointer to the state of the user interface.
+* Selected: Set if the switches select automatic selection.
+*/
+
+void AutofTick(struct UiState *Ui, int Selected)
+{
+
+    unsigned long long Now = TimeNow();
+    int Mode = Ui->Setpoints.Mode;
+    int Desired = Ui->Shown.DesiredSpeed;
+    int Previous; // Candidate in use before the judgement
+
+    if (!Selected && !Forced)
+    {
+        if (Active)
+        {
+            Ui->Setpoints.PWMFrequency = Ui->SwitchFrequency;
+        }
+        Active = 0;
+        return;
+    }
+
+    if (!Active)
+    {
+        Active = 1;
+        Ceiling = FreqChoiceCount;
+        Arrange(Ui->Setpoints.PWMFrequency);
+        NextProbe = Now + AutofProbeTicks;
+        Begin(1);
+    }
+    Ui->Setpoints.PWMFrequency = Candidates[Index];
+
+    if (Mode == 0 || Mode != PrevMode || Desired - PrevDesired > AutofStepChange ||
+        PrevDesired - Desired > AutofStepChange)
+    {
+        PrevMode = Mode;
+        PrevDesired = Desired;
+        Begin(1);
+        return;
+    }
+
+    if (Phase == AutofSettle)
+    {
+        if (Now - PhaseStart >= AutofSettleTicks)
+        {
+            Begin(0);
+        }
+        return;
+    }
+
+    if (Now >= NextSample)
+    {
+        Sample(Ui);
+        NextSample += AutofSampleTicks;
+    }
+
+    if (Now - PhaseStart < AutofMeasureTicks || Samples == 0)
+    {
+        return;
+    }
+
+    Previous = Index;
+    if (!Judge(Mode, Now - PhaseStart))
+    {
+        // Leaving a failing frequency for the one below
+        Ceiling = Index;
+        Index = (Index > 0) ? Index - 1 : 0;
+    }
+    else if (Index + 1 < Ceiling && Index + 1 < CandidateCount)
+    {
+        // Climbing while the frequencies keep meeting the targets
+        Index++;
+    }
+    else if (Now >= NextProbe)
+    {
+        // Trying the frequencies above again from time to time
+        Ceiling = CandidateCount;
+        NextProbe = Now + AutofProbeTicks;
+        Index = (Index + 1 < CandidateCount) ? Index + 1 : Index;
+    }
+
+    // Taking any change of FreqChoices into account
+    Arrange(Candidates[Index]);
+    Ui->Setpoints.PWMFrequency = Candidates[Index];
+    Begin(Index != Previous);
+
+}
+
+/*
+* Function: AutofResultGet
+* --------------------------------
+* Gives the last evaluation of one of the candidate frequencies.
+*
+* Candidate: The candidate, counted from the lowest frequency.
+* *Result: Pointer to the structure to fill in.
+*
+* Returns: 1 if there is such a candidate or 0 if not.
+*/
+
+int AutofResultGet(int Candidate, struct AutofResult *Result)
+{
+
+    if (Candidate < 0 || Candidate >= CandidateCount)
+    {
+        return 0;
+    }
+
+    *Result = Results[Candidate];
+
+    return 1;
+}
@@ -0,0 +1,61 @@
+/*
+*  autof_func.h
+*  automatic frequency functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO CHOOSE THE PWM FREQUENCY         */
+/* ------------------------------------------------------------------ */
+
+#ifndef AUTOF_FUNC_H
+#define AUTOF_FUNC_H
+
+// Value of SW4 to SW0 that selects the frequency automatically
+#define AutofSwitches 0b10000
+
+// Timing of the evaluation, in counter ticks
+#define AutofSampleTicks 2500000            // Time between samples (50 ms)
+#define AutofSettleTicks 100000000          // Time left for the fan to settle at a new frequency (2 s)
+#define AutofMeasureTicks 200000000         // Time over which a frequency is judged (4 s)
+#define AutofProbeTicks 3000000000ULL       // Time before trying the next higher frequency again (60 s)
+
+// Targets a frequency must meet
+#define AutofErrorLimit 300         // RMS tracking error in hundredths of the desired speed scale
+#define AutofJitterLimit 200        // Standard deviation of the speed in hundredths of an RPS
+#define AutofDropoutLimit 10        // Percentage of samples reading 0 RPS while the fan is driven
+#define AutofMissLimit 100          // Deadline misses per second, in hundredths
+#define AutofStepChange 5           // Change of the desired speed after which the fan must settle again
+
+/*
+* Result of the last evaluation of one frequency.
+*/
+
+struct AutofResult
+{
+    int Frequency;          // PWM frequency in Hz
+    int Samples;            // Samples taken, or 0 if never evaluated
+    int Error;              // RMS tracking error in hundredths, or -1 if not judged
+    int Jitter;             // Standard deviation of the speed in hundredths of an RPS
+    int Dropouts;           // Percentage of samples reading 0 RPS while driven
+    int Misses;             // Deadline misses per second in hundredths
+    int Pass;               // Set if every target was met
+};
+
+struct UiState;
+
+// FUNCTION DECLARATIONS //
+
+void AutofConfig(int);    // Selects the frequency automatically whatever
+                          // the switches.
+
+
+void AutofTick(struct UiState *, int);    // Moves the evaluation on and sets the
+                                          // PWM frequency while it is selected.
+
+
+int AutofResultGet(int, struct AutofResult *);    // Gives the last evaluation of one
+                                                  // of the candidate frequencies.
+
+#endif
@@ -0,0 +1,371 @@
+/*
+*  batch_func.c
+*  batched fan functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO CONTROL MANY FAN CHANNELS AT ONCE */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "batch_func.h"
+
+// Choosing the widest vector instructions the compiler targets
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BatchLanes 8
+#define BatchName "avx2"
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#define BatchLanes 4
+#define BatchName "sse4.1"
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define BatchLanes 4
+#define BatchName "neon"
+#else
+#define BatchLanes 1
+#define BatchName "scalar"
+#endif
+
+// Including other necessary custom headers
+#include "globals.h"
+
+/*
+* Function: Clamp
+* --------------------------------
+* Limits a value to a range.
+*
+* Value: The value.
+* Low: The smallest value allowed.
+* High: The largest value allowed.
+*
+* Returns: The limited value.
+*/
+
+static int32_t Clamp(int32_t Value, int32_t Low, int32_t High)
+{
+
+    Value = (Value < Low) ? Low : Value;
+    Value = (Value > High) ? High : Value;
+
+    return Value;
+}
+
+/*
+* Function: PidRange
+* --------------------------------
+* Updates the PID controllers of a range of channels one at a time.
+* This is the reference every vector version must match bit for bit,
+* and it also handles the channels left over after the last full
+* vector.
+*
+* The controller follows ClosedLoopController in fixed point: the
+* error, its sum and its change are limited to BatchInputLimit and the
+* gains to BatchGainLimit, so that every product fits in 30 bits and
+* their sum in 32, and Timing is limited to 0-100 on-time.
+*
+* *Batch: Pointer to the channels.
+* *Gains: Pointer to the gains.
+* First: The first channel of the range.
+*/
+
+static void PidRange(struct BatchChannels *Batch, const struct BatchGains *Gains, int First)
+{
+
+    int32_t Kp = Clamp(Gains->Kp, -BatchGainLimit, BatchGainLimit);
+    int32_t Ki = Clamp(Gains->Ki, -BatchGainLimit, BatchGainLimit);
+    int32_t Kd = Clamp(Gains->Kd, -BatchGainLimit, BatchGainLimit);
+    int32_t Setpoint, Measured, Error, Sum, Derivative, Step;
+    int i;
+
+    for (i = First; i < Batch->Count; i++)
+    {
+        Setpoint = Clamp(Batch->Setpoint[i], -BatchInputLimit, BatchInputLimit);
+        Measured = Clamp(Batch->Measured[i], -BatchInputLimit, BatchInputLimit);
+        Error = Clamp(Setpoint - Measured, -BatchInputLimit, BatchInputLimit);
+        Sum = Clamp(Batch->Integral[i] + Error, -BatchInputLimit, BatchInputLimit);
+        Derivative = Clamp(Error - Batch->PrevError[i], -BatchInputLimit, BatchInputLimit);
+        Step = Kp*Error + Ki*Sum + Kd*Derivative;
+
+        Batch->Integral[i] = Sum;
+        Batch->PrevError[i] = Error;
+        Batch->Timing[i] = Clamp(Batch->Timing[i] + Step, 0, BatchTimingMax);
+        Batch->OnTime[i] = Batch->Timing[i] >> BatchShift;
+    }
+
+}
+
+/*
+* Function: PwmRange
+* --------------------------------
+* Sets the PWM bits of a range of channels one at a time, the
+* reference for the vector versions. The range starts on a mask word,
+* and the bits of the channels after the last one are cleared.
+*
+* Count: The number of channels.
+* *Cycle: The cycle count (0-100) of each channel.
+* *OnTime: The on-time (0-100) of each channel.
+* *Mask: The mask words, bit i%32 of word i/32 for channel i.
+* First: The first channel of the range, a multiple of BatchMaskBits.
+*/
+
+static void PwmRange(int Count, const int32_t *Cycle, const int32_t *OnTime, uint32_t *Mask, int First)
+{
+
+    int i;
+
+    for (i = First; i < Count; i++)
+    {
+        if (i % BatchMaskBits == 0)
+        {
+            Mask[i/BatchMaskBits] = 0;
+        }
+        // The pin is high while the cycle count is below the on-time, as in PWMGenerator
+        Mask[i/BatchMaskBits] |= (uint32_t)(Cycle[i] < OnTime[i]) << (i % BatchMaskBits);
+    }
+
+}
+
+/*
+* Function: BatchKernel
+* --------------------------------
+* Names the instruction set BatchPid and BatchPwm were built for.
+*
+* Returns: "avx2", "sse4.1", "neon" or "scalar".
+*/
+
+const char *BatchKernel(void)
+{
+
+    return BatchName;
+}
+
+/*
+* Function: BatchPidScalar
+* --------------------------------
+* Updates the PID controller of every channel one at a time (see
+* PidRange).
+*
+* *Batch: Pointer to the channels.
+* *Gains: Pointer to the gains.
+*/
+
+void BatchPidScalar(struct BatchChannels *Batch, const struct BatchGains *Gains)
+{
+
+    PidRange(Batch, Gains, 0);
+
+}
+
+/*
+* Function: BatchPid
+* --------------------------------
+* Updates the PID controller of every channel, BatchLanes channels at
+* a time with the vector instructions the build targets. The results
+* are the same, bit for bit, as those of BatchPidScalar.
+*
+* *Batch: Pointer to the channels.
+* *Gains: Pointer to the gains.
+*/
+
+void BatchPid(struct BatchChannels *Batch, const struct BatchGains *Gains)
+{
+
+    int i = 0;
+
+#if defined(__AVX2__)
+    __m256i Kp = _mm256_set1_epi32(Clamp(Gains->Kp, -BatchGainLimit, BatchGainLimit));
+    __m256i Ki = _mm256_set1_epi32(Clamp(Gains->Ki, -BatchGainLimit, BatchGainLimit));
+    __m256i Kd = _mm256_set1_epi32(Clamp(Gains->Kd, -BatchGainLimit, BatchGainLimit));
+    __m256i Low = _mm256_set1_epi32(-BatchInputLimit);
+    __m256i High = _mm256_set1_epi32(BatchInputLimit);
+    __m256i Zero = _mm256_setzero_si256();
+    __m256i Top = _mm256_set1_epi32(BatchTimingMax);
+    __m256i Setpoint, Measured, Error, Sum, Derivative, Step, Timing;
+
+    for (; i + BatchLanes <= Batch->Count; i += BatchLanes)
+    {
+        Setpoint = _mm256_loadu_si256((const __m256i *)&Batch->Setpoint[i]);
+        Measured = _mm256_loadu_si256((const __m256i *)&Batch->Measured[i]);
+        Setpoint = _mm256_min_epi32(_mm256_max_epi32(Setpoint, Low), High);
+        Measured = _mm256_min_epi32(_mm256_max_epi32(Measured, Low), High);
+        Error = _mm256_min_epi32(_mm256_max_epi32(_mm256_sub_epi32(Setpoint, Measured), Low), High);
+        Sum = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)&Batch->Integral[i]), Error);
+        Sum = _mm256_min_epi32(_mm256_max_epi32(Sum, Low), High);
+        Derivative = _mm256_sub_epi32(Error, _mm256_loadu_si256((const __m256i *)&Batch->PrevError[i]));
+        Derivative = _mm256_min_epi32(_mm256_max_epi32(Derivative, Low), High);
+        Step = _mm256_add_epi32(_mm256_add_epi32(_mm256_mullo_epi32(Kp, Error), _mm256_mullo_epi32(Ki, Sum)),
+                                _mm256_mullo_epi32(Kd, Derivative));
+        Timing = _mm256_add_epi32(_mm256_loadu_si256((const __m256i *)&Batch->Timing[i]), Step);
+        Timing = _mm256_min_epi32(_mm256_max_epi32(Timing, Zero), Top);
+
+        _mm256_storeu_si256((__m256i *)&Batch->Integral[i], Sum);
+        _mm256_storeu_si256((__m256i *)&Batch->PrevError[i], Error);
+        _mm256_storeu_si256((__m256i *)&Batch->Timing[i], Timing);
+        _mm256_storeu_si256((__m256i *)&Batch->OnTime[i], _mm256_srai_epi32(Timing, BatchShift));
+    }
+#elif defined(__SSE4_1__)
+    __m128i Kp = _mm_set1_epi32(Clamp(Gains->Kp, -BatchGainLimit, BatchGainLimit));
+    __m128i Ki = _mm_set1_epi32(Clamp(Gains->Ki, -BatchGainLimit, BatchGainLimit));
+    __m128i Kd = _mm_set1_epi32(Clamp(Gains->Kd, -BatchGainLimit, BatchGainLimit));
+    __m128i Low = _mm_set1_epi32(-BatchInputLimit);
+    __m128i High = _mm_set1_epi32(BatchInputLimit);
+    __m128i Zero = _mm_setzero_si128();
+    __m128i Top = _mm_set1_epi32(BatchTimingMax);
+    __m128i Setpoint, Measured, Error, Sum, Derivative, Step, Timing;
+
+    for (; i + BatchLanes <= Batch->Count; i += BatchLanes)
+    {
+        Setpoint = _mm_loadu_si128((const __m128i *)&Batch->Setpoint[i]);
+        Measured = _mm_loadu_si128((const __m128i *)&Batch->Measured[i]);
+        Setpoint = _mm_min_epi32(_mm_max_epi32(Setpoint, Low), High);
+        Measured = _mm_min_epi32(_mm_max_epi32(Measured, Low), High);
+        Error = _mm_min_epi32(_mm_max_epi32(_mm_sub_epi32(Setpoint, Measured), Low), High);
+        Sum = _mm_add_epi32(_mm_loadu_si128((const __m128i *)&Batch->Integral[i]), Error);
+        Sum = _mm_min_epi32(_mm_max_epi32(Sum, Low), High);
+        Derivative = _mm_sub_epi32(Error, _mm_loadu_si128((const __m128i *)&Batch->PrevError[i]));
+        Derivative = _mm_min_epi32(_mm_max_epi32(Derivative, Low), High);
+        Step = _mm_add_epi32(_mm_add_epi32(_mm_mullo_epi32(Kp, Error), _mm_mullo_epi32(Ki, Sum)),
+                             _mm_mullo_epi32(Kd, Derivative));
+        Timing = _mm_add_epi32(_mm_loadu_si128((const __m128i *)&Batch->Timing[i]), Step);
+        Timing = _mm_min_epi32(_mm_max_epi32(Timing, Zero), Top);
+
+        _mm_storeu_si128((__m128i *)&Batch->Integral[i], Sum);
+        _mm_storeu_si128((__m128i *)&Batch->PrevError[i], Error);
+        _mm_storeu_si128((__m128i *)&Batch->Timing[i], Timing);
+        _mm_storeu_si128((__m128i *)&Batch->OnTime[i], _mm_srai_epi32(Timing, BatchShift));
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    int32x4_t Kp = vdupq_n_s32(Clamp(Gains->Kp, -BatchGainLimit, BatchGainLimit));
+    int32x4_t Ki = vdupq_n_s32(Clamp(Gains->Ki, -BatchGainLimit, BatchGainLimit));
+    int32x4_t Kd = vdupq_n_s32(Clamp(Gains->Kd, -BatchGainLimit, BatchGainLimit));
+    int32x4_t Low = vdupq_n_s32(-BatchInputLimit);
+    int32x4_t High = vdupq_n_s32(BatchInputLimit);
+    int32x4_t Zero = vdupq_n_s32(0);
+    int32x4_t Top = vdupq_n_s32(BatchTimingMax);
+    int32x4_t Setpoint, Measured, Error, Sum, Derivative, Step, Timing;
+
+    for (; i + BatchLanes <= Batch->Count; i += BatchLanes)
+    {
+        Setpoint = vminq_s32(vmaxq_s32(vld1q_s32(&Batch->Setpoint[i]), Low), High);
+        Measured = vminq_s32(vmaxq_s32(vld1q_s32(&Batch->Measured[i]), Low), High);
+        Error = vminq_s32(vmaxq_s32(vsubq_s32(Setpoint, Measured), Low), High);
+        Sum = vminq_s32(vmaxq_s32(vaddq_s32(vld1q_s32(&Batch->Integral[i]), Error), Low), High);
+        Derivative = vminq_s32(vmaxq_s32(vsubq_s32(Error, vld1q_s32(&Batch->PrevError[i])), Low), High);
+        Step = vmlaq_s32(vmlaq_s32(vmulq_s32(Kp, Error), Ki, Sum), Kd, Derivative);
+        Timing = vminq_s32(vmaxq_s32(vaddq_s32(vld1q_s32(&Batch->Timing[i]), Step), Zero), Top);
+
+        vst1q_s32(&Batch->Integral[i], Sum);
+        vst1q_s32(&Batch->PrevError[i], Error);
+        vst1q_s32(&Batch->Timing[i], Timing);
+        vst1q_s32(&Batch->OnTime[i], vshrq_n_s32(Timing, BatchShift));
+    }
+#endif
+
+    // Channels left over after the last full vector
+    PidRange(Batch, Gains, i);
+
+}
+
+/*
+* Function: BatchPwmScalar
+* --------------------------------
+* Packs the PWM pin of every channel into a mask one channel at a time
+* (see PwmRange).
+*
+* Count: The number of channels.
+* *Cycle: The cycle count (0-100) of each channel.
+* *OnTime: The on-time (0-100) of each channel.
+* *Mask: The (Count + 31)/32 mask words to fill.
+*/
+
+void BatchPwmScalar(int Count, const int32_t *Cycle, const int32_t *OnTime, uint32_t *Mask)
+{
+
+    PwmRange(Count, Cycle, OnTime, Mask, 0);
+
+}
+
+/*
+* Function: BatchPwm
+* --------------------------------
+* Packs the PWM pin of every channel into a mask: bit i%32 of word
+* i/32 is set while channel i is high, i.e. while its cycle count is
+* below its on-time, as in PWMGenerator. Whole mask words are built
+* from the sign bits of vector compares; the results are the same as
+* those of BatchPwmScalar.
+*
+* Count: The number of channels.
+* *Cycle: The cycle count (0-100) of each channel.
+* *OnTime: The on-time (0-100) of each channel.
+* *Mask: The (Count + 31)/32 mask words to fill.
+*/
+
+void BatchPwm(int Count, const int32_t *Cycle, const int32_t *OnTime, uint32_t *Mask)
+{
+
+    int i = 0;
+
+#if BatchLanes > 1
+    uint32_t Word; // Mask word being built
+    int Lane; // First channel of the vector within the word
+#endif
+#if defined(__AVX2__)
+    __m256i High;
+
+    for (; i + BatchMaskBits <= Count; i += BatchMaskBits)
+    {
+        Word = 0;
+        for (Lane = 0; Lane < BatchMaskBits; Lane += BatchLanes)
+        {
+            High = _mm256_cmpgt_epi32(_mm256_loadu_si256((const __m256i *)&OnTime[i + Lane]),
+                                      _mm256_loadu_si256((const __m256i *)&Cycle[i + Lane]));
+            Word |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(High)) << Lane;
+        }
+        Mask[i/BatchMaskBits] = Word;
+    }
+#elif defined(__SSE4_1__)
+    __m128i High;
+
+    for (; i + BatchMaskBits <= Count; i += BatchMaskBits)
+    {
+        Word = 0;
+        for (Lane = 0; Lane < BatchMaskBits; Lane += BatchLanes)
+        {
+            High = _mm_cmpgt_epi32(_mm_loadu_si128((const __m128i *)&OnTime[i + Lane]),
+                                   _mm_loadu_si128((const __m128i *)&Cycle[i + Lane]));
+            Word |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(High)) << Lane;
+        }
+        Mask[i/BatchMaskBits] = Word;
+    }
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    static const uint32_t Weights[4] = {1, 2, 4, 8}; // Bit of each lane
+    uint32x4_t Bit = vld1q_u32(Weights);
+    uint32x4_t High;
+    uint32x2_t Pair;
+
+    for (; i + BatchMaskBits <= Count; i += BatchMaskBits)
+    {
+        Word = 0;
+        for (Lane = 0; Lane < BatchMaskBits; Lane += BatchLanes)
+        {
+            // NEON has no move-mask, so the lane bits are summed instead
+            High = vandq_u32(vcltq_s32(vld1q_s32(&Cycle[i + Lane]), vld1q_s32(&OnTime[i + Lane])), Bit);
+            Pair = vadd_u32(vget_low_u32(High), vget_high_u32(High));
+            Word |= vget_lane_u32(vpadd_u32(Pair, Pair), 0) << Lane;
+        }
+        Mask[i/BatchMaskBits] = Word;
+    }
+#endif
+
+    // Channels left over after the last full mask word
+    PwmRange(Count, Cycle, OnTime, Mask, i);
+
+}
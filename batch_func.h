@@ -0,0 +1,75 @@
+/*
+*  batch_func.h
+*  batched fan functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO CONTROL MANY FAN CHANNELS AT ONCE */
+/* ------------------------------------------------------------------ */
+
+#ifndef BATCH_FUNC_H
+#define BATCH_FUNC_H
+
+#include <stdint.h>
+
+// Fixed-point formats of the batched PID controller
+#define BatchShift 16                       // Fraction bits of the gains and of Timing
+#define BatchInputLimit 2047                // Limit of the speeds, errors and integrals
+#define BatchGainLimit ((1 << 18) - 1)      // Limit of the gains (just under 4.0)
+#define BatchTimingMax (100 << BatchShift)  // Timing at an on-time of 100
+
+// Channels whose PWM bits are packed into one mask word
+#define BatchMaskBits 32
+
+/*
+* Gains of the batched PID controller, shared by every channel, with
+* BatchShift fraction bits (on-time per unit of speed error).
+*/
+
+struct BatchGains
+{
+    int Kp;                 // Proportional gain
+    int Ki;                 // Integral gain
+    int Kd;                 // Derivative gain
+};
+
+/*
+* State of a batch of channels, one array entry per channel. Speeds
+* are on the scale of the desired speed (0-50).
+*/
+
+struct BatchChannels
+{
+    int Count;                  // Number of channels
+    const int32_t *Setpoint;    // Desired speeds
+    const int32_t *Measured;    // Measured speeds
+    int32_t *Integral;          // Sums of the errors
+    int32_t *PrevError;         // Errors at the previous update
+    int32_t *Timing;            // On-times with BatchShift fraction bits
+    int32_t *OnTime;            // On-times (0-100)
+};
+
+// FUNCTION DECLARATIONS //
+
+const char *BatchKernel(void);    // Names the instruction set the batched
+                                  // functions use.
+
+
+void BatchPid(struct BatchChannels *, const struct BatchGains *);    // Updates the PID controller
+                                                                     // of every channel.
+
+
+void BatchPidScalar(struct BatchChannels *, const struct BatchGains *);    // Reference version of
+                                                                           // BatchPid.
+
+
+void BatchPwm(int, const int32_t *, const int32_t *, uint32_t *);    // Packs the PWM pin of every
+                                                                     // channel into a mask.
+
+
+void BatchPwmScalar(int, const int32_t *, const int32_t *, uint32_t *);    // Reference version of
+                                                                           // BatchPwm.
+
+#endif
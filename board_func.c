@@ -0,0 +1,732 @@
+/*
+*  board_func.c
+*  board functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------------- */
+/* SOURCE FILE FOR FUNCTIONS USED TO CONNECT THE CONTROLLER TO ITS BOARD  */
+/* ---------------------------------------------------------------------- */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "board_func.h"
+
+#ifdef FAN_LINUX
+#include <fcntl.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// Including other necessary custom headers
+#include "trace_func.h"
+#include "time_func.h"
+#include "hwmon_func.h"
+#include "globals.h"
+
+static struct IdleStats Idle;    // Time spent idle by BoardIdle
+
+#ifdef FAN_LINUX
+
+// Physical address of the lightweight HPS-to-FPGA bridge
+#ifndef ALT_LWFPGA_BASE
+#define ALT_LWFPGA_BASE 0xFF200000
+#endif
+
+// Offset of a peripheral within the bridge window
+#define BridgeOffset(Base) ((Base) - ALT_LWFPGA_BASE)
+
+// Linux backends
+#define BackendNone 0           // No backend selected
+#define BackendReplay 1         // Registers in memory, inputs replayed from a trace
+#define BackendMem 2            // Bridge mapped through /dev/mem
+#define BackendUio 3            // Bridge mapped through a UIO device
+#define BackendFile 4           // Bridge mapped from a file standing in for the FPGA
+#define BackendSim 5            // Registers in memory, driving a simulated fan
+#define BackendHwmon 6          // Registers in memory, driving fans through Linux hwmon
+
+// Simulated fan constants
+#define SimSpinUp 1.0f          // Time constant of the simulated fan in seconds
+#define SimPulses 2             // Tachometer pulses per revolution
+#define SimBreakaway 0.3f       // Average drive needed to start the simulated fan from rest
+#define SimStall 4.0f           // Speed in RPS below which the simulated fan stops
+#define SimDriveTime 0.05f      // Time over which the drive is averaged in seconds
+
+// On Linux the registers start out in memory; the mapped backends
+// point them into the bridge window instead
+static volatile int Registers[7];               // LEDs, switches, keys, GPIO data and direction, HEX displays
+static volatile unsigned int CounterRegister;   // Counter
+
+volatile int * LEDs = &Registers[0];
+volatile int * Switches = &Registers[1];
+volatile unsigned int * Counter = &CounterRegister;
+volatile int * Keys = &Registers[2];
+volatile int * GpioPort = &Registers[3];
+volatile int * Hex3to0 = &Registers[5];
+volatile int * Hex5to4 = &Registers[6];
+
+static int Backend = BackendNone;       // Selected backend
+static void *Bridge = MAP_FAILED;       // Mapped bridge window
+static volatile sig_atomic_t Stopping;  // Set by SIGINT or SIGTERM
+
+static int Spinning;                    // Set by --spin to never sleep in BoardIdle
+static int Guard = IdleGuardTicks;      // Ticks spun before each deadline
+
+static unsigned int SimTicks;           // Counter value at the previous simulation step
+static float SimSpeed;                  // Speed of the simulated fan in RPS
+static float SimPhase;                  // Position of the fan within a tachometer pulse
+static float SimDrive;                  // Drive of the simulated fan averaged over SimDriveTime
+
+#else
+
+// Initializing global pointers that are used to interface with the FPGA
+volatile int * LEDs     = (volatile int *)ALT_LWFPGA_LED_BASE;
+volatile int * Switches = (volatile int *)ALT_LWFPGA_SWITCH_BASE;
+volatile unsigned int * Counter = (volatile unsigned int *)ALT_LWFPGA_COUNTER_BASE;
+volatile int * Keys = (volatile int *)ALT_LWFPGA_KEY_BASE;
+volatile int * GpioPort = (volatile int *) (ALT_LWFPGA_GPIO_0A_BASE);
+volatile int * Hex3to0 = (volatile int *)(ALT_LWFPGA_HEXA_BASE);
+volatile int * Hex5to4 = (volatile int *)(ALT_LWFPGA_HEXB_BASE);
+
+#endif
+
+#ifdef FAN_LINUX
+
+/*
+* Function: StopHandler
+* --------------------------------
+* Asks the main loop to stop when the service is told to terminate,
+* so that the fan is switched off and the board is closed cleanly.
+*
+* Signal: The signal received.
+*/
+
+static void StopHandler(int Signal)
+{
+
+    (void)Signal;
+    Stopping = 1;
+
+}
+
+/*
+* Function: MapBridge
+* --------------------------------
+* Maps the lightweight bridge window once and points the global
+* register pointers into it, so every register access afterwards is a
+* plain load or store with no system call.
+*
+* Path: /dev/mem, a UIO device or the file standing in for the FPGA.
+* Offset: Offset of the window within Path.
+* Create: Set to create the file and size it to the window.
+*
+* Returns: 1 if the bridge was mapped or 0 if not.
+*/
+
+static int MapBridge(const char *Path, off_t Offset, int Create)
+{
+
+    int Descriptor;
+    char *Base;
+
+    Descriptor = open(Path, Create ? (O_RDWR | O_CREAT) : (O_RDWR | O_SYNC), 0644);
+    if (Descriptor < 0)
+    {
+        return 0;
+    }
+    if (Create && ftruncate(Descriptor, BridgeSpan) != 0)
+    {
+        close(Descriptor);
+        return 0;
+    }
+
+    Bridge = mmap(NULL, BridgeSpan, PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, Offset);
+    close(Descriptor);
+    if (Bridge == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    Base = (char *)Bridge;
+    LEDs = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_LED_BASE));
+    Switches = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_SWITCH_BASE));
+    Counter = (volatile unsigned int *)(Base + BridgeOffset(ALT_LWFPGA_COUNTER_BASE));
+    Keys = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_KEY_BASE));
+    GpioPort = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_GPIO_0A_BASE));
+    Hex3to0 = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_HEXA_BASE));
+    Hex5to4 = (volatile int *)(Base + BridgeOffset(ALT_LWFPGA_HEXB_BASE));
+
+    return 1;
+}
+
+/*
+* Function: MonotonicTicks
+* --------------------------------
+* Reads the monotonic clock in counter ticks. Used to drive the
+* counter of a file standing in for the FPGA, which has no counter
+* of its own.
+*
+* Returns: The monotonic clock in ticks of ClockFrequency.
+*/
+
+static unsigned int MonotonicTicks(void)
+{
+
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+
+    return (unsigned int)((unsigned long long)Now.tv_sec*ClockFrequency +
+                          (unsigned long long)Now.tv_nsec*(ClockFrequency/1000000)/1000);
+}
+
+/*
+* Function: BoardTicks
+* --------------------------------
+* Reads the counter as it is now. The backends without a counter of
+* their own only update * Counter in BoardPoll, so the monotonic clock
+* is read for them instead.
+*
+* Returns: The current counter value.
+*/
+
+unsigned int BoardTicks(void)
+{
+
+    if (Backend == BackendFile || Backend == BackendSim || Backend == BackendHwmon)
+    {
+        return MonotonicTicks();
+    }
+
+    return *Counter;
+}
+
+/*
+* Function: DriveTachometer
+* --------------------------------
+* Drives the tachometer pin with a square wave of SimPulses pulses per
+* revolution for a fan turning at a given speed, unless the controller
+* drives the pin itself.
+*
+* Speed: The speed of the fan in RPS.
+* Elapsed: Seconds since the previous step.
+*/
+
+static void DriveTachometer(float Speed, float Elapsed)
+{
+
+    unsigned int Driven = *(GpioPort + 1); // Pins driven by the controller
+    int TachState;
+
+    SimPhase += Speed*SimPulses*Elapsed;
+    SimPhase -= (int)SimPhase;
+
+    TachState = SimPhase < 0.5f;
+    *GpioPort = (*GpioPort & Driven) | ((TachState << 1) & ~Driven);
+
+}
+
+/*
+* Function: SimulateFan
+* --------------------------------
+* Advances the simulated fan to the current counter value. The fan
+* speeds up towards MaxRPS while the PWM pin is high and slows down
+* towards a standstill while it is low, and drives the tachometer pin
+* with a square wave of SimPulses pulses per revolution. Like a real
+* fan it needs more drive to start from rest than to keep turning: it
+* stops below SimStall RPS unless its average drive is at least
+* SimBreakaway.
+*/
+
+static void SimulateFan(void)
+{
+
+    unsigned int Driven = *(GpioPort + 1); // Pins driven by the controller
+    float Elapsed = (float)(*Counter - SimTicks)/ClockFrequency; // Seconds since the previous step
+    float Target = ((*GpioPort & Driven) & 0x08) ? MaxRPS : 0; // Speed the fan is heading for
+    float Fraction = (Elapsed < SimSpinUp) ? Elapsed/SimSpinUp : 1; // Part of the gap closed in this step
+
+    // Below its stall speed the fan is held by friction unless the
+    // average drive is enough to break it away
+    SimDrive += ((Target > 0 ? 1.0f : 0.0f) - SimDrive)*((Elapsed < SimDriveTime) ? Elapsed/SimDriveTime : 1);
+    if (SimSpeed < SimStall && SimDrive < SimBreakaway)
+    {
+        Target = 0;
+    }
+
+    SimTicks = *Counter;
+    SimSpeed += (Target - SimSpeed)*Fraction;
+    DriveTachometer(SimSpeed, Elapsed);
+
+}
+
+/*
+* Function: FollowHwmon
+* --------------------------------
+* Reads the speeds of the hwmon fans when they are due and drives the
+* tachometer pin at their mean speed, so that Tachometer and the modes
+* measure a PC fan exactly as they measure the fan on the board.
+*/
+
+static void FollowHwmon(void)
+{
+
+    float Elapsed = (float)(*Counter - SimTicks)/ClockFrequency; // Seconds since the previous step
+
+    HwmonPoll();
+    SimTicks = *Counter;
+    DriveTachometer(HwmonSpeed(), Elapsed);
+
+}
+
+#endif
+
+/*
+* Function: BoardStart
+* --------------------------------
+* Initialises the board. On the bare-metal build this initialises the
+* FPGA configuration; if the build defines FAN_RECORD as a file path the
+* board inputs are recorded to that file. On the Linux build
+* (FAN_LINUX) one backend is chosen on the command line:
+*
+*   --mem                 map the bridge through /dev/mem
+*   --uio DEVICE          map the bridge through a UIO device
+*   --file FILE           map a file standing in for the FPGA; the
+*                         counter follows the monotonic clock
+*   --replay FILE         keep the registers in memory and replay the
+*                         inputs recorded in FILE
+*   --sim                 keep the registers in memory and drive a
+*                         simulated fan; the counter follows the
+*                         monotonic clock
+*   --hwmon DIR           keep the registers in memory and drive PC
+*                         fans through the hwmon device DIR; the
+*                         counter follows the monotonic clock
+*   --hwmon-fans LIST     comma-separated fan channels driven together
+*                         (default 1)
+*   --hwmon-max RPM       speed of the fans at full duty, shown as
+*                         MaxRPS (default MaxRPS*60)
+*   --hwmon-alloc FILE    share the airflow between the fans at the
+*                         least power, using their models in FILE
+*   --replay-step TICKS   counter ticks per loop pass while idle
+*   --record FILE         record the inputs seen by the controller
+*   --spin                never sleep between loop passes
+*   --idle-guard US       time spun before each deadline instead of
+*                         sleeping (default 50 us)
+*
+* Other arguments are ignored so that they can be used elsewhere.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1 if the board is ready or 0 if it could not be started.
+*/
+
+int BoardStart(int argc, char **argv)
+{
+
+#ifdef FAN_LINUX
+
+    const char *Path = NULL; // Device, file or trace used by the backend
+    const char *RecordPath = NULL; // Trace file to record
+    const char *Fans = "1"; // hwmon fan channels
+    const char *Curves = NULL; // Models of the hwmon fans
+    int MaxRpm = 0; // Speed of the hwmon fans at full duty
+    unsigned int Step = ReplayDefaultStep; // Counter ticks per idle loop pass
+    int Mapped = 1; // Set to 0 if the bridge could not be mapped
+    int Arg;
+
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--mem") == 0)
+        {
+            Backend = BackendMem;
+            Path = "/dev/mem";
+        }
+        else if (strcmp(argv[Arg], "--sim") == 0)
+        {
+            Backend = BackendSim;
+        }
+        else if (strcmp(argv[Arg], "--spin") == 0)
+        {
+            Spinning = 1;
+        }
+        else if (Arg + 1 >= argc)
+        {
+            break;
+        }
+        else if (strcmp(argv[Arg], "--uio") == 0)
+        {
+            Backend = BackendUio;
+            Path = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--file") == 0)
+        {
+            Backend = BackendFile;
+            Path = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--replay") == 0)
+        {
+            Backend = BackendReplay;
+            Path = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--hwmon") == 0)
+        {
+            Backend = BackendHwmon;
+            Path = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--hwmon-fans") == 0)
+        {
+            Fans = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--hwmon-max") == 0)
+        {
+            MaxRpm = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--hwmon-alloc") == 0)
+        {
+            Curves = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--replay-step") == 0)
+        {
+            Step = strtoul(argv[++Arg], NULL, 0);
+        }
+        else if (strcmp(argv[Arg], "--record") == 0)
+        {
+            RecordPath = argv[++Arg];
+        }
+        else if (strcmp(argv[Arg], "--idle-guard") == 0)
+        {
+            Guard = atoi(argv[++Arg])*(ClockFrequency/1000000);
+        }
+    }
+
+    switch (Backend)
+    {
+    case BackendMem:
+        Mapped = MapBridge(Path, ALT_LWFPGA_BASE, 0);
+        break;
+    case BackendUio:
+        Mapped = MapBridge(Path, 0, 0);
+        break;
+    case BackendFile:
+        Mapped = MapBridge(Path, 0, 1);
+        break;
+    case BackendReplay:
+        // Keys read as released until the trace says otherwise
+        *Keys = 0xF;
+        if (!TraceReplayStart(Path, Step))
+        {
+            fprintf(stderr, "%s: cannot replay %s\n", argv[0], Path);
+            return 0;
+        }
+        break;
+    case BackendSim:
+        // Keys read as released until another program presses them
+        *Keys = 0xF;
+        *Counter = MonotonicTicks();
+        SimTicks = *Counter;
+        break;
+    case BackendHwmon:
+        *Keys = 0xF;
+        *Counter = MonotonicTicks();
+        SimTicks = *Counter;
+        if (!HwmonStart(Path, Fans, MaxRpm, Curves))
+        {
+            fprintf(stderr, "%s: cannot drive the fans in %s\n", argv[0], Path);
+            HwmonEnd();
+            return 0;
+        }
+        break;
+    default:
+        fprintf(stderr, "usage: %s --mem | --uio DEVICE | --file FILE | --replay FILE [--replay-step TICKS] | --sim"
+                        " | --hwmon DIR [--hwmon-fans LIST] [--hwmon-max RPM] [--hwmon-alloc FILE] [--record FILE]\n", argv[0]);
+        return 0;
+    }
+
+    if (!Mapped)
+    {
+        perror(Path);
+        return 0;
+    }
+
+    if (RecordPath != NULL && !TraceRecordStart(RecordPath))
+    {
+        fprintf(stderr, "%s: cannot record to %s\n", argv[0], RecordPath);
+        return 0;
+    }
+
+    // Stopping cleanly when run as a service
+    signal(SIGINT, StopHandler);
+    signal(SIGTERM, StopHandler);
+
+#else
+
+    (void)argc;
+    (void)argv;
+
+    // Function call to initialise the FPGA configuration
+    EE30186_Start();
+
+#ifdef FAN_RECORD
+    TraceRecordStart(FAN_RECORD);
+#endif
+
+#endif
+
+    TimeUpdate();
+
+    return 1;
+}
+
+/*
+* Function: BoardPoll
+* --------------------------------
+* Called at the start of every pass of the main loop. Replayed or
+* simulated inputs are applied to the registers and the inputs are
+* recorded if a recording was started.
+*
+* Returns: 1 while the controller should keep running or 0 once it
+* should stop (the replayed trace has ended or the service was told
+* to terminate).
+*/
+
+int BoardPoll(void)
+{
+
+    int Running = 1; // Set to 0 when the controller should stop
+
+#ifdef FAN_LINUX
+    if (Backend == BackendReplay)
+    {
+        Running = TraceReplayPoll();
+    }
+    else if (Backend == BackendFile)
+    {
+        *Counter = MonotonicTicks();
+    }
+    else if (Backend == BackendSim)
+    {
+        *Counter = MonotonicTicks();
+        SimulateFan();
+    }
+    else if (Backend == BackendHwmon)
+    {
+        *Counter = MonotonicTicks();
+        FollowHwmon();
+    }
+    Running = Running && !Stopping;
+#endif
+
+    // Reading the counter once for the whole pass
+    TimeUpdate();
+
+    TraceRecord();
+
+    return Running;
+}
+
+/*
+* Function: BoardDelay
+* --------------------------------
+* Stands in for the busy loop of Delay on the Linux build. While
+* replaying, the replayed time is moved forward by the time the loop
+* would have taken on the board; otherwise the process sleeps for that
+* time instead of spinning.
+*
+* Length: The number of passes of the Delay loop.
+*/
+
+void BoardDelay(int Length)
+{
+
+#ifdef FAN_LINUX
+    struct timespec Wait;
+    long long Nanoseconds = (long long)Length*DelayLoopTicks*(1000000000/ClockFrequency);
+
+    if (Backend == BackendReplay)
+    {
+        TraceReplayAdvance(Length*DelayLoopTicks);
+        return;
+    }
+
+    Wait.tv_sec = Nanoseconds/1000000000;
+    Wait.tv_nsec = Nanoseconds%1000000000;
+    nanosleep(&Wait, NULL);
+#else
+    (void)Length;
+#endif
+
+}
+
+/*
+* Function: BoardIdle
+* --------------------------------
+* Waits until the counter reaches a deadline worked out by the control
+* path. On Linux the thread sleeps with an absolute clock_nanosleep up
+* to --idle-guard before the deadline and spins for the rest, so that
+* the wake-up latency does not move PWM edges. While replaying, or with
+* --spin, it returns at once and the loop spins as before.
+*
+* On the bare-metal build the loop spins as before unless it is built
+* with FAN_WFI, in which case the core waits for an interrupt until the
+* deadline is near. FAN_WFI needs a periodic interrupt (e.g. the
+* Cortex-A9 private timer) to be enabled by the board support package;
+* without one the core would not wake.
+*
+* Deadline: The time at which the control path needs to run (see
+* TimeNow).
+*/
+
+void BoardIdle(unsigned long long Deadline)
+{
+
+    unsigned int Until = (unsigned int)Deadline; // Counter value at the deadline
+
+#ifdef FAN_LINUX
+    struct timespec Wake;
+    unsigned int Start;
+    unsigned int End;
+    int Remaining;
+    long long Nanoseconds;
+
+    if (Spinning || Backend == BackendReplay)
+    {
+        return;
+    }
+
+    Start = BoardTicks();
+    Remaining = (int)(Until - Start);
+    if (Remaining > Guard)
+    {
+        // Sleeping until the guard time before the deadline
+        Nanoseconds = (long long)(Remaining - Guard)*1000/(ClockFrequency/1000000);
+        clock_gettime(CLOCK_MONOTONIC, &Wake);
+        Wake.tv_sec += Nanoseconds/1000000000;
+        Wake.tv_nsec += Nanoseconds%1000000000;
+        if (Wake.tv_nsec >= 1000000000)
+        {
+            Wake.tv_sec++;
+            Wake.tv_nsec -= 1000000000;
+        }
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &Wake, NULL) != 0 && !Stopping)
+        {
+        }
+
+        End = BoardTicks();
+        Idle.IdleTicks += End - Start;
+        Idle.Sleeps++;
+
+        // Measuring how late the thread woke if it overslept the deadline
+        if ((int)(End - Until) > 0)
+        {
+            Idle.LateTicks += End - Until;
+        }
+    }
+
+    // Spinning for the rest of the time
+    while ((int)(Until - BoardTicks()) > 0)
+    {
+    }
+#elif defined(FAN_WFI)
+    unsigned int Start = *Counter;
+
+    if ((int)(Until - Start) > IdleGuardTicks)
+    {
+        while ((int)(Until - *Counter) > IdleGuardTicks)
+        {
+            __asm__ volatile ("wfi");
+        }
+        Idle.IdleTicks += *Counter - Start;
+        Idle.Sleeps++;
+    }
+#else
+    (void)Until;
+#endif
+
+}
+
+/*
+* Function: BoardDrive
+* --------------------------------
+* Called at the end of every pass of the control path with the on-time
+* it chose. A backend that drives the fan with a PWM of its own (hwmon)
+* takes the on-time from here instead of from the PWM pin.
+*
+* OnTime: The on-time as a percentage (0-100).
+*
+* Returns: 1 if the backend drives the fan itself, so that its
+* tachometer can be read whatever the state of the PWM pin, or 0 if
+* the PWM pin drives the fan.
+*/
+
+int BoardDrive(int OnTime)
+{
+
+#ifdef FAN_LINUX
+    if (Backend == BackendHwmon)
+    {
+        HwmonDrive(OnTime);
+        return 1;
+    }
+#else
+    (void)OnTime;
+#endif
+
+    return 0;
+}
+
+/*
+* Function: BoardIdleStats
+* --------------------------------
+* Gives access to the time spent idle by BoardIdle, for the metrics
+* page.
+*
+* Returns: A pointer to the statistics, updated in place.
+*/
+
+const struct IdleStats *BoardIdleStats(void)
+{
+
+    return &Idle;
+}
+
+/*
+* Function: BoardEnd
+* --------------------------------
+* Stops any recording or replay, switches the fan off and closes the
+* board.
+*/
+
+void BoardEnd(void)
+{
+
+    TraceRecordStop();
+    TraceReplayStop();
+
+    // Leaving the fan switched off
+    *GpioPort = 0x00;
+
+#ifdef FAN_LINUX
+    if (Backend == BackendHwmon)
+    {
+        HwmonEnd();
+    }
+    if (Bridge != MAP_FAILED)
+    {
+        munmap(Bridge, BridgeSpan);
+        Bridge = MAP_FAILED;
+    }
+#else
+    // Function call to clean up and close the FPGA configuration
+    EE30186_End();
+#endif
+
+}
@@ -0,0 +1,73 @@
+/*
+*  board_func.h
+*  board functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------------- */
+/* HEADER FILE FOR FUNCTIONS USED TO CONNECT THE CONTROLLER TO ITS BOARD  */
+/* ---------------------------------------------------------------------- */
+
+#ifndef BOARD_FUNC_H
+#define BOARD_FUNC_H
+
+// Number of counter ticks taken by one pass of the loop in Delay; used
+// when a Linux backend replaces the busy loop
+#define DelayLoopTicks 2
+
+// Counter ticks per loop pass while replayed inputs are idle (500 us)
+#define ReplayDefaultStep 25000
+
+// Size of the lightweight HPS-to-FPGA bridge window mapped on Linux
+#define BridgeSpan 0x200000
+
+// Default counter ticks before a deadline at which BoardIdle stops
+// sleeping and spins instead, to cover the wake-up latency (50 us)
+#define IdleGuardTicks 2500
+
+/*
+* Time spent idle by BoardIdle. The counters wrap around.
+*/
+
+struct IdleStats
+{
+    unsigned int IdleTicks;     // Counter ticks spent asleep
+    unsigned int Sleeps;        // Number of times the loop went to sleep
+    unsigned int LateTicks;     // Counter ticks by which sleeps overran their deadlines
+};
+
+// FUNCTION DECLARATIONS //
+
+int BoardStart(int, char **);    // Initialises the board and points the
+                                 // global register pointers at it.
+
+
+int BoardPoll(void);    // Called at the start of every loop pass; updates
+                        // any simulated registers and reports whether
+                        // the controller should keep running.
+
+
+unsigned int BoardTicks(void);    // Reads the counter as it is now rather
+                                  // than at the start of the pass.
+
+
+void BoardDelay(int);    // Waits for the length of a Delay loop on the
+                         // Linux backends.
+
+
+void BoardIdle(unsigned long long);    // Waits until a deadline, sleeping
+                                       // where the board allows it.
+
+
+int BoardDrive(int);    // Hands the on-time to a backend that drives
+                        // the fan with its own PWM.
+
+
+const struct IdleStats *BoardIdleStats(void);    // Gives access to the time spent
+                                                 // idle by BoardIdle.
+
+
+void BoardEnd(void);    // Closes the board.
+
+#endif
@@ -0,0 +1,351 @@
+/*
+*  bode_func.c
+*  frequency-response functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO MEASURE THE FAN'S FREQUENCY      */
+/* RESPONSE                                                           */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "bode_func.h"
+
+// Including other necessary custom headers
+#include "misc_func.h"
+#include "shared_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Goertzel constants for a bin of one cycle in BodeSamples samples,
+// in Q14 fixed point
+#define GoertzelCoeff 32139     // 2cos(2pi/32)
+#define GoertzelCos 16069       // cos(2pi/32)
+#define GoertzelSin 3196        // sin(2pi/32)
+
+// Test frequencies in mHz, from the fan's time constant to well above it
+static const int Frequencies[] = {50, 100, 200, 500, 1000, 2000};
+#define FrequencyCount ((int)(sizeof(Frequencies)/sizeof(Frequencies[0])))
+
+// Angles of atan(2^-i) in hundredths of a degree for CORDIC
+static const short AtanTable[14] = {4500, 2657, 1404, 713, 358, 179, 90, 45, 22, 11, 6, 3, 1, 1};
+
+static struct Shared Results[BodeMaxPoints];    // Published results, one per test frequency
+
+static int Operating;                   // Duty cycle the sweep is made around
+static int Point = -1;                  // Test frequency being measured; -1 while settling
+static unsigned long long StageStart;   // Time the current test frequency (or settling) began
+static unsigned long long Period;       // Period of the current test frequency in ticks
+static unsigned long long NextSample;   // Time of the next sample
+static int Sample;                      // Samples taken at the current test frequency
+static long long MeanSum;               // Sum of the speed over the settling periods
+static int Mean;                        // Mean speed, removed before the filters
+static int Y1, Y2;                      // Goertzel state for the speed
+static int U1, U2;                      // Goertzel state for the duty cycle
+
+static int Speed;                       // Estimated speed in 1/256 RPS
+static int Valid;                       // Set while LastEdge is the latest tachometer edge
+static unsigned long long LastEdge;     // Time of the latest tachometer edge
+static int PrevTachState;               // Previous value of the tachometer pin
+
+/*
+* Function: StartStage
+* --------------------------------
+* Begins measuring at a test frequency, or settling at the operating
+* point if Index is -1.
+*
+* Index: The test frequency (or -1).
+* Now: The time the stage begins.
+*/
+
+static void StartStage(int Index, unsigned long long Now)
+{
+
+    Point = Index;
+    StageStart = Now;
+    Sample = 0;
+    MeanSum = 0;
+    Y1 = Y2 = U1 = U2 = 0;
+
+    if (Index >= 0 && Index < FrequencyCount)
+    {
+        Period = (unsigned long long)ClockFrequency*1000/Frequencies[Index];
+        NextSample = Now;
+    }
+
+}
+
+/*
+* Function: Vector
+* --------------------------------
+* Finds the magnitude and angle of a vector by CORDIC, with shifts and
+* adds only. The magnitude is scaled by the CORDIC gain (about 1.647),
+* which cancels when two magnitudes are divided.
+*
+* X, Y: The components of the vector.
+* *Magnitude: Set to the scaled magnitude.
+* *Angle: Set to the angle in hundredths of a degree (-18000 to 18000).
+*/
+
+static void Vector(long long X, long long Y, long long *Magnitude, int *Angle)
+{
+
+    long long Next; // X after a rotation
+    int Sum = 0; // Angle rotated through
+    int i;
+
+    // Turning the vector into the right half-plane first
+    if (X < 0)
+    {
+        X = -X;
+        Y = -Y;
+        Sum = 18000;
+    }
+
+    // Rotating the vector onto the x-axis
+    for (i = 0; i < 14; i++)
+    {
+        if (Y > 0)
+        {
+            Next = X + (Y >> i);
+            Y -= X >> i;
+            Sum += AtanTable[i];
+        }
+        else
+        {
+            Next = X - (Y >> i);
+            Y += X >> i;
+            Sum -= AtanTable[i];
+        }
+        X = Next;
+    }
+
+    *Magnitude = X;
+    *Angle = (Sum > 18000) ? Sum - 36000 : Sum;
+
+}
+
+/*
+* Function: Finish
+* --------------------------------
+* Works out the gain and phase at the current test frequency from the
+* Goertzel filters of the speed and the duty cycle and publishes them.
+*/
+
+static void Finish(void)
+{
+
+    struct BodePoint Result;
+    long long SpeedMagnitude, DutyMagnitude;
+    int SpeedAngle, DutyAngle;
+
+    // Final Goertzel step: the real and imaginary parts of the bin
+    Vector(Y1 - (((long long)Y2*GoertzelCos) >> 14), ((long long)Y2*GoertzelSin) >> 14, &SpeedMagnitude, &SpeedAngle);
+    Vector(U1 - (((long long)U2*GoertzelCos) >> 14), ((long long)U2*GoertzelSin) >> 14, &DutyMagnitude, &DutyAngle);
+
+    Result.Frequency = Frequencies[Point];
+    Result.Gain = DutyMagnitude ? (int)(SpeedMagnitude*1000/DutyMagnitude) : 0;
+    Result.Phase = SpeedAngle - DutyAngle;
+    Result.Phase = (Result.Phase > 18000) ? Result.Phase - 36000 : Result.Phase;
+    Result.Phase = (Result.Phase <= -18000) ? Result.Phase + 36000 : Result.Phase;
+    SharedWrite(&Results[Point], &Result, sizeof(Result));
+
+}
+
+/*
+* Function: BodeReset
+* --------------------------------
+* Starts a new sweep at the next call to BodeDrive and forgets the
+* results of the previous one.
+*/
+
+void BodeReset(void)
+{
+
+    struct BodePoint Empty = {0, 0, 0};
+    int i;
+
+    for (i = 0; i < FrequencyCount; i++)
+    {
+        SharedWrite(&Results[i], &Empty, sizeof(Empty));
+    }
+    Operating = 0;
+    Point = -1;
+    Speed = 0;
+    Valid = 0;
+
+}
+
+/*
+* Function: BodeDrive
+* --------------------------------
+* Gives the duty cycle for the current pass of the measurement mode.
+* The fan is held at the operating duty cycle for BodeSettleTicks and
+* then a sine of BodeAmplitude is added to it at each test frequency in
+* turn. Changing the operating duty cycle starts the sweep again; once
+* the sweep is complete the operating duty cycle is held.
+*
+* DutyCycle: The operating duty cycle (0-100).
+*
+* Returns: OnTime, the duty cycle to drive the fan at (0-100).
+*/
+
+int BodeDrive(int DutyCycle)
+{
+
+    unsigned long long Now = TimeNow();
+    unsigned long long Phase; // Position within the period of the perturbation
+    int OnTime;
+
+    if (DutyCycle != Operating)
+    {
+        BodeReset();
+        Operating = DutyCycle;
+        StartStage(-1, Now);
+    }
+
+    if (Operating <= 0)
+    {
+        return 0;
+    }
+
+    if (Point < 0)
+    {
+        if (Now - StageStart >= BodeSettleTicks)
+        {
+            StartStage(0, Now);
+        }
+        return Operating;
+    }
+
+    if (Point >= FrequencyCount)
+    {
+        return Operating;
+    }
+
+    Phase = ((Now - StageStart)%Period)*1024/Period;
+    OnTime = Operating + (BodeAmplitude*SineLookup((unsigned int)Phase))/1000;
+
+    // Restricting the value of the on-time between 0 and 100
+    OnTime = (OnTime > 100) ? 100 : OnTime;
+    OnTime = (OnTime < 0) ? 0 : OnTime;
+
+    return OnTime;
+}
+
+/*
+* Function: BodeMeasure
+* --------------------------------
+* Called after PWMGenerator on every pass of the measurement mode.
+* The speed is estimated from the time between tachometer edges, which
+* gives a new value on every edge rather than every half-second. The
+* tachometer is only read while the fan is powered, so a period is only
+* measured between two edges of the same on-time; the PWM frequency
+* has to be low enough for the fan to turn half a revolution within
+* one on-time.
+*
+* At each of the BodeSamples sample times per period the speed and the
+* duty cycle are fed to a single-bin Goertzel filter at the test
+* frequency. The filters cost one multiplication each per sample; the
+* mean speed over the settling periods is removed first so that the
+* fixed-point state stays small.
+*
+* OnTime: The duty cycle the fan was driven at in this pass (0-100).
+* GpioInputs: The filtered state of the GPIO port (see InputFilter).
+* FanOn: Set if the fan is powered in this pass.
+*/
+
+void BodeMeasure(int OnTime, unsigned int GpioInputs, int FanOn)
+{
+
+    unsigned long long Now = TimeNow();
+    int TachState = (GpioInputs >> 1) & 0x01; // Current value of the tachometer pin
+    int Estimate; // Speed given by the time since the latest edge
+    int Speed0, Duty0; // Samples with their means removed
+    int Next;
+
+    // Estimating the speed from the tachometer period (two edges per revolution)
+    if (!FanOn)
+    {
+        Valid = 0;
+    }
+    else if (TachState == 1 && PrevTachState == 0)
+    {
+        if (Valid)
+        {
+            Speed = (int)((long long)ClockFrequency*128/(long long)(Now - LastEdge));
+        }
+        LastEdge = Now;
+        Valid = 1;
+    }
+    else if (Valid)
+    {
+        // A period longer than the last one means the fan has slowed down
+        Estimate = (int)((long long)ClockFrequency*128/(long long)(Now - LastEdge + 1));
+        Speed = (Estimate < Speed) ? Estimate : Speed;
+    }
+    PrevTachState = TachState;
+
+    if (Point < 0 || Point >= FrequencyCount || !TimeReached(NextSample))
+    {
+        return;
+    }
+
+    if (Sample < BodeSettleCycles*BodeSamples)
+    {
+        // Settling: only the mean speed is taken
+        MeanSum += Speed;
+        Mean = (int)(MeanSum/(Sample + 1));
+    }
+    else
+    {
+        Speed0 = Speed - Mean;
+        Duty0 = (OnTime - Operating)*256;
+
+        Next = Speed0 + (int)(((long long)Y1*GoertzelCoeff) >> 14) - Y2;
+        Y2 = Y1;
+        Y1 = Next;
+        Next = Duty0 + (int)(((long long)U1*GoertzelCoeff) >> 14) - U2;
+        U2 = U1;
+        U1 = Next;
+    }
+
+    Sample++;
+    NextSample = StageStart + Sample*Period/BodeSamples;
+
+    if (Sample >= (BodeSettleCycles + BodeCycles)*BodeSamples)
+    {
+        Finish();
+        StartStage(Point + 1, NextSample);
+    }
+
+}
+
+/*
+* Function: BodeResult
+* --------------------------------
+* Takes a copy of the result at one test frequency. Can be called from
+* the user interface while the control path is measuring.
+*
+* Index: The test frequency (0 to BodeMaxPoints - 1).
+* *Result: Set to the result.
+*
+* Returns: 1 if the test frequency has been measured or 0 if not.
+*/
+
+int BodeResult(int Index, struct BodePoint *Result)
+{
+
+    if (Index < 0 || Index >= FrequencyCount || !SharedRead(&Results[Index], Result, sizeof(*Result)))
+    {
+        return 0;
+    }
+
+    return Result->Frequency != 0;
+}
@@ -0,0 +1,53 @@
+/*
+*  bode_func.h
+*  frequency-response functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO MEASURE THE FAN'S FREQUENCY      */
+/* RESPONSE                                                           */
+/* ------------------------------------------------------------------ */
+
+#ifndef BODE_FUNC_H
+#define BODE_FUNC_H
+
+// Sweep constants
+#define BodeAmplitude 10            // Amplitude of the duty cycle perturbation (0-100)
+#define BodeSamples 32              // Samples taken per period of the perturbation
+#define BodeSettleCycles 1          // Periods left to settle before each measurement
+#define BodeCycles 4                // Periods measured at each frequency
+#define BodeSettleTicks 250000000   // Time at the operating point before a sweep (5 s)
+#define BodeMaxPoints 8             // Largest number of test frequencies
+
+/*
+* Response of the fan at one test frequency: the change in speed for
+* a change in duty cycle.
+*/
+
+struct BodePoint
+{
+    int Frequency;          // Test frequency in mHz
+    int Gain;               // Speed amplitude over duty cycle amplitude in thousandths of RPS per percent
+    int Phase;              // Phase of the speed relative to the duty cycle in hundredths of a degree
+};
+
+// FUNCTION DECLARATIONS //
+
+void BodeReset(void);    // Starts a new sweep and forgets the results
+                         // of the previous one.
+
+
+int BodeDrive(int);    // Adds the perturbation of the current test
+                       // frequency to the operating duty cycle.
+
+
+void BodeMeasure(int, unsigned int, int);    // Estimates the speed and feeds the
+                                             // Goertzel filters at each sample time.
+
+
+int BodeResult(int, struct BodePoint *);    // Takes a copy of the result at one test
+                                            // frequency, if it has been measured.
+
+#endif
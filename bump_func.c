@@ -0,0 +1,126 @@
+/*
+*  bump_func.c
+*  bumpless transfer functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO CHANGE MODE WITHOUT A SPEED DIP  */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "bump_func.h"
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "traj_func.h"
+#include "prof_func.h"
+#include "bode_func.h"
+#include "mpc_func.h"
+#include "globals.h"
+
+static int Bumpless = 0;    // Set if bumpless mode transfer is turned on
+
+/*
+* Function: BumplessConfig
+* --------------------------------
+* Turns bumpless mode transfer on or off (it is off by default).
+*
+* On: 1 to start each new mode from the running fan, 0 to start it
+* from a standstill.
+*/
+
+void BumplessConfig(int On)
+{
+
+    Bumpless = On;
+
+}
+
+/*
+* Function: BumplessEnabled
+* --------------------------------
+* Reports whether bumpless mode transfer is turned on.
+*
+* Returns: 1 if it is on or 0 if not.
+*/
+
+int BumplessEnabled(void)
+{
+
+    return Bumpless;
+}
+
+/*
+* Function: BumplessTransfer
+* --------------------------------
+* Called by the control path when a new mode is selected. If bumpless
+* transfer is on and the fan is being driven, the new mode is started
+* from the measured speed and the applied on-time instead of from a
+* standstill:
+*
+*   - the encoder position (DutyCycle) is aligned so that the open-loop
+*     and frequency-response modes keep the on-time and the closed-loop,
+*     thermostatic and predictive modes keep the measured speed as
+*     their desired speed;
+*   - the PID controller carries on from the on-time with cleared
+*     errors (its integrator is back-calculated to the on-time), and
+*     the trajectory starts from the measured speed;
+*   - the predictive controller holds the on-time and takes its
+*     disturbance estimate from the measured speed;
+*   - auto-mode plays its profile from the point closest to the
+*     on-time.
+*
+* The measured speed is kept rather than cleared.
+*
+* *Control: Pointer to the state of the control path, with the
+* setpoints of the new mode.
+*
+* Returns: 1 if the mode was started from the running fan or 0 if the
+* caller should start it from a standstill.
+*/
+
+int BumplessTransfer(struct ControlState *Control)
+{
+
+    int Speed = (Control->RPS*50)/MaxRPS; // Measured speed (0-50)
+
+    if (!Bumpless || Control->Setpoints.Mode == 0 || Control->OnTime == 0)
+    {
+        return 0;
+    }
+
+    switch (Control->Setpoints.Mode)
+    {
+    // Modes that set the on-time from the encoder position
+    case 1:
+    case 3:
+    case 5:
+        Control->DutyCycle = Control->OnTime;
+        break;
+    // Modes that set the desired speed from the encoder position
+    default:
+        Control->DutyCycle = Speed*2;
+        break;
+    }
+    Control->DesiredSpeed = Control->DutyCycle/2;
+
+    TrajectoryReset(Speed);
+    if (Control->Setpoints.Mode == 1)
+    {
+        ProfileSeek(Control->OnTime);
+    }
+    else
+    {
+        ProfileRestart();
+    }
+    BodeReset();
+    MpcReset(Control->OnTime, Control->RPS);
+
+    return 1;
+}
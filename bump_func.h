@@ -0,0 +1,29 @@
+/*
+*  bump_func.h
+*  bumpless transfer functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO CHANGE MODE WITHOUT A SPEED DIP  */
+/* ------------------------------------------------------------------ */
+
+#ifndef BUMP_FUNC_H
+#define BUMP_FUNC_H
+
+struct ControlState;
+
+// FUNCTION DECLARATIONS //
+
+void BumplessConfig(int);    // Turns bumpless mode transfer on or off.
+
+
+int BumplessEnabled(void);    // Reports whether bumpless mode transfer
+                              // is turned on.
+
+
+int BumplessTransfer(struct ControlState *);    // Starts the selected mode from the
+                                                // speed and on-time of the fan.
+
+#endif
@@ -0,0 +1,523 @@
+/*
+*  ctrl_func.c
+*  control and user interface tick functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------------- */
+/* SOURCE FILE FOR THE CONTROL AND USER INTERFACE PASSES OF THE MAIN LOOP */
+/* ---------------------------------------------------------------------- */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "ctrl_func.h"
+
+// Including other necessary custom headers
+#include "user_func.h"
+#include "fan_func.h"
+#include "disp_func.h"
+#include "input_func.h"
+#include "temp_func.h"
+#include "shared_func.h"
+#include "ipc_func.h"
+#include "metrics_func.h"
+#include "time_func.h"
+#include "traj_func.h"
+#include "prof_func.h"
+#include "kick_func.h"
+#include "bode_func.h"
+#include "wdog_func.h"
+#include "mpc_func.h"
+#include "stats_func.h"
+#include "bump_func.h"
+#include "lat_func.h"
+#include "board_func.h"
+#include "param_func.h"
+#include "autof_func.h"
+#include "persist_func.h"
+#include "globals.h"
+
+// State shared between the control path and the user interface
+static struct Shared SharedSetpoints;       // Written by UiTick, read by ControlTick
+static struct Shared SharedMeasurements;    // Written by ControlTick, read by UiTick
+
+/*
+* Function: ControlInit
+* --------------------------------
+* Sets the initial conditions of the control path: off-mode at 10 Hz
+* with a responsiveness of 1 and the fan stationary.
+*
+* *Control: Pointer to the state of the control path.
+*/
+
+void ControlInit(struct ControlState *Control)
+{
+
+    Control->Setpoints.Mode = 0;
+    Control->Setpoints.ModeEpoch = 0;
+    Control->Setpoints.ResetClosed = 0;
+    Control->Setpoints.PWMFrequency = 10;
+    Control->Setpoints.Responsiveness = 1;
+    Control->Setpoints.DutyCycle = 0;
+    Control->Setpoints.DutyEpoch = 0;
+    Control->Setpoints.ModeTime = 0;
+    Control->ModeEpoch = 0;
+    Control->DutyEpoch = 0;
+    Control->DutyCycle = 0;
+    Control->OnTime = 0;
+    Control->DesiredSpeed = 0;
+    Control->RPS = 0;
+    Control->Temperature = 0;
+    Control->FanOn = 0;
+    Control->ResetClosed = 0;
+    Control->GpioInputs = 0;
+    Control->Deadline = 0;
+
+}
+
+/*
+* Function: ControlDeadline
+* --------------------------------
+* Works out the counter value by which the control path next needs to
+* run: the next edge of the PWM signal, or the next input sample (every
+* ControlPollTicks) if that comes first. While the fan is off nothing
+* needs sampling but the keys, so the next pass can wait
+* ControlIdleTicks.
+*
+* *Control: Pointer to the state of the control path.
+*
+* Returns: The time of the deadline in counter ticks.
+*/
+
+static unsigned long long ControlDeadline(const struct ControlState *Control)
+{
+
+    unsigned long long Now = TimeNow();
+    unsigned long long Period; // Period of the PWM signal in ticks
+    unsigned long long Phase; // Position within the current period
+    unsigned long long Edge; // Next edge of the PWM signal
+    unsigned long long Deadline;
+
+    if (Control->Setpoints.Mode == 0)
+    {
+        return Now + ControlIdleTicks;
+    }
+
+    Deadline = Now + ControlPollTicks;
+
+    // The PWM signal only has edges while it is neither always low
+    // nor always high
+    if (Control->OnTime > 0 && Control->OnTime < 100)
+    {
+        Period = TimePeriod(Control->Setpoints.PWMFrequency);
+        Phase = Now%Period;
+        // First phase at which Timer gives a cycle of at least OnTime
+        Edge = (Control->OnTime*Period + 99)/100;
+        Edge = (Phase < Edge) ? Edge - Phase : Period - Phase;
+        if (Edge < ControlPollTicks)
+        {
+            Deadline = Now + Edge;
+        }
+    }
+
+    return Deadline;
+}
+
+/*
+* Function: ControlTick
+* --------------------------------
+* Runs one pass of the control path: samples the GPIO port, runs the
+* functions of the selected mode to drive the fan and publishes the
+* results for the user interface. It never waits on the user
+* interface; if the setpoints are being updated while they are read
+* the previous setpoints are used for this pass.
+*
+* *Control: Pointer to the state of the control path.
+*/
+
+void ControlTick(struct ControlState *Control)
+{
+
+    unsigned int Cycle = 0; // Current cycle of the counter, loops from 0 to 100
+    struct Measurements Results; // Values published for the user interface
+    int Planned; // Desired speed planned by the trajectory
+
+    WdogBegin(WdogControl);
+
+    // Applying parameters changed on the console, all at once between passes
+    ParamApply(ParamControl);
+
+    // Taking the latest setpoints from the user interface; the PWM
+    // frequency is lowered if the watchdog has shed everything else
+    SharedRead(&SharedSetpoints, &Control->Setpoints, sizeof(struct Setpoints));
+    Control->Setpoints.PWMFrequency = WdogFrequency(Control->Setpoints.PWMFrequency);
+
+    // Resetting variables to initial conditions when a new mode is selected,
+    // unless the new mode can take over the running fan (bumpless transfer)
+    if (Control->Setpoints.ModeEpoch != Control->ModeEpoch)
+    {
+        Control->ResetClosed = Control->Setpoints.ResetClosed;
+        Control->ModeEpoch = Control->Setpoints.ModeEpoch;
+        LatInput(LatKey, Control->Setpoints.ModeTime);
+        if (!BumplessTransfer(Control))
+        {
+            Control->DutyCycle = 0;
+            Control->OnTime = 0;
+            Control->RPS = 0;
+            TrajectoryReset(0);
+            ProfileRestart();
+            BodeReset();
+            MpcReset(0, 0);
+        }
+    }
+
+    // Taking a duty cycle requested by an external client
+    if (Control->Setpoints.DutyEpoch != Control->DutyEpoch)
+    {
+        Control->DutyCycle = Control->Setpoints.DutyCycle;
+        Control->DutyEpoch = Control->Setpoints.DutyEpoch;
+    }
+
+    // Sampling GPIO port 0 once per loop before any pin is driven
+    Control->GpioInputs = InputFilter(*GpioPort);
+
+    // Switch statement that determines which functions to run based on which mode is selected
+    switch (Control->Setpoints.Mode)
+    {
+
+    // Mode 0: Off-mode; fan is turned off
+    case 0:
+        *GpioPort = 0x00;
+        Control->OnTime = 0;
+        break;
+
+    // Mode 1: Auto-mode; the duty cycle follows the selected profile (by default
+    // it gradually increases and then decreases)
+    case 1:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DutyCycle = ProfilePlay(Control->Setpoints.Responsiveness);
+        Control->OnTime = Control->DutyCycle;
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    // Mode 2: Closed-loop; uses PID control to make sure the speed of the fan is similar to the desired speed
+    case 2:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DutyCycle = RotaryEncoder(Control->DutyCycle, Control->Setpoints.Responsiveness, Control->GpioInputs);
+        Control->DesiredSpeed = Control->DutyCycle/2;
+        // Adjusting OnTime through PID control, following a smooth path to the desired speed
+        Planned = Trajectory(Control->DesiredSpeed, Control->RPS);
+        Control->OnTime = ClosedLoopController(Planned, Control->RPS, Control->OnTime, &Control->ResetClosed);
+        Control->OnTime += TrajectoryFeedForward();
+        Control->OnTime = (Control->OnTime > 100) ? 100 : Control->OnTime;
+        Control->OnTime = (Control->OnTime < 0) ? 0 : Control->OnTime;
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    // Mode 3: Open-loop; standard mode that implements open-loop control
+    case 3:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DutyCycle = RotaryEncoder(Control->DutyCycle, Control->Setpoints.Responsiveness, Control->GpioInputs);
+        Control->DesiredSpeed = Control->DutyCycle/2;
+        Control->OnTime = Control->DutyCycle;
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    // Mode 4: Thermostatic; the desired speed follows the fan curve and is reached through PID control
+    case 4:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DesiredSpeed = Thermostat(Control->DutyCycle/2, Control->RPS, Control->Setpoints.Temperature,
+                                           &Control->Temperature);
+        Control->DutyCycle = Control->DesiredSpeed*2;
+        // Adjusting OnTime through PID control
+        Control->OnTime = ClosedLoopController(Control->DesiredSpeed, Control->RPS, Control->OnTime, &Control->ResetClosed);
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    // Mode 5: Frequency response; a sine is added to the duty cycle set by the rotary
+    // encoder and the response of the speed is measured at a number of frequencies
+    case 5:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DutyCycle = RotaryEncoder(Control->DutyCycle, Control->Setpoints.Responsiveness, Control->GpioInputs);
+        Control->DesiredSpeed = Control->DutyCycle/2;
+        Control->OnTime = BodeDrive(Control->DutyCycle);
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        BodeMeasure(Control->OnTime, Control->GpioInputs, Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    // Mode 6: Predictive; the on-time is looked up in a control table solved offline
+    // for the fan's model every time the speed is measured
+    case 6:
+        Cycle = Timer(Control->Setpoints.PWMFrequency);
+        Control->DutyCycle = RotaryEncoder(Control->DutyCycle, Control->Setpoints.Responsiveness, Control->GpioInputs);
+        Control->DesiredSpeed = Control->DutyCycle/2;
+        Control->OnTime = MpcController(Control->DesiredSpeed, Control->RPS);
+        Control->OnTime = StartAssist(Control->OnTime, Control->FanOn);
+        PWMGenerator(Cycle, Control->OnTime, &Control->FanOn);
+        // Updating RPS only when the PWM signal is high or the fan is completely stationary
+        if (Control->FanOn || (Control->OnTime == 0)) { Control->RPS = Tachometer(Control->RPS, Control->GpioInputs); }
+        break;
+
+    default:
+        break;
+
+    }
+
+    // A backend that drives the fan with its own PWM (hwmon) takes the on-time
+    // here, and its tachometer can also be read while the PWM pin is low
+    if (BoardDrive(Control->OnTime) && !Control->FanOn && (Control->OnTime != 0))
+    {
+        Control->RPS = Tachometer(Control->RPS, Control->GpioInputs);
+    }
+
+    // Following the latency of the last input to the PWM pin and the speed
+    LatPass(Control, (int)Cycle);
+
+    // Publishing the results for the user interface
+    Results.DutyCycle = Control->DutyCycle;
+    Results.OnTime = Control->OnTime;
+    Results.DesiredSpeed = Control->DesiredSpeed;
+    Results.RPS = Control->RPS;
+    Results.Temperature = Control->Temperature;
+    SharedWrite(&SharedMeasurements, &Results, sizeof(Results));
+
+    // Working out when the next pass is needed
+    Control->Deadline = ControlDeadline(Control);
+
+    // Sampling the windowed statistics and publishing the metrics of
+    // this pass for monitoring programs
+    WdogBegin(WdogMetrics);
+    WdogDeadline(Control->Deadline, (Control->Setpoints.Mode == 0) ? 0 : Control->Setpoints.PWMFrequency);
+    StatsSample(Control);
+    MetricsPublish(Control);
+
+}
+
+/*
+* Function: UiInit
+* --------------------------------
+* Sets the initial conditions of the user interface to match those
+* of the control path and publishes them.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+void UiInit(struct UiState *Ui)
+{
+
+    Ui->Setpoints.Mode = 0;
+    Ui->Setpoints.ModeEpoch = 0;
+    Ui->Setpoints.ResetClosed = 0;
+    Ui->Setpoints.PWMFrequency = 10;
+    Ui->Setpoints.Responsiveness = 1;
+    Ui->Setpoints.DutyCycle = 0;
+    Ui->Setpoints.DutyEpoch = 0;
+    Ui->Setpoints.ModeTime = 0;
+    Ui->Shown.DutyCycle = 0;
+    Ui->Shown.OnTime = 0;
+    Ui->Shown.DesiredSpeed = 0;
+    Ui->Shown.RPS = 0;
+    Ui->Shown.Temperature = 0;
+    Ui->ResetClosed = 0;
+    Ui->Scratch = 0;
+    Ui->SwitchFrequency = 10;
+    Ui->Setpoints.Temperature = TempFailSafe;
+    TempPoll(&Ui->Setpoints.Temperature);
+
+    SharedWrite(&SharedSetpoints, &Ui->Setpoints, sizeof(struct Setpoints));
+
+}
+
+/*
+* Function: UiTick
+* --------------------------------
+* Runs one pass of the user interface: reads the switches and keys,
+* publishes the selected setpoints for the control path and shows the
+* latest measurements on the LEDs and seven-segment displays. When a
+* new mode is selected the mode epoch is incremented so that the
+* control path resets its duty cycle, speed and (for the closed-loop
+* modes) PID state.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+void UiTick(struct UiState *Ui)
+{
+
+    int Switches4to0; // Takes in the values of SW4 to SW0
+    int Switches8to5; // Takes in the values of SW8 to SW5
+    int Switch9; // Takes in the value of SW9
+    int Mode; // Mode selected in this pass
+    int PWMFrequency; // PWM frequency selected through the switches
+    int Page; // Signal and window shown on the statistics page
+    struct StatsSummary Summary; // Statistics shown on the statistics page
+    unsigned long long ReadTime; // Time the measurements were taken from the control path
+    unsigned int KeyTime; // Low 32 bits of the counter when the keys were read
+
+    WdogBegin(WdogUi);
+
+    // Applying parameters changed on the console, all at once between passes
+    ParamApply(ParamUi);
+
+    // Taking the latest measurements from the control path
+    ReadTime = TimeNow();
+    SharedRead(&SharedMeasurements, &Ui->Shown, sizeof(struct Measurements));
+
+    // Extracting the required values from the switches
+    Switches4to0 = (*Switches)&31;
+    Switches8to5 = ((*Switches)&480) >> 5;
+    Switch9 = ((*Switches)&512) >> 9;
+
+    // Lighting up the LEDs based on the value of DutyCycle
+    WdogBegin(WdogLeds);
+    if (WdogAllow(WdogLeds))
+    {
+        LEDLights(Ui->Shown.DutyCycle);
+    }
+    WdogBegin(WdogUi);
+
+    // Selecting the PWMFrequency and Responsiveness based on the relevant switch
+    // values; a frequency set by an external client holds until the switches change
+    PWMFrequency = FreqSelect(Switches4to0, Ui->SwitchFrequency);
+    if (PWMFrequency != Ui->SwitchFrequency)
+    {
+        Ui->Setpoints.PWMFrequency = PWMFrequency;
+        Ui->SwitchFrequency = PWMFrequency;
+    }
+    Ui->Setpoints.Responsiveness = RespSelect(Switches8to5, Ui->Setpoints.Responsiveness);
+
+    // Choosing the PWMFrequency automatically if selected
+    AutofTick(Ui, Switches4to0 == AutofSwitches);
+
+    // Selecting the desired mode; the values ModeSelect resets belong
+    // to the control path, which resets them when the epoch changes. The
+    // selection is tagged with the time the keys were read, before the
+    // mode name is scrolled, for latency tracing
+    KeyTime = (unsigned int)TimeNow();
+    Mode = ModeSelect(Ui->Setpoints.Mode, &Ui->Scratch, &Ui->Scratch, &Ui->ResetClosed);
+    if (Mode != Ui->Setpoints.Mode)
+    {
+        Ui->Setpoints.Mode = Mode;
+        Ui->Setpoints.ModeEpoch++;
+        Ui->Setpoints.ModeTime = KeyTime;
+        Ui->Setpoints.ResetClosed = Ui->ResetClosed;
+        Ui->ResetClosed = 0;
+    }
+
+    // Taking any setpoints sent by external clients and any console
+    // commands, and keeping the learnt state
+    WdogBegin(WdogIpc);
+    IpcPoll(Ui);
+    ParamPoll();
+    PersistPoll(Ui->Shown.OnTime, Ui->Shown.RPS);
+    WdogBegin(WdogUi);
+
+    // Reading a file or hwmon temperature sensor here rather than in
+    // the control path, where file access could block
+    TempPoll(&Ui->Setpoints.Temperature);
+
+    // Publishing the setpoints for the control path
+    SharedWrite(&SharedSetpoints, &Ui->Setpoints, sizeof(struct Setpoints));
+
+    // Displaying relevant information on the seven-segment displays, or
+    // stepping through the windowed statistics if their page is selected
+    WdogBegin(WdogDisplay);
+    if (WdogAllow(WdogDisplay))
+    {
+        if (Switches8to5 == StatsPageSwitches)
+        {
+            Page = (TimeNow()/StatsPageTicks)%(StatsSignals*StatsWindows);
+            if (StatsRead(Page/StatsWindows, Page%StatsWindows, &Summary))
+            {
+                StatsDisplay(Page/StatsWindows, Page%StatsWindows, Switch9, &Summary);
+            }
+        }
+        else
+        {
+            Display(Ui->Setpoints.Mode, Switch9, Ui->Shown.DutyCycle, Ui->Shown.RPS, Ui->Shown.DesiredSpeed,
+                    Ui->Shown.OnTime, Ui->Setpoints.PWMFrequency, Ui->Shown.Temperature);
+            LatDisplayed(ReadTime);
+        }
+    }
+
+}
+
+/*
+* Function: UiSetMode
+* --------------------------------
+* Selects a mode as if its key had been pressed, without scrolling its
+* name across the displays. Selecting the mode that is already running
+* has no effect.
+*
+* *Ui: Pointer to the state of the user interface.
+* Mode: The mode to select (0-6).
+*/
+
+void UiSetMode(struct UiState *Ui, int Mode)
+{
+
+    if (Mode != Ui->Setpoints.Mode)
+    {
+        Ui->Setpoints.Mode = Mode;
+        Ui->Setpoints.ModeEpoch++;
+        Ui->Setpoints.ModeTime = (unsigned int)TimeNow();
+        // The closed-loop modes start with a fresh controller
+        Ui->Setpoints.ResetClosed = (Mode == 2) || (Mode == 4);
+    }
+
+}
+
+/*
+* Function: UiSetDutyCycle
+* --------------------------------
+* Asks the control path to take a new duty cycle at its next pass. In
+* closed-loop mode this sets the desired speed to half the duty cycle;
+* in thermostatic mode the fan curve takes over again at its next
+* update.
+*
+* *Ui: Pointer to the state of the user interface.
+* DutyCycle: The new duty cycle (0-100).
+*/
+
+void UiSetDutyCycle(struct UiState *Ui, int DutyCycle)
+{
+
+    Ui->Setpoints.DutyCycle = DutyCycle;
+    Ui->Setpoints.DutyEpoch++;
+
+}
+
+/*
+* Function: UiSetFrequency
+* --------------------------------
+* Selects a PWM frequency that holds until the switches are changed.
+*
+* *Ui: Pointer to the state of the user interface.
+* PWMFrequency: The new frequency in Hz.
+*/
+
+void UiSetFrequency(struct UiState *Ui, int PWMFrequency)
+{
+
+    Ui->Setpoints.PWMFrequency = PWMFrequency;
+
+}
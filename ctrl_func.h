@@ -0,0 +1,114 @@
+/*
+*  ctrl_func.h
+*  control and user interface tick functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------------- */
+/* HEADER FILE FOR THE CONTROL AND USER INTERFACE PASSES OF THE MAIN LOOP */
+/* ---------------------------------------------------------------------- */
+
+#ifndef CTRL_FUNC_H
+#define CTRL_FUNC_H
+
+// Longest time between passes of the control path, in counter ticks
+#define ControlPollTicks 12500      // While the fan is running (250 us)
+#define ControlIdleTicks 500000     // While the fan is off (10 ms)
+
+/*
+* Settings chosen through the keys and switches, published by the
+* user interface and read by the control path.
+*/
+
+struct Setpoints
+{
+    int Mode;               // Mode that is selected based on the pressed key
+    int ModeEpoch;          // Incremented every time a new mode is selected
+    int ResetClosed;        // Set if the new mode should reset the closed-loop controller
+    int PWMFrequency;       // Operating frequency of the fan
+    int Responsiveness;     // Rate at which the rotary encoder affects the duty cycle
+    int DutyCycle;          // Duty cycle requested by an external client (0-100)
+    int DutyEpoch;          // Incremented every time an external client requests a duty cycle
+    unsigned int ModeTime;  // Low 32 bits of the counter when the mode was selected
+    int Temperature;        // Temperature read by TempPoll in millidegrees Celsius
+};
+
+/*
+* Values produced by the control path, published for the user
+* interface.
+*/
+
+struct Measurements
+{
+    int DutyCycle;          // Duty cycle of the PWM (0-100)
+    int OnTime;             // On-time of the PWM (0-100)
+    int DesiredSpeed;       // Desired speed of the fan (0-50)
+    int RPS;                // Speed of the fan in RPS
+    int Temperature;        // Measured temperature in millidegrees Celsius
+};
+
+/*
+* State owned by the control path: PWM generation, the tachometer, the
+* rotary encoder and the controllers of every mode.
+*/
+
+struct ControlState
+{
+    struct Setpoints Setpoints;     // Latest setpoints taken from the user interface
+    int ModeEpoch;                  // Mode epoch the state below was reset for
+    int DutyEpoch;                  // Duty epoch last applied to DutyCycle
+    int DutyCycle;                  // Duty cycle of the PWM, can be any integer between 0 and 100
+    int OnTime;                     // On-time of the PWM, equivalent to DutyCycle in open loop
+    int DesiredSpeed;               // A function of DutyCycle with a minimum value of 0 and a maximum value of 50
+    int RPS;                        // Speed of the fan in RPS
+    int Temperature;                // Measured temperature in millidegrees Celsius
+    int FanOn;                      // Integer that determines if fan is on or off (0-1)
+    int ResetClosed;                // Integer that determines if closed-loop errors should be reset
+    unsigned int GpioInputs;        // Filtered state of the pins on GPIO port 0
+    unsigned long long Deadline;    // Time by which the next pass is needed (see TimeNow)
+};
+
+/*
+* State owned by the user interface: the keys, switches, LEDs and
+* seven-segment displays.
+*/
+
+struct UiState
+{
+    struct Setpoints Setpoints;     // Setpoints selected through the keys and switches
+    struct Measurements Shown;      // Latest measurements taken from the control path
+    int ResetClosed;                // Set by ModeSelect when the closed-loop controller should be reset
+    int Scratch;                    // Receives the values ModeSelect resets on the control side
+    int SwitchFrequency;            // PWM frequency last selected through the switches
+};
+
+// FUNCTION DECLARATIONS //
+
+void ControlInit(struct ControlState *);    // Sets the initial conditions of the
+                                            // control path.
+
+
+void ControlTick(struct ControlState *);    // Runs one pass of the control path for
+                                            // the selected mode.
+
+
+void UiInit(struct UiState *);    // Sets the initial conditions of the user
+                                  // interface.
+
+
+void UiTick(struct UiState *);    // Runs one pass of the user interface.
+
+
+void UiSetMode(struct UiState *, int);    // Selects a mode as if its key
+                                          // had been pressed.
+
+
+void UiSetDutyCycle(struct UiState *, int);    // Asks the control path to
+                                               // take a new duty cycle.
+
+
+void UiSetFrequency(struct UiState *, int);    // Selects a PWM frequency until
+                                               // the switches are changed.
+
+#endif
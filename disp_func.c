@@ -18,6 +18,8 @@
 
 // Including other necessary custom headers
 #include "misc_func.h"
+#include "stats_func.h"
+#include "bump_func.h"
 #include "globals.h"
 
 /*
@@ -28,21 +30,27 @@
 * can be displayed for each mode; the set that is displayed is
 * determined by the value of SW9.
 *
-* Mode: The selected operating mode of the system (0-3).
+* Mode: The selected operating mode of the system (0-6).
 * Switch9: The value of SW9 on the FPGA.
 * DutyCycle: The operating duty cycle (0-100).
 * RPS: The speed of the fan in revolutions per second.
 * DesiredSpeed: The desired speed set by the user (0-50).
 * OnTime: The number of cycles during which the fan is turned on (0=100).
 * PWMFrequnecy: The operating frequency of the fan in Hz.
+* Temperature: The measured temperature in millidegrees Celsius.
 */
 
-void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, int OnTime, int PWMFrequency)
+void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, int OnTime, int PWMFrequency, int Temperature)
 {
 
     int MultiDigit; // Variable used to write values onto the seven-segment displays
     int RPM = RPS*60; // Measured seed of the fan in RPM
     int MeasuredSpeed = (RPS*50)/MaxRPS; // Scaled measured speed (0-50)
+    int Celsius = Temperature/1000; // Measured temperature in degrees Celsius
+
+    // Restricting the temperature to the two available digits
+    Celsius = (Celsius > 99) ? 99 : Celsius;
+    Celsius = (Celsius < 0) ? 0 : Celsius;
 
     // Determining what set of values to display based on the position of SW9
     if (!Switch9)
@@ -80,6 +88,33 @@ void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, in
             *Hex3to0 = MultiDigit;
             *Hex5to4 = (segO << 8) | (segP);
             break;
+        // tH displayed using HEX5 and HEX4; temperature in degrees
+        // Celsius displayed using HEX3 and HEX2; measured speed
+        // displayed using HEX1 and HEX0
+        case 4:
+            MultiDigit = (MultiDigitDecoder(MeasuredSpeed)) & ((segBlank << 8) | (segBlank));
+            MultiDigit |= (MultiDigitDecoder(Celsius)) << 16;
+            *Hex3to0 = MultiDigit;
+            *Hex5to4 = (segT << 8) | (segH);
+            break;
+        // bd displayed using HEX5 and HEX4; desired speed displayed
+        // using HEX3 and HEX2; measured speed displayed using HEX1
+        // and HEX0
+        case 5:
+            MultiDigit = (MultiDigitDecoder(MeasuredSpeed)) & ((segBlank << 8) | (segBlank));
+            MultiDigit |= (MultiDigitDecoder(DesiredSpeed)) << 16;
+            *Hex3to0 = MultiDigit;
+            *Hex5to4 = (segB << 8) | (segD);
+            break;
+        // Pr displayed using HEX5 and HEX4; desired speed displayed
+        // using HEX3 and HEX2; measured speed displayed using HEX1
+        // and HEX0
+        case 6:
+            MultiDigit = (MultiDigitDecoder(MeasuredSpeed)) & ((segBlank << 8) | (segBlank));
+            MultiDigit |= (MultiDigitDecoder(DesiredSpeed)) << 16;
+            *Hex3to0 = MultiDigit;
+            *Hex5to4 = (segP << 8) | (segR);
+            break;
         default:
             break;
         }
@@ -111,6 +146,21 @@ void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, in
             *Hex3to0 = MultiDigitDecoder(RPM);
             *Hex5to4 = (segO << 8) | (segP);
             break;
+        // On time displayed using HEX2 to HEX0
+        case 4:
+            *Hex3to0 = (segBlank << 24) | MultiDigitDecoder(OnTime);
+            *Hex5to4 = (segT << 8) | (segH);
+            break;
+        // On time displayed using HEX2 to HEX0
+        case 5:
+            *Hex3to0 = (segBlank << 24) | MultiDigitDecoder(OnTime);
+            *Hex5to4 = (segB << 8) | (segD);
+            break;
+        // On time displayed using HEX2 to HEX0
+        case 6:
+            *Hex3to0 = (segBlank << 24) | MultiDigitDecoder(OnTime);
+            *Hex5to4 = (segP << 8) | (segR);
+            break;
         default:
             break;
         }
@@ -118,6 +168,81 @@ void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, in
     
 }
 
+/*
+* Function: TwoDigits
+* --------------------------------
+* Converts an integer to the segment values of two seven-segment
+* displays, showing a minus sign on the left display for negative
+* values. Values that do not fit are limited to -9 and 99.
+*
+* Value: The integer.
+*
+* Returns: The segment values of the two displays in the low 16 bits.
+*/
+
+static int TwoDigits(int Value)
+{
+
+    if (Value < 0)
+    {
+        Value = (Value < -9) ? 9 : -Value;
+        return (segMinus << 8) | SevenSegmentDecoder(Value);
+    }
+
+    Value = (Value > 99) ? 99 : Value;
+
+    return MultiDigitDecoder(Value) & ((segBlank << 8) | (segBlank));
+}
+
+/*
+* Function: Rounded
+* --------------------------------
+* Rounds a value in hundredths to the nearest whole number.
+*
+* Hundredths: The value in hundredths.
+*
+* Returns: The nearest whole number.
+*/
+
+static int Rounded(int Hundredths)
+{
+
+    return (Hundredths < 0) ? -((50 - Hundredths)/100) : (Hundredths + 50)/100;
+}
+
+/*
+* Function: StatsDisplay
+* --------------------------------
+* Displays the statistics of one signal over one window: the signal
+* on HEX5 (r for the speed, P for the on-time, E for the tracking
+* error) and the window on HEX4 (1 for 1 s, 2 for 10 s, 3 for 60 s).
+* If SW9 is down the minimum is displayed on HEX3 and HEX2 and the
+* maximum on HEX1 and HEX0; if SW9 is up the mean and the standard
+* deviation are displayed instead.
+*
+* Signal: The signal (StatsSpeed, StatsOnTime or StatsError).
+* Window: The window (Stats1s, Stats10s or Stats60s).
+* Switch9: The value of SW9 on the FPGA.
+* *Summary: Pointer to the statistics.
+*/
+
+void StatsDisplay(int Signal, int Window, int Switch9, const struct StatsSummary *Summary)
+{
+
+    int Letters[StatsSignals] = {segR, segP, segE}; // Letter shown for each signal
+
+    if (!Switch9)
+    {
+        *Hex3to0 = (TwoDigits(Summary->Min) << 16) | TwoDigits(Summary->Max);
+    }
+    else
+    {
+        *Hex3to0 = (TwoDigits(Rounded(Summary->Mean)) << 16) | TwoDigits(Rounded(Summary->Deviation));
+    }
+    *Hex5to4 = (Letters[Signal] << 8) | SevenSegmentDecoder(Window + 1);
+
+}
+
 /*
 * Function: ScrollDisplay
 * --------------------------------
@@ -125,6 +250,10 @@ void Display(int Mode, int Switch9, int DutyCycle, int RPS, int DesiredSpeed, in
 * displays them by scrolling them from left to right on the
 * seven-segment displays.
 *
+* If bumpless mode transfer is turned on the values are displayed at
+* once, as the scroll would otherwise hold up the loop, and with it
+* the fan, when a mode is selected.
+*
 * SegArray[]: Integer rray of segment values to be displayed
 * on the seven-segment displays.
 */
@@ -134,6 +263,13 @@ void ScrollDisplay(int SegArray[])
     
     int Del = 500000; // The delay between shifting each displayed value
 
+    if (BumplessEnabled())
+    {
+        *Hex3to0 = (SegArray[2] << 24) | (SegArray[3] << 16) | (SegArray[4] << 8) | (SegArray[5]);
+        *Hex5to4 = (SegArray[0] << 8) | (SegArray[1]);
+        return;
+    }
+
     // Setting the seven-segment displays to be blank
     *Hex3to0 = (segBlank << 24) | (segBlank << 16) | (segBlank << 8) | (segBlank);
     *Hex5to4 = (segBlank << 8) | (segBlank);
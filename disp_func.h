@@ -12,11 +12,17 @@
 #ifndef DISP_FUNC_H
 #define DISP_FUNC_H
 
+struct StatsSummary;
+
 // FUNCTION DECLARATIONS //
 
-void Display(int, int, int, int, int, int, int);    // Displays key information onto the
-                                                    // seven-segment displays relevant to
-                                                    // the selected mode.
+void Display(int, int, int, int, int, int, int, int);    // Displays key information onto the
+                                                         // seven-segment displays relevant to
+                                                         // the selected mode.
+
+
+void StatsDisplay(int, int, int, const struct StatsSummary *);    // Displays the statistics of one
+                                                                 // signal over one window.
 
 
 void ScrollDisplay(int[]);    // Displays values by scrolling them
@@ -18,14 +18,19 @@
 
 // Including other necessary custom headers
 #include "misc_func.h"
+#include "time_func.h"
 #include "globals.h"
 
+// Counters and PID terms kept for the metrics page
+static struct FanStats Stats;
+
 /*
 * Function: Timer
 * --------------------------------
-* Uses the internal counter of the FPGA (*Counter) to create a cycle
-* count that loops from 0 to 100. The time it takes to increment is
-* dependent on the PWM frequency.
+* Uses the time base (see TimeUpdate) to create a cycle count that
+* loops from 0 to 100. The time it takes to increment is dependent on
+* the PWM frequency. Periods are aligned to the 64-bit time, so the
+* wrap of the 32-bit counter does not cut a period short.
 *
 * PWMFrequency: Operating frequency of the fan in Hz.
 *
@@ -37,10 +42,12 @@ int Timer(int PWMFrequency)
 {
 
     static int Cycle = 0; // Cycle count of the system
-    int Period = ClockFrequency/PWMFrequency; // Period of the system
+    static struct TimeWindow Window; // Current period of the PWM signal
+    unsigned long long Period = TimePeriod(PWMFrequency); // Period of the system
 
     // Setting cycle to a value between 0 and 100 based on the period
-    Cycle = (100*(*Counter%Period))/Period;
+    TimeWindowUpdate(&Window, Period);
+    Cycle = (100*(TimeNow() - Window.Start))/Period;
 
     return Cycle;
 }
@@ -56,22 +63,24 @@ int Timer(int PWMFrequency)
 * DutyCycle: The current operating duty cycle (0-100).
 * Responsiveness: The rate at which rotating the encoder affects the
 * duty cycle (i.e. sensitivity).
+* GpioInputs: The filtered state of the GPIO port (see InputFilter).
 *
 * Returns: DutyCycle, the new duty cycle that was either incremented
 * decremented or unchanged.
 */
 
-int RotaryEncoder(int DutyCycle, int Responsiveness)
+int RotaryEncoder(int DutyCycle, int Responsiveness, unsigned int GpioInputs)
 {
 
     int AState; // Current value of pin A of the rotary encoder
     int BState; // Current value of pin B of the rotary encoder
     static int APrevState; // Previous value of pin A of the rotary encoder
+    static int BPrevState; // Previous value of pin B of the rotary encoder
 
     // Reading the values of pin A and B of the rotary encoder from the relevant
-    // pins on GPIO port 0
-    AState = (*GpioPort >> 17) & 0x01;
-    BState = (*GpioPort >> 19) & 0x01;
+    // pins on the filtered GPIO port 0
+    AState = (GpioInputs >> 17) & 0x01;
+    BState = (GpioInputs >> 19) & 0x01;
 
     // Determining if the rotary encoder is being rotated by
     // comparing the AState with APrevState
@@ -83,81 +92,30 @@ int RotaryEncoder(int DutyCycle, int Responsiveness)
         if (AState != BState)
         {
             // Incrementing the duty cycle
-            DutyCycle += (1*Responsiveness);
+            DutyCycle += (EncoderStep*Responsiveness);
         }
         else
         {
             // Decrementing the duty cycle
-            DutyCycle -= (1*Responsiveness);
+            DutyCycle -= (EncoderStep*Responsiveness);
         }
+        Stats.EncoderSteps++;
     }
 
-    // Restricting the value of the duty cycle between 0 and 100
-    DutyCycle = (DutyCycle > 100) ? 100 : DutyCycle;
-    DutyCycle = (DutyCycle < 0) ? 0 : DutyCycle;
-
-    // Setting the previous value of pin A
-    APrevState = AState;
-
-    return DutyCycle;
-}
-
-/*
-* Function: AutoEncoder
-* --------------------------------
-* Automatically increments the value of the DutyCycle by 1 every 7500
-* loops. Once a duty cycle of 100 is achieved, the function then begins
-* decrementing the duty cycle until it reaches 0 and then begins
-* incrementing it again. This goes on continuously. A change is made
-* every 7500 loops so that users can clearly see the change in fan
-* speed (which is linked to the duty cycle).
-*
-* DutyCycle: The current operating duty cycle (0-100).
-* Multiplier: An integer that determines how quickly the fan
-* changes speed.
-*
-* Returns: DutyCycle, the new duty cycle that was either incremented
-* decremented.
-*/
-
-int AutoEncoder(int DutyCycle, int Multiplier)
-{
-
-    static int Flag = 0; // Determines if DutyCycle should be incremented or decremented
-    static int Loop = 0; // Integer that represents the loop number
-    int LoopEnd = 1000*Multiplier; // End point of loop
-
-    // DutyCycle is only altered when Loop reaches a certain multiple;
-    // this is done to ensure that changes in the fan's speed can be
-    // seen by the user
-    if (Loop >= LoopEnd)
+    // Counting transitions that were missed because both pins changed
+    // between two samples
+    if (AState != APrevState && BState != BPrevState)
     {
-        // Determining whether the DutyCycle should be incremented or
-        // decremented based on the value of the flag
-        if (Flag == 0) {
-            // Incrementing duty cycle
-            DutyCycle++;
-        }
-        else
-        {
-            // Decrementing duty cycle
-            DutyCycle--;
-        }
-
-        // Resetting the loop number after a change is made
-        Loop = 0;
-
+        Stats.EncoderMissed++;
     }
 
     // Restricting the value of the duty cycle between 0 and 100
     DutyCycle = (DutyCycle > 100) ? 100 : DutyCycle;
     DutyCycle = (DutyCycle < 0) ? 0 : DutyCycle;
 
-    // Changing the value of the flag once a duty cycle limit is reached
-    Flag = (DutyCycle == 100) ? 1 : Flag;
-    Flag = (DutyCycle == 0) ? 0 : Flag;
-
-    Loop++;
+    // Setting the previous values of pin A and pin B
+    APrevState = AState;
+    BPrevState = BState;
 
     return DutyCycle;
 }
@@ -173,7 +131,9 @@ int AutoEncoder(int DutyCycle, int Multiplier)
 * RPS: The measured speed of the fan in revolutions per second (0-42).
 * OnTime: The number of cycles during which the fan is turned on (0-100).
 * *ResetClosed: Pointer to integer determining if the static variables
-* should be reset.
+* should be reset. The errors are then cleared and the controller
+* carries on from OnTime, so a controller started from a fan that is
+* already running (bumpless transfer) holds its on-time.
 *
 * Returns: OnTime, the controlled number of on cycles, which is used to
 * control the speed of the fan.
@@ -197,7 +157,7 @@ int ClosedLoopController(int DesiredSpeed, int RPS, int OnTime, int *ResetClosed
         // Resetting static variables
         Integral = 0.0;
         PrevError = 0.0;
-        Timing = 0.0;
+        Timing = OnTime;
         Set(ResetClosed, 0);
     }
 
@@ -218,7 +178,10 @@ int ClosedLoopController(int DesiredSpeed, int RPS, int OnTime, int *ResetClosed
     Derivative = Error - PrevError;
 
     // Applying PID control to the intermediary variable
-    Timing += Kp*Error + Ki*Integral + Kd*Derivative;
+    Stats.Proportional = Kp*Error;
+    Stats.Integral = Ki*Integral;
+    Stats.Derivative = Kd*Derivative;
+    Timing += Stats.Proportional + Stats.Integral + Stats.Derivative;
 
     // Limiting the intermediary variable between 0 and 100
     Timing = (Timing >= 101.0) ? 100.0 : Timing;
@@ -267,6 +230,7 @@ void PWMGenerator(int Cycle, int OnTime, int *FanOn)
         *GpioPort = 0x00;
         Set(FanOn, 0);
     }
+    Stats.GpioWrites++;
 
 }
 
@@ -277,51 +241,64 @@ void PWMGenerator(int Cycle, int OnTime, int *FanOn)
 * tachometer to detect any rising edges, which are used to determine the
 * number of half-revolutions that occur in 0.5 seconds. The speed of the
 * fan is then calculated based on the measured number of half-revolutions.
+* Glitches on the pin are removed beforehand by InputFilter.
 *
 * RPS: The speed of the fan in revolutions per second.
+* GpioInputs: The filtered state of the GPIO port (see InputFilter).
 *
 * Returns: RPS, the updated or unchanged speed of the fan.
 */
 
-int Tachometer(int RPS)
+int Tachometer(int RPS, unsigned int GpioInputs)
 {
 
-    int Count; // Count value based on the counter
-    static int PrevCount; // Value of count in previous loop
+    static struct TimeWindow Window; // Current half-second window
 
     int TachState; // Current value of the tachometer pin
     static int PrevTachState; // Previous value of the tachometer pin
-    static int BeforePrevTachState; // Value of the tachometer pin before previous value
 
     static int HalfRevolutions = 0; // Number of half revolutions the fan undergoes
 
-    // Increment count every half a second
-    Count = (*Counter/(ClockFrequency/2));
-
     // Reads the value of the tachometer pin
-    TachState = (*GpioPort >> 1) & 0x01;
+    TachState = (GpioInputs >> 1) & 0x01;
 
-    // Determining if a half-second has passed
-    if (Count != PrevCount)
+    // Determining if a half-second has passed; the windows follow the
+    // 64-bit time, so the wrap of the counter does not end one early
+    if (TimeWindowUpdate(&Window, ClockFrequency/2))
     {
         // Updating the RPS and resetting the process
         RPS = HalfRevolutions;
         HalfRevolutions = 0;
+        Stats.TachWindows++;
     }
     else
     {
-        // Detecting rising edges in the tachometer signal (built-in low-pass filter)
-        if (TachState == 1 && PrevTachState == 1 && (PrevTachState != BeforePrevTachState))
+        // Detecting rising edges in the filtered tachometer signal
+        if (TachState == 1 && PrevTachState == 0)
         {
             // Incrementing half revolutions by 1 for each rising edge
             HalfRevolutions++;
+            Stats.TachEdges++;
         }
     }
 
-    // Setting previous states to the values of the current states
-    PrevCount = Count;
-    BeforePrevTachState = PrevTachState;
+    // Setting the previous state to the value of the current state
     PrevTachState = TachState;
 
     return RPS;
 }
+
+/*
+* Function: FanStatsGet
+* --------------------------------
+* Gives access to the counters and PID terms kept by the functions
+* above, for the metrics page. The counters wrap around.
+*
+* Returns: A pointer to the statistics, updated in place.
+*/
+
+const struct FanStats *FanStatsGet(void)
+{
+
+    return &Stats;
+}
@@ -12,6 +12,22 @@
 #ifndef FAN_FUNC_H
 #define FAN_FUNC_H
 
+/*
+* Counters and the latest PID terms kept by the fan functions.
+*/
+
+struct FanStats
+{
+    unsigned int TachEdges;         // Rising edges counted by Tachometer
+    unsigned int TachWindows;       // Half-second windows after which Tachometer updated the speed
+    unsigned int EncoderSteps;      // Steps decoded by RotaryEncoder
+    unsigned int EncoderMissed;     // Encoder samples in which both pins changed
+    unsigned int GpioWrites;        // Writes to GPIO port 0 by PWMGenerator
+    float Proportional;             // Proportional term of the last PID update
+    float Integral;                 // Integral term of the last PID update
+    float Derivative;               // Derivative term of the last PID update
+};
+
 // FUNCTION DECLARATIONS //
 
 int Timer(int);    // Uses * Counter to create a cycle count that
@@ -19,13 +35,8 @@ int Timer(int);    // Uses * Counter to create a cycle count that
                    // the period.
 
 
-int RotaryEncoder(int, int);    // Increases or decreases the value of the duty
-                                // cycle based on the rotation of the rotary encoder.
-
-
-int AutoEncoder(int, int);   // Slowly increases the duty cycle to a maximum
-                        	 // before decreasing it to a minimum. This loop
-                             // occurs repeatedly.
+int RotaryEncoder(int, int, unsigned int);    // Increases or decreases the value of the duty
+                                              // cycle based on the rotation of the rotary encoder.
 
 
 int ClosedLoopController(int, int, int, int *);    // Implements PID control on the on-time of the
@@ -37,7 +48,11 @@ void PWMGenerator(int, int, int *);    // Turns the fan on and off by sending a
                                        // that is high or low to the relevant pin on the
                                        // GPIO Port of the FPGA.
 
-int Tachometer(int);    // Calculates the speed of the fan in RPS
-                        // using the tachometer pin.
+int Tachometer(int, unsigned int);    // Calculates the speed of the fan in RPS
+                                      // using the tachometer pin.
+
+
+const struct FanStats *FanStatsGet(void);    // Gives access to the counters and
+                                             // PID terms of the fan functions.
 
 #endif
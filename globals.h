@@ -17,11 +17,12 @@
 #define key1 0xD
 #define key2 0xB
 #define key3 0x7
+#define key23 0x3
+#define key12 0x9
+#define key13 0x5
 
-// PID control constants
-#define Kp 0.000025
-#define Ki 0.000000000015
-#define Kd 0.8
+// Feed-forward of the planned speed change (on-time per unit/s)
+#define Kff 0.5
 
 // Seven-segment values
 #define seg0 0x40
@@ -35,10 +36,12 @@
 #define seg8 0x00
 #define seg9 0x10
 #define segA 0x08
+#define segB 0x03
 #define segC 0x46
 #define segD 0x21
 #define segE 0x06
 #define segF 0x0E
+#define segH 0x09
 #define segL 0x47
 #define segN 0x2B
 #define segO 0x40
@@ -47,8 +50,13 @@
 #define segS 0x12
 #define segT 0x07
 #define segU 0x41
+#define segMinus 0x3F
 #define segBlank 0xFF
 
+// Number of entries in the tables of selectable values
+#define FreqChoiceCount 6      // PWM frequencies selected through SW0 to SW4
+#define RespChoiceCount 5      // Responsiveness values selected through SW5 to SW8
+
 // Declaring pointers that allow interaction with the FPGA //
 
 extern volatile int * LEDs;                // Indicates the address of the 10 LEDs
@@ -62,6 +70,15 @@ extern volatile int * Hex5to4;             // Indicates the address of hexadecim
 // Declaring constant globals // 
 
 extern const int ClockFrequency;           // Frequency of the internal clock of the FPGA
-extern const int MaxRPS;                   // Pre-determined maximum speed of the fan in RPS
+
+// Declaring tunable globals, changed through the parameter registry //
+
+extern float Kp;                           // Proportional gain of the PID controller
+extern float Ki;                           // Integral gain of the PID controller
+extern float Kd;                           // Derivative gain of the PID controller
+extern int MaxRPS;                         // Pre-determined maximum speed of the fan in RPS
+extern int EncoderStep;                    // Duty cycle change per encoder step, before Responsiveness
+extern int FreqChoices[FreqChoiceCount];   // PWM frequencies in Hz selectable through the switches
+extern int RespChoices[RespChoiceCount];   // Responsiveness values selectable through the switches
 
 #endif
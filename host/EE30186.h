@@ -0,0 +1,18 @@
+/*
+*  EE30186.h
+*  stand-in for the EE30186 board support header on the Linux build
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------------- */
+/* HOST HEADER USED IN PLACE OF THE BOARD SUPPORT PACKAGE ON LINUX   */
+/* ----------------------------------------------------------------- */
+
+// The Linux build (-DFAN_LINUX -Ihost) does not use the board support
+// package; board_func.c sets up the registers instead of EE30186_Start.
+
+#ifndef EE30186_H
+#define EE30186_H
+
+#endif
@@ -0,0 +1,15 @@
+/*
+*  socal.h
+*  stand-in for the SoC abstraction layer header on the Linux build
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------------- */
+/* HOST HEADER USED IN PLACE OF THE SOCAL HEADER ON LINUX            */
+/* ----------------------------------------------------------------- */
+
+#ifndef SOCAL_H
+#define SOCAL_H
+
+#endif
@@ -0,0 +1,46 @@
+/*
+*  system.h
+*  stand-in for the generated system header on the Linux build
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------------- */
+/* HOST HEADER USED IN PLACE OF THE GENERATED SYSTEM HEADER ON LINUX */
+/* ----------------------------------------------------------------- */
+
+// Addresses of the peripherals behind the lightweight HPS-to-FPGA
+// bridge. These must match the FPGA design that is loaded; the values
+// below follow the DE1-SoC Computer layout and can be overridden with
+// -D on the command line or by putting the generated system.h of the
+// design ahead of this directory on the include path.
+
+#ifndef SYSTEM_H
+#define SYSTEM_H
+
+#ifndef ALT_LWFPGA_BASE
+#define ALT_LWFPGA_BASE 0xFF200000
+#endif
+#ifndef ALT_LWFPGA_LED_BASE
+#define ALT_LWFPGA_LED_BASE 0xFF200000
+#endif
+#ifndef ALT_LWFPGA_HEXA_BASE
+#define ALT_LWFPGA_HEXA_BASE 0xFF200020
+#endif
+#ifndef ALT_LWFPGA_HEXB_BASE
+#define ALT_LWFPGA_HEXB_BASE 0xFF200030
+#endif
+#ifndef ALT_LWFPGA_SWITCH_BASE
+#define ALT_LWFPGA_SWITCH_BASE 0xFF200040
+#endif
+#ifndef ALT_LWFPGA_KEY_BASE
+#define ALT_LWFPGA_KEY_BASE 0xFF200050
+#endif
+#ifndef ALT_LWFPGA_GPIO_0A_BASE
+#define ALT_LWFPGA_GPIO_0A_BASE 0xFF200060
+#endif
+#ifndef ALT_LWFPGA_COUNTER_BASE
+#define ALT_LWFPGA_COUNTER_BASE 0xFF200100
+#endif
+
+#endif
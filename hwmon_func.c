@@ -0,0 +1,415 @@
+/*
+*  hwmon_func.c
+*  hwmon fan functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO DRIVE PC FANS THROUGH LINUX HWMON */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "hwmon_func.h"
+
+#ifdef FAN_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+// Including other necessary custom headers
+#include "time_func.h"
+#include "alloc_func.h"
+#include "globals.h"
+
+#ifdef FAN_LINUX
+
+/*
+* Open sysfs files of one fan. The files are opened once and read or
+* written at offset 0 from then on.
+*/
+
+struct HwmonChannel
+{
+    int Number;         // N in pwmN, pwmN_enable and fanN_input
+    int Pwm;            // pwmN, the duty cycle (0-255)
+    int Enable;         // pwmN_enable, the control mode
+    int Input;          // fanN_input, the speed in RPM
+    int PrevEnable;     // Control mode before the fan was taken over
+    int Rpm;            // Speed read at the last sweep, or -1 if it could not be read
+    int Duty;           // Duty cycle written last (0-255), or -1
+    int Quiet;          // Sweeps in a row at a standstill while driven or stalled
+};
+
+static struct HwmonChannel Channels[HwmonMaxChannels];
+static int ChannelCount;                // Fans driven together
+static int MaxRpm;                      // Speed of the fans at full duty
+static int PrevOnTime = -1;             // On-time last driven, or -1
+static int Allocating;                  // Set if the airflow is shared by the allocator
+static int Reallocated;                 // Set when the state of a fan in the allocation has changed
+static struct TimeWindow ReadWindow;    // Time between sweeps of the speeds
+
+/*
+* Function: OpenField
+* --------------------------------
+* Opens one sysfs file of a fan.
+*
+* Dir: The hwmon directory, e.g. /sys/class/hwmon/hwmon2.
+* Format: The file name with %d standing for the channel number.
+* Number: The channel number.
+* Flags: O_RDONLY or O_RDWR.
+*
+* Returns: The file descriptor, or -1 if the file could not be opened.
+*/
+
+static int OpenField(const char *Dir, const char *Format, int Number, int Flags)
+{
+
+    char Name[32];
+    char Path[256];
+    int Descriptor;
+
+    snprintf(Name, sizeof(Name), Format, Number);
+    snprintf(Path, sizeof(Path), "%s/%s", Dir, Name);
+    Descriptor = open(Path, Flags);
+    if (Descriptor < 0)
+    {
+        perror(Path);
+    }
+
+    return Descriptor;
+}
+
+/*
+* Function: ReadField
+* --------------------------------
+* Reads a non-negative decimal value from the start of an open sysfs
+* file without allocating or re-opening anything.
+*
+* Descriptor: The file descriptor.
+*
+* Returns: The value, or -1 if it could not be read.
+*/
+
+static int ReadField(int Descriptor)
+{
+
+    char Text[HwmonFieldLength];
+    ssize_t Length = pread(Descriptor, Text, sizeof(Text), 0);
+    int Value = 0;
+    ssize_t i;
+
+    if (Length <= 0 || Text[0] < '0' || Text[0] > '9')
+    {
+        return -1;
+    }
+
+    for (i = 0; i < Length && Text[i] >= '0' && Text[i] <= '9'; i++)
+    {
+        Value = Value*10 + (Text[i] - '0');
+    }
+
+    return Value;
+}
+
+/*
+* Function: WriteField
+* --------------------------------
+* Writes a non-negative decimal value followed by a newline to the start
+* of an open sysfs file.
+*
+* Descriptor: The file descriptor.
+* Value: The value to write.
+*
+* Returns: 1 if the value was written or 0 if not.
+*/
+
+static int WriteField(int Descriptor, int Value)
+{
+
+    char Text[HwmonFieldLength];
+    int Start = HwmonFieldLength - 1; // Digits are filled in from the end
+
+    Text[Start] = '\n';
+    do
+    {
+        Text[--Start] = (char)('0' + Value % 10);
+        Value /= 10;
+    } while (Value > 0 && Start > 0);
+
+    return pwrite(Descriptor, &Text[Start], HwmonFieldLength - Start, 0) == HwmonFieldLength - Start;
+}
+
+/*
+* Function: SetDuty
+* --------------------------------
+* Writes the duty cycle of one fan if it has changed.
+*
+* *Channel: Pointer to the fan.
+* OnTime: The duty cycle as a percentage (0-100).
+*/
+
+static void SetDuty(struct HwmonChannel *Channel, int OnTime)
+{
+
+    int Pwm = (OnTime*255 + 50)/100; // Duty cycle on the hwmon scale
+
+    Pwm = (Pwm > 255) ? 255 : Pwm;
+    Pwm = (Pwm < 0) ? 0 : Pwm;
+    if (Pwm != Channel->Duty && WriteField(Channel->Pwm, Pwm))
+    {
+        Channel->Duty = Pwm;
+    }
+
+}
+
+/*
+* Function: HwmonStart
+* --------------------------------
+* Opens pwmN, pwmN_enable and fanN_input of every listed fan and puts
+* the fans under manual control. Any directory laid out like an hwmon
+* device works, so a tree of plain files can stand in for the fans.
+* Given the models of the fans, the on-time becomes a demand for
+* airflow that is shared between them (see AllocLoad); otherwise every
+* fan is driven at the on-time.
+*
+* Dir: The hwmon directory, e.g. /sys/class/hwmon/hwmon2.
+* List: Comma-separated channel numbers, e.g. "1,2".
+* Rpm: Speed of the fans at full duty, which is mapped to MaxRPS.
+* Curves: File holding a model of each fan, or NULL.
+*
+* Returns: 1 if every fan was taken over or 0 if not.
+*/
+
+int HwmonStart(const char *Dir, const char *List, int Rpm, const char *Curves)
+{
+
+    struct HwmonChannel *Channel;
+    char *End;
+
+    MaxRpm = (Rpm > 0) ? Rpm : MaxRPS*60;
+
+    while (*List != '\0' && ChannelCount < HwmonMaxChannels)
+    {
+        Channel = &Channels[ChannelCount];
+        Channel->Number = (int)strtol(List, &End, 10);
+        if (End == List)
+        {
+            fprintf(stderr, "bad hwmon channel list\n");
+            return 0;
+        }
+        List = (*End == ',') ? End + 1 : End;
+
+        Channel->Pwm = OpenField(Dir, "pwm%d", Channel->Number, O_RDWR);
+        Channel->Enable = OpenField(Dir, "pwm%d_enable", Channel->Number, O_RDWR);
+        Channel->Input = OpenField(Dir, "fan%d_input", Channel->Number, O_RDONLY);
+        Channel->PrevEnable = (Channel->Enable >= 0) ? ReadField(Channel->Enable) : -1;
+        Channel->Rpm = -1;
+        Channel->Duty = -1;
+        Channel->Quiet = 0;
+        ChannelCount++;
+
+        if (Channel->Pwm < 0 || Channel->Enable < 0 || Channel->Input < 0 ||
+            !WriteField(Channel->Enable, HwmonManual))
+        {
+            return 0;
+        }
+    }
+
+    if (Curves != NULL && !AllocLoad(Curves, ChannelCount))
+    {
+        fprintf(stderr, "%s: need a model for each of %d fans\n", Curves, ChannelCount);
+        return 0;
+    }
+    Allocating = (Curves != NULL);
+
+    // Starting with the fans stopped, as on the board
+    HwmonDrive(0);
+
+    return ChannelCount > 0;
+}
+
+/*
+* Function: HwmonPoll
+* --------------------------------
+* Reads the speeds of all the fans in one sweep every HwmonReadTicks.
+* The kernel refreshes fanN_input far less often than the control loop
+* runs, so reading every pass would only cost system calls. While the
+* airflow is being shared, a fan that stays at a standstill for
+* HwmonStallReads sweeps while driven is taken out of the allocation
+* until it turns again. It is then driven at full duty for
+* HwmonRestartReads sweeps to start it again and left stopped for the
+* rest of every HwmonRetryReads sweeps, so a fan whose tachometer is
+* dead or unplugged is not held at full duty.
+*/
+
+void HwmonPoll(void)
+{
+
+    int State; // State of the fan in the allocation
+    int i;
+
+    if (!TimeWindowUpdate(&ReadWindow, HwmonReadTicks))
+    {
+        return;
+    }
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        Channels[i].Rpm = ReadField(Channels[i].Input);
+    }
+
+    for (i = 0; i < ChannelCount && Allocating; i++)
+    {
+        if (Channels[i].Rpm == 0 && (Channels[i].Duty > 0 || Channels[i].Quiet >= HwmonStallReads))
+        {
+            Channels[i].Quiet++;
+        }
+        else if (Channels[i].Rpm > 0)
+        {
+            Channels[i].Quiet = 0;
+        }
+        // Starting the restarts of a stalled fan over every HwmonRetryReads
+        if (Channels[i].Quiet >= HwmonStallReads + HwmonRetryReads)
+        {
+            Channels[i].Quiet = HwmonStallReads;
+        }
+
+        State = AllocTurning;
+        if (Channels[i].Quiet >= HwmonStallReads)
+        {
+            State = (Channels[i].Quiet < HwmonStallReads + HwmonRestartReads) ? AllocRestarting : AllocStopped;
+        }
+        if (AllocStall(i, State))
+        {
+            Reallocated = 1;
+        }
+    }
+
+}
+
+/*
+* Function: HwmonSpeed
+* --------------------------------
+* Gives the mean speed of the fans read at the last sweep, scaled so
+* that the speed at full duty reads as MaxRPS. Fans whose speed could
+* not be read are left out. While the airflow is being shared, the
+* airflow of the fans is given instead, scaled so that the airflow of
+* every fan at full speed reads as MaxRPS.
+*
+* Returns: The speed in RPS on the controller's scale.
+*/
+
+float HwmonSpeed(void)
+{
+
+    long Total = 0; // Sum of the speeds read
+    int Read = 0; // Number of speeds read
+    float Airflow = 0; // Airflow of the fans
+    int i;
+
+    if (Allocating)
+    {
+        for (i = 0; i < ChannelCount; i++)
+        {
+            Airflow += (Channels[i].Rpm > 0) ? AllocAirflow(i, Channels[i].Rpm) : 0;
+        }
+        return Airflow*MaxRPS/AllocMaxAirflow();
+    }
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        if (Channels[i].Rpm >= 0)
+        {
+            Total += Channels[i].Rpm;
+            Read++;
+        }
+    }
+
+    if (Read == 0)
+    {
+        return 0;
+    }
+
+    return (float)Total*MaxRPS/((float)Read*MaxRpm);
+}
+
+/*
+* Function: HwmonDrive
+* --------------------------------
+* Sets the duty cycle of all the fans to an on-time, or, while the
+* airflow is being shared, demands that percentage of the airflow of
+* every fan at full speed and drives each fan at its share. Nothing is
+* solved or written unless the on-time or the allocation has changed,
+* so a steady on-time costs nothing.
+*
+* OnTime: The on-time as a percentage (0-100).
+*/
+
+void HwmonDrive(int OnTime)
+{
+
+    int i;
+
+    if (OnTime == PrevOnTime && !Reallocated)
+    {
+        return;
+    }
+    PrevOnTime = OnTime;
+    Reallocated = 0;
+
+    if (Allocating)
+    {
+        AllocDemand(OnTime*AllocMaxAirflow()/100);
+    }
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        SetDuty(&Channels[i], Allocating ? AllocDuty(i) : OnTime);
+    }
+
+}
+
+/*
+* Function: HwmonEnd
+* --------------------------------
+* Hands the fans back to the control mode they were in before (usually
+* automatic control by the chip), rather than leaving them stopped, and
+* closes the files.
+*/
+
+void HwmonEnd(void)
+{
+
+    int i;
+
+    for (i = 0; i < ChannelCount; i++)
+    {
+        if (Channels[i].Enable >= 0 && Channels[i].PrevEnable >= 0)
+        {
+            WriteField(Channels[i].Enable, Channels[i].PrevEnable);
+        }
+        if (Channels[i].Pwm >= 0)
+        {
+            close(Channels[i].Pwm);
+        }
+        if (Channels[i].Enable >= 0)
+        {
+            close(Channels[i].Enable);
+        }
+        if (Channels[i].Input >= 0)
+        {
+            close(Channels[i].Input);
+        }
+    }
+    ChannelCount = 0;
+    PrevOnTime = -1;
+
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*
+*  hwmon_func.h
+*  hwmon fan functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO DRIVE PC FANS THROUGH LINUX HWMON */
+/* ------------------------------------------------------------------ */
+
+#ifndef HWMON_FUNC_H
+#define HWMON_FUNC_H
+
+// hwmon constants
+#define HwmonMaxChannels 8          // Largest number of fans driven together
+#define HwmonReadTicks 5000000      // Time between reads of the fan speeds (100 ms)
+#define HwmonFieldLength 16         // Longest value read from or written to a sysfs file
+#define HwmonManual 1               // Value of pwmN_enable for manual control
+#define HwmonStallReads 20          // Reads at a standstill while driven before a fan counts as stalled (2 s)
+#define HwmonRestartReads 20        // Reads a stalled fan is driven at full duty to start it again (2 s)
+#define HwmonRetryReads 300         // Reads between the starts of two restarts of a stalled fan (30 s)
+
+// FUNCTION DECLARATIONS //
+
+int HwmonStart(const char *, const char *, int, const char *);    // Opens the sysfs files of the
+                                                                  // fans and takes manual control.
+
+
+void HwmonPoll(void);    // Reads the speeds of all the fans once every
+                         // HwmonReadTicks.
+
+
+float HwmonSpeed(void);    // Gives the mean speed or the airflow of
+                           // the fans on the controller's scale.
+
+
+void HwmonDrive(int);    // Sets the duty cycle of the fans when the
+                         // on-time changes.
+
+
+void HwmonEnd(void);    // Hands the fans back to their previous control
+                        // mode and closes the files.
+
+#endif
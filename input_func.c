@@ -0,0 +1,208 @@
+/*
+*  input_func.c
+*  input filter functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------- */
+/* SOURCE FILE FOR FUNCTIONS USED TO FILTER THE GPIO-0 INPUTS  */
+/* ----------------------------------------------------------- */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "input_func.h"
+
+// Including other necessary custom headers
+#include "globals.h"
+
+// Number of bit slices used to hold the per-pin count of high samples;
+// four slices can count up to FilterMaxWindow
+#define FilterSlices 4
+
+// Filter configuration shared by InputFilterConfig and InputFilter
+static int Window = 3;      // Number of samples in the majority window (M)
+static int Threshold = 2;   // Number of agreeing samples needed to change a pin (N)
+static int HoldOff = 0;     // Number of samples a pin is frozen after it changes
+
+// Filter state; every word holds one bit per GPIO pin
+static unsigned int History[FilterMaxWindow];   // Last M raw samples (ring buffer)
+static int HistoryIndex;                        // Position of the oldest sample in History
+static unsigned int Count[FilterSlices];        // Bit-sliced count of high samples per pin
+static unsigned int Changes[FilterMaxHoldOff];  // Pins that changed in each of the last samples
+static int ChangeIndex;                         // Position of the oldest entry in Changes
+static unsigned int Filtered;                   // Current filtered state of every pin
+
+/*
+* Function: CountAtLeast
+* --------------------------------
+* Compares the bit-sliced count of every pin against a constant
+* using word-wide bit operations.
+*
+* Value: The constant to compare against (0-15).
+*
+* Returns: A word with a bit set for every pin whose count is
+* greater than or equal to Value.
+*/
+
+static unsigned int CountAtLeast(int Value)
+{
+
+    unsigned int Greater = 0;   // Pins whose count is already known to be greater
+    unsigned int Equal = ~0u;   // Pins whose count matches Value so far
+    int i;
+
+    // Comparing the slices from the most significant bit downwards
+    for (i = FilterSlices - 1; i >= 0; i--)
+    {
+        if ((Value >> i) & 0x01)
+        {
+            Equal &= Count[i];
+        }
+        else
+        {
+            Greater |= Equal & Count[i];
+            Equal &= ~Count[i];
+        }
+    }
+
+    return Greater | Equal;
+}
+
+/*
+* Function: InputFilterConfig
+* --------------------------------
+* Sets the rules used by InputFilter and clears the sample history.
+* A pin goes high once at least N of the last M samples are high and
+* goes low once at least N of the last M samples are low; otherwise
+* it keeps its state. After a pin changes it is held for HoldOff
+* samples regardless of its input.
+*
+* N: Number of agreeing samples needed to change a pin.
+* M: Number of samples in the majority window (1-15).
+* HoldLength: Number of samples a pin is held after a change (0-8).
+*/
+
+void InputFilterConfig(int N, int M, int HoldLength)
+{
+
+    int i;
+
+    // Restricting the window length and hold-off to the supported range
+    M = (M > FilterMaxWindow) ? FilterMaxWindow : M;
+    M = (M < 1) ? 1 : M;
+    HoldLength = (HoldLength > FilterMaxHoldOff) ? FilterMaxHoldOff : HoldLength;
+    HoldLength = (HoldLength < 0) ? 0 : HoldLength;
+
+    // Restricting the threshold to a strict majority so that the
+    // high and low rules can never both be met
+    N = (N > M) ? M : N;
+    N = (N <= M/2) ? M/2 + 1 : N;
+
+    Window = M;
+    Threshold = N;
+    HoldOff = HoldLength;
+
+    // Clearing the history so the count matches the new window
+    for (i = 0; i < FilterMaxWindow; i++)
+    {
+        History[i] = 0;
+    }
+    for (i = 0; i < FilterSlices; i++)
+    {
+        Count[i] = 0;
+    }
+    for (i = 0; i < FilterMaxHoldOff; i++)
+    {
+        Changes[i] = 0;
+    }
+    HistoryIndex = 0;
+    ChangeIndex = 0;
+
+    // Pins that are currently high count as high for the whole window
+    for (i = 0; i < Window; i++)
+    {
+        History[i] = Filtered;
+    }
+    for (i = 0; i < FilterSlices; i++)
+    {
+        Count[i] = ((Window >> i) & 0x01) ? Filtered : 0;
+    }
+
+}
+
+/*
+* Function: InputFilter
+* --------------------------------
+* Shifts a new sample of the GPIO port into the per-pin shift registers
+* and applies the N-of-M majority and hold-off rules set by
+* InputFilterConfig. All 32 pins are filtered at once: the number of
+* high samples in the window is kept as a bit-sliced counter that is
+* updated with the sample entering and the sample leaving the window.
+* With the default 2-of-3 rule a clean edge is passed on after two
+* samples and a single-sample glitch is rejected.
+*
+* Sample: The raw value read from * GpioPort.
+*
+* Returns: Filtered, the filtered state of every pin on the port.
+*/
+
+unsigned int InputFilter(unsigned int Sample)
+{
+
+    unsigned int Carry; // Pins carrying into the next slice of the count
+    unsigned int Borrow; // Pins borrowing from the next slice of the count
+    unsigned int Slice; // Intermediary copy of a slice
+    unsigned int High; // Pins with at least N high samples
+    unsigned int Low; // Pins with at least N low samples
+    unsigned int Locked = 0; // Pins still inside their hold-off period
+    unsigned int Next; // New filtered state of every pin
+    int i;
+
+    // Removing the oldest sample from the count
+    Borrow = History[HistoryIndex];
+    for (i = 0; i < FilterSlices; i++)
+    {
+        Slice = Count[i];
+        Count[i] = Slice ^ Borrow;
+        Borrow &= ~Slice;
+    }
+
+    // Adding the new sample to the count
+    Carry = Sample;
+    for (i = 0; i < FilterSlices; i++)
+    {
+        Slice = Count[i];
+        Count[i] = Slice ^ Carry;
+        Carry &= Slice;
+    }
+
+    // Replacing the oldest sample in the history with the new one
+    History[HistoryIndex] = Sample;
+    HistoryIndex = (HistoryIndex + 1 >= Window) ? 0 : HistoryIndex + 1;
+
+    // Applying the majority rule; pins that meet neither rule keep their state
+    High = CountAtLeast(Threshold);
+    Low = ~CountAtLeast(Window - Threshold + 1);
+    Next = High | (Filtered & ~Low);
+
+    // Holding pins that changed within the hold-off period
+    if (HoldOff > 0)
+    {
+        for (i = 0; i < HoldOff; i++)
+        {
+            Locked |= Changes[i];
+        }
+        Next = (Next & ~Locked) | (Filtered & Locked);
+
+        Changes[ChangeIndex] = Next ^ Filtered;
+        ChangeIndex = (ChangeIndex + 1 >= HoldOff) ? 0 : ChangeIndex + 1;
+    }
+
+    Filtered = Next;
+
+    return Filtered;
+}
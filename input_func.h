@@ -0,0 +1,29 @@
+/*
+*  input_func.h
+*  input filter functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------- */
+/* HEADER FILE FOR FUNCTIONS USED TO FILTER THE GPIO-0 INPUTS  */
+/* ----------------------------------------------------------- */
+
+#ifndef INPUT_FUNC_H
+#define INPUT_FUNC_H
+
+// Limits of the filter configuration
+#define FilterMaxWindow 15      // Largest number of samples (M) in the majority window
+#define FilterMaxHoldOff 8      // Largest number of samples a pin is held after a change
+
+// FUNCTION DECLARATIONS //
+
+void InputFilterConfig(int, int, int);    // Sets the N-of-M majority rule and the
+                                          // hold-off length used by InputFilter.
+
+
+unsigned int InputFilter(unsigned int);    // Shifts a new sample of * GpioPort into the
+                                           // per-pin shift registers and returns the
+                                           // filtered state of every pin.
+
+#endif
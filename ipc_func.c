@@ -0,0 +1,668 @@
+/*
+*  ipc_func.c
+*  local control interface functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO TAKE SETPOINTS FROM OTHER PROGRAMS */
+/* ------------------------------------------------------------------ */
+
+// Needed on Linux for accept4
+#ifdef FAN_LINUX
+#define _GNU_SOURCE
+#endif
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ipc_func.h"
+
+#ifdef FAN_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif
+
+// Including other necessary custom headers
+#include "bode_func.h"
+#include "stats_func.h"
+#include "lat_func.h"
+#include "autof_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+#ifdef FAN_LINUX
+
+/*
+* A client connected to the command socket and the part of its
+* current command line received so far.
+*/
+
+struct IpcClient
+{
+    int Descriptor;                 // Connected socket, or -1 if unused
+    int Length;                     // Bytes held in Line
+    char Line[IpcLineLength];       // Command line being received
+};
+
+static int Listener = -1;                           // Listening socket
+static const char *SocketPath;                      // Path of the listening socket
+static struct IpcClient Clients[IpcMaxClients];     // Connected clients
+static struct IpcMailbox *Mailbox = MAP_FAILED;     // Mapped mailbox
+static unsigned int MailboxSequence;                // Request sequence last applied
+static unsigned long long LastCheck;                // Time of the last socket check
+
+/*
+* Function: OpenSocket
+* --------------------------------
+* Creates the listening command socket. Any socket left behind at the
+* same path by an earlier run is removed first.
+*
+* Path: Path of the Unix domain socket.
+*
+* Returns: 1 if the socket is listening or 0 if not.
+*/
+
+static int OpenSocket(const char *Path)
+{
+
+    struct sockaddr_un Address;
+
+    if (strlen(Path) >= sizeof(Address.sun_path))
+    {
+        errno = ENAMETOOLONG;
+        return 0;
+    }
+
+    Listener = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (Listener < 0)
+    {
+        return 0;
+    }
+
+    memset(&Address, 0, sizeof(Address));
+    Address.sun_family = AF_UNIX;
+    strcpy(Address.sun_path, Path);
+    unlink(Path);
+
+    if (bind(Listener, (struct sockaddr *)&Address, sizeof(Address)) != 0 ||
+        listen(Listener, IpcMaxClients) != 0)
+    {
+        close(Listener);
+        Listener = -1;
+        return 0;
+    }
+
+    SocketPath = Path;
+
+    return 1;
+}
+
+/*
+* Function: OpenMailbox
+* --------------------------------
+* Creates and maps the shared-memory mailbox, with every request field
+* left unchanged. Only the user running the controller can open it.
+*
+* Path: Path of the mailbox file (e.g. /dev/shm/fan_mailbox).
+*
+* Returns: 1 if the mailbox is mapped or 0 if not.
+*/
+
+static int OpenMailbox(const char *Path)
+{
+
+    struct IpcRequest Request = {IpcUnchanged, IpcUnchanged, IpcUnchanged, IpcUnchanged};
+    int Descriptor;
+
+    // Only the owner may set the fan, even through a file left behind
+    // by an earlier run with a wider mode
+    Descriptor = open(Path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0600);
+    if (Descriptor < 0)
+    {
+        return 0;
+    }
+    if (fchmod(Descriptor, 0600) != 0)
+    {
+        close(Descriptor);
+        return 0;
+    }
+    if (ftruncate(Descriptor, sizeof(struct IpcMailbox)) != 0)
+    {
+        close(Descriptor);
+        return 0;
+    }
+
+    Mailbox = mmap(NULL, sizeof(struct IpcMailbox), PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, 0);
+    close(Descriptor);
+    if (Mailbox == MAP_FAILED)
+    {
+        return 0;
+    }
+
+    SharedWrite(&Mailbox->Request, &Request, sizeof(Request));
+    MailboxSequence = Mailbox->Request.Sequence;
+    Mailbox->Version = IpcMailboxVersion;
+    // Written last so that clients only use a mailbox that is ready
+    __atomic_store_n(&Mailbox->Magic, IpcMailboxMagic, __ATOMIC_RELEASE);
+
+    return 1;
+}
+
+/*
+* Function: Reply
+* --------------------------------
+* Sends a reply line to a client without waiting. A client that
+* cannot take the reply is disconnected.
+*
+* *Client: Pointer to the client.
+* Text: The reply, ending in a newline.
+*/
+
+static void Reply(struct IpcClient *Client, const char *Text)
+{
+
+    int Length = strlen(Text);
+
+    if (send(Client->Descriptor, Text, Length, MSG_DONTWAIT | MSG_NOSIGNAL) != Length)
+    {
+        close(Client->Descriptor);
+        Client->Descriptor = -1;
+    }
+
+}
+
+/*
+* Function: Append
+* --------------------------------
+* Adds formatted text to a reply being built in a buffer of
+* IpcReplyLength bytes. Text that does not fit is cut off, always
+* leaving room for the newline that ends the reply.
+*
+* Text: The reply so far.
+* Length: The length of the reply so far.
+* Format: The format of the text to add, as for printf.
+*
+* Returns: The new length of the reply, at most IpcReplyLength - 2.
+*/
+
+static int Append(char *Text, int Length, const char *Format, ...)
+{
+
+    va_list Arguments;
+    int Room = IpcReplyLength - 1 - Length; // Bytes left, keeping one for the newline
+    int Added;
+
+    if (Room <= 1)
+    {
+        return Length;
+    }
+
+    va_start(Arguments, Format);
+    Added = vsnprintf(Text + Length, Room, Format, Arguments);
+    va_end(Arguments);
+
+    if (Added < 0)
+    {
+        return Length;
+    }
+
+    return (Added < Room) ? Length + Added : Length + Room - 1;
+}
+
+/*
+* Function: End
+* --------------------------------
+* Ends a reply built with Append with its newline, in the room Append
+* always leaves for it.
+*
+* Text: The reply so far.
+* Length: The length of the reply so far.
+*/
+
+static void End(char *Text, int Length)
+{
+
+    Text[Length] = '\n';
+    Text[Length + 1] = '\0';
+
+}
+
+/*
+* Function: Command
+* --------------------------------
+* Carries out one command line:
+*
+*   mode N      select mode N (0-6)
+*   speed N     set the desired speed to N (0-50)
+*   duty N      set the duty cycle to N (0-100)
+*   freq N      set the PWM frequency to N Hz (1-10000)
+*   get         report the mode, duty cycle, desired speed, speed,
+*               frequency and temperature
+*   bode        report the frequency response measured in mode 5:
+*               frequency (mHz), gain (1/1000 RPS per percent) and
+*               phase (1/100 degree) for every frequency measured
+*   stats N     report the statistics of signal N (0 speed, 1 on-time,
+*               2 tracking error): minimum, maximum, mean (1/100) and
+*               variance (1/100) over 1 s, 10 s and 60 s, or - for a
+*               window without samples
+*   latency N   report the latency of each stage after an encoder
+*               step (N = 0) or a mode selection (N = 1): count,
+*               timeouts, median, 99th percentile and maximum (us)
+*   autof       report the last evaluation of each frequency tried
+*               by automatic frequency selection, lowest first:
+*               frequency (Hz), RMS tracking error (1/100, -1 if not
+*               judged), speed deviation (1/100 RPS), dropouts (%),
+*               deadline misses per second (1/100) and 1 if it passed,
+*               or - for a frequency not yet evaluated
+*
+* Each command is answered with one line.
+*
+* *Ui: Pointer to the state of the user interface.
+* *Client: Pointer to the client that sent the command.
+* Line: The command line without its newline.
+*/
+
+static void Command(struct UiState *Ui, struct IpcClient *Client, const char *Line)
+{
+
+    char Name[16]; // Command name
+    char Text[IpcReplyLength]; // Reply
+    int Value; // Command argument
+    struct BodePoint Point; // One point of the frequency response
+    struct StatsSummary Summary; // Statistics of one signal over one window
+    struct LatSummary Latency; // Latencies of one stage
+    struct AutofResult Result; // Evaluation of one frequency
+    int Length; // Length of the reply so far
+    int i;
+    int Fields = sscanf(Line, "%15s %d", Name, &Value);
+
+    if (Fields == 1 && strcmp(Name, "get") == 0)
+    {
+        snprintf(Text, sizeof(Text), "mode %d duty %d speed %d rps %d freq %d temp %d\n",
+                 Ui->Setpoints.Mode, Ui->Shown.DutyCycle, Ui->Shown.DesiredSpeed, Ui->Shown.RPS,
+                 Ui->Setpoints.PWMFrequency, Ui->Shown.Temperature);
+        Reply(Client, Text);
+    }
+    else if (Fields == 1 && strcmp(Name, "bode") == 0)
+    {
+        Length = Append(Text, 0, "bode");
+        for (i = 0; i < BodeMaxPoints; i++)
+        {
+            if (BodeResult(i, &Point))
+            {
+                Length = Append(Text, Length, " %d %d %d", Point.Frequency, Point.Gain, Point.Phase);
+            }
+        }
+        End(Text, Length);
+        Reply(Client, Text);
+    }
+    else if (Fields == 1 && strcmp(Name, "autof") == 0)
+    {
+        Length = Append(Text, 0, "autof");
+        for (i = 0; AutofResultGet(i, &Result); i++)
+        {
+            if (Result.Samples != 0)
+            {
+                Length = Append(Text, Length, " %d %d %d %d %d %d", Result.Frequency,
+                                Result.Error, Result.Jitter, Result.Dropouts, Result.Misses, Result.Pass);
+            }
+            else
+            {
+                Length = Append(Text, Length, " %d - - - - -", Result.Frequency);
+            }
+        }
+        End(Text, Length);
+        Reply(Client, Text);
+    }
+    else if (Fields == 2 && strcmp(Name, "stats") == 0 && Value >= 0 && Value < StatsSignals)
+    {
+        Length = Append(Text, 0, "stats %d", Value);
+        for (i = 0; i < StatsWindows; i++)
+        {
+            if (StatsRead(Value, i, &Summary))
+            {
+                Length = Append(Text, Length, " %d %d %d %d",
+                                Summary.Min, Summary.Max, Summary.Mean, Summary.Variance);
+            }
+            else
+            {
+                Length = Append(Text, Length, " - - - -");
+            }
+        }
+        End(Text, Length);
+        Reply(Client, Text);
+    }
+    else if (Fields == 2 && strcmp(Name, "latency") == 0 && Value >= 0 && Value < LatSources)
+    {
+        Length = Append(Text, 0, "latency %d", Value);
+        for (i = 0; i < LatStages; i++)
+        {
+            LatSummaryGet(Value, i, &Latency);
+            Length = Append(Text, Length, " %u %u %u %u %u", Latency.Count,
+                            Latency.Timeouts, Latency.Median, Latency.Percentile99, Latency.Max);
+        }
+        End(Text, Length);
+        Reply(Client, Text);
+    }
+    else if (Fields == 2 && strcmp(Name, "mode") == 0 && Value >= 0 && Value <= 6)
+    {
+        UiSetMode(Ui, Value);
+        Reply(Client, "ok\n");
+    }
+    else if (Fields == 2 && strcmp(Name, "speed") == 0 && Value >= 0 && Value <= 50)
+    {
+        UiSetDutyCycle(Ui, Value*2);
+        Reply(Client, "ok\n");
+    }
+    else if (Fields == 2 && strcmp(Name, "duty") == 0 && Value >= 0 && Value <= 100)
+    {
+        UiSetDutyCycle(Ui, Value);
+        Reply(Client, "ok\n");
+    }
+    else if (Fields == 2 && strcmp(Name, "freq") == 0 && Value >= 1 && Value <= 10000)
+    {
+        UiSetFrequency(Ui, Value);
+        Reply(Client, "ok\n");
+    }
+    else if (Fields >= 1)
+    {
+        Reply(Client, "error\n");
+    }
+
+}
+
+/*
+* Function: ReadClient
+* --------------------------------
+* Reads whatever a client has sent and carries out every complete
+* command line. A line longer than IpcLineLength is discarded.
+*
+* *Ui: Pointer to the state of the user interface.
+* *Client: Pointer to the client.
+*/
+
+static void ReadClient(struct UiState *Ui, struct IpcClient *Client)
+{
+
+    char Buffer[256];
+    int Received;
+    int i;
+
+    Received = recv(Client->Descriptor, Buffer, sizeof(Buffer), MSG_DONTWAIT);
+    if (Received == 0 || (Received < 0 && errno != EAGAIN && errno != EWOULDBLOCK))
+    {
+        close(Client->Descriptor);
+        Client->Descriptor = -1;
+        return;
+    }
+
+    for (i = 0; i < Received && Client->Descriptor >= 0; i++)
+    {
+        if (Buffer[i] == '\n')
+        {
+            if (Client->Length < IpcLineLength)
+            {
+                Client->Line[Client->Length] = '\0';
+                Command(Ui, Client, Client->Line);
+            }
+            else
+            {
+                Reply(Client, "error\n");
+            }
+            Client->Length = 0;
+        }
+        else if (Buffer[i] != '\r' && Client->Length < IpcLineLength - 1)
+        {
+            Client->Line[Client->Length++] = Buffer[i];
+        }
+        else if (Buffer[i] != '\r')
+        {
+            // Marking the line as too long
+            Client->Length = IpcLineLength;
+        }
+    }
+
+}
+
+/*
+* Function: PollSocket
+* --------------------------------
+* Accepts new clients and carries out the commands they have sent,
+* without waiting for either.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+static void PollSocket(struct UiState *Ui)
+{
+
+    struct pollfd Ready[IpcMaxClients + 1];
+    int Descriptor;
+    int i;
+
+    Ready[0].fd = Listener;
+    Ready[0].events = POLLIN;
+    for (i = 0; i < IpcMaxClients; i++)
+    {
+        Ready[i + 1].fd = Clients[i].Descriptor;
+        Ready[i + 1].events = POLLIN;
+    }
+
+    if (poll(Ready, IpcMaxClients + 1, 0) <= 0)
+    {
+        return;
+    }
+
+    for (i = 0; i < IpcMaxClients; i++)
+    {
+        if (Clients[i].Descriptor >= 0 && Ready[i + 1].revents != 0)
+        {
+            ReadClient(Ui, &Clients[i]);
+        }
+    }
+
+    if (Ready[0].revents & POLLIN)
+    {
+        Descriptor = accept4(Listener, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        for (i = 0; Descriptor >= 0 && i < IpcMaxClients; i++)
+        {
+            if (Clients[i].Descriptor < 0)
+            {
+                Clients[i].Descriptor = Descriptor;
+                Clients[i].Length = 0;
+                Descriptor = -1;
+            }
+        }
+        // Turning the client away if every slot is taken
+        if (Descriptor >= 0)
+        {
+            close(Descriptor);
+        }
+    }
+
+}
+
+/*
+* Function: PollMailbox
+* --------------------------------
+* Applies the latest request in the mailbox if it has changed, and
+* publishes the status of the controller.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+static void PollMailbox(struct UiState *Ui)
+{
+
+    struct IpcRequest Request;
+    struct IpcStatus Status;
+    unsigned int Sequence = __atomic_load_n(&Mailbox->Request.Sequence, __ATOMIC_ACQUIRE);
+
+    if (Sequence != MailboxSequence && SharedRead(&Mailbox->Request, &Request, sizeof(Request)))
+    {
+        MailboxSequence = Sequence;
+
+        if (Request.Mode >= 0 && Request.Mode <= 6)
+        {
+            UiSetMode(Ui, Request.Mode);
+        }
+        if (Request.DesiredSpeed >= 0 && Request.DesiredSpeed <= 50)
+        {
+            UiSetDutyCycle(Ui, Request.DesiredSpeed*2);
+        }
+        if (Request.DutyCycle >= 0 && Request.DutyCycle <= 100)
+        {
+            UiSetDutyCycle(Ui, Request.DutyCycle);
+        }
+        if (Request.PWMFrequency >= 1 && Request.PWMFrequency <= 10000)
+        {
+            UiSetFrequency(Ui, Request.PWMFrequency);
+        }
+    }
+
+    Status.Mode = Ui->Setpoints.Mode;
+    Status.DutyCycle = Ui->Shown.DutyCycle;
+    Status.DesiredSpeed = Ui->Shown.DesiredSpeed;
+    Status.RPS = Ui->Shown.RPS;
+    Status.PWMFrequency = Ui->Setpoints.PWMFrequency;
+    Status.Temperature = Ui->Shown.Temperature;
+    SharedWrite(&Mailbox->Status, &Status, sizeof(Status));
+
+}
+
+#endif
+
+/*
+* Function: IpcStart
+* --------------------------------
+* Opens the local control interface on the Linux build (FAN_LINUX):
+*
+*   --socket PATH     accept text commands on a Unix domain socket
+*   --mailbox PATH    stream setpoints through a shared-memory mailbox
+*
+* Both are optional. Other arguments are ignored so that they can be
+* used elsewhere. The bare-metal build has no local control interface.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1 if the requested interfaces were opened or 0 if not.
+*/
+
+int IpcStart(int argc, char **argv)
+{
+
+#ifdef FAN_LINUX
+    int Arg;
+    int i;
+
+    for (i = 0; i < IpcMaxClients; i++)
+    {
+        Clients[i].Descriptor = -1;
+    }
+
+    for (Arg = 1; Arg + 1 < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--socket") == 0 && !OpenSocket(argv[++Arg]))
+        {
+            perror(argv[Arg]);
+            return 0;
+        }
+        else if (strcmp(argv[Arg], "--mailbox") == 0 && !OpenMailbox(argv[++Arg]))
+        {
+            perror(argv[Arg]);
+            return 0;
+        }
+    }
+
+    LastCheck = TimeNow();
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    return 1;
+}
+
+/*
+* Function: IpcPoll
+* --------------------------------
+* Called by the user interface on every pass. Setpoints sent by
+* external clients are applied to the user interface, so that they
+* are published with the others and taken by the control path at its
+* next pass. Nothing here waits: the mailbox is checked on every pass
+* and the socket, which costs a system call, once every IpcPollTicks.
+*
+* *Ui: Pointer to the state of the user interface.
+*/
+
+void IpcPoll(struct UiState *Ui)
+{
+
+#ifdef FAN_LINUX
+    if (Mailbox != MAP_FAILED)
+    {
+        PollMailbox(Ui);
+    }
+
+    if (Listener >= 0 && TimeReached(LastCheck + IpcPollTicks))
+    {
+        LastCheck = TimeNow();
+        PollSocket(Ui);
+    }
+#else
+    (void)Ui;
+#endif
+
+}
+
+/*
+* Function: IpcEnd
+* --------------------------------
+* Disconnects every client and closes the command socket and the
+* mailbox.
+*/
+
+void IpcEnd(void)
+{
+
+#ifdef FAN_LINUX
+    int i;
+
+    for (i = 0; i < IpcMaxClients; i++)
+    {
+        if (Clients[i].Descriptor >= 0)
+        {
+            close(Clients[i].Descriptor);
+            Clients[i].Descriptor = -1;
+        }
+    }
+
+    if (Listener >= 0)
+    {
+        close(Listener);
+        unlink(SocketPath);
+        Listener = -1;
+    }
+
+    if (Mailbox != MAP_FAILED)
+    {
+        munmap(Mailbox, sizeof(struct IpcMailbox));
+        Mailbox = MAP_FAILED;
+    }
+#endif
+
+}
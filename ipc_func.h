@@ -0,0 +1,87 @@
+/*
+*  ipc_func.h
+*  local control interface functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO TAKE SETPOINTS FROM OTHER PROGRAMS */
+/* ------------------------------------------------------------------ */
+
+#ifndef IPC_FUNC_H
+#define IPC_FUNC_H
+
+#include "ctrl_func.h"
+#include "shared_func.h"
+
+// Limits of the command socket
+#define IpcMaxClients 4         // Clients connected at the same time
+#define IpcLineLength 64        // Longest command line in bytes
+#define IpcReplyLength 512      // Longest reply in bytes, with its newline
+
+// Counter ticks between checks of the command socket (1 ms)
+#define IpcPollTicks 50000
+
+// Identification of the shared-memory mailbox
+#define IpcMailboxMagic 0x584F424D      // "MBOX" when read as little-endian bytes
+#define IpcMailboxVersion 1
+
+// Value of a mailbox request field that leaves the setting unchanged
+#define IpcUnchanged (-1)
+
+/*
+* Setpoints streamed into the mailbox by an external client. Fields
+* set to IpcUnchanged are ignored.
+*/
+
+struct IpcRequest
+{
+    int Mode;               // Mode to select (0-6)
+    int DesiredSpeed;       // Desired speed (0-50), sets the duty cycle to twice its value
+    int DutyCycle;          // Duty cycle (0-100), applied after DesiredSpeed
+    int PWMFrequency;       // PWM frequency in Hz
+};
+
+/*
+* State of the controller published into the mailbox for external
+* clients.
+*/
+
+struct IpcStatus
+{
+    int Mode;               // Mode that is selected
+    int DutyCycle;          // Duty cycle of the PWM (0-100)
+    int DesiredSpeed;       // Desired speed of the fan (0-50)
+    int RPS;                // Speed of the fan in RPS
+    int PWMFrequency;       // Operating frequency of the fan
+    int Temperature;        // Measured temperature in millidegrees Celsius
+};
+
+/*
+* Layout of the shared-memory mailbox. Both halves are sequence locks
+* (see SharedWrite): the client writes Request and the controller
+* writes Status.
+*/
+
+struct IpcMailbox
+{
+    unsigned int Magic;         // IpcMailboxMagic
+    unsigned int Version;       // IpcMailboxVersion
+    struct Shared Request;      // Holds a struct IpcRequest
+    struct Shared Status;       // Holds a struct IpcStatus
+};
+
+// FUNCTION DECLARATIONS //
+
+int IpcStart(int, char **);    // Opens the command socket and the mailbox
+                               // given on the command line.
+
+
+void IpcPoll(struct UiState *);    // Applies any setpoints sent by external
+                                   // clients and publishes the status.
+
+
+void IpcEnd(void);    // Closes the command socket and the mailbox.
+
+#endif
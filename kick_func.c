@@ -0,0 +1,193 @@
+/*
+*  kick_func.c
+*  start-assist functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO START THE FAN AND RECOVER STALLS */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "kick_func.h"
+
+// Including other necessary custom headers
+#include "fan_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+static struct KickStats Stats;          // Counters and the learnt minimum
+static int Started;                     // Set after the first call
+static int Kicking;                     // Set while a kick is applied
+static int PrevOnTime;                  // On-time asked for in the previous call
+static unsigned long long PrevTime;     // Time of the previous call
+static unsigned long long StoppedAt;    // Time the on-time last fell to 0
+static unsigned long long KickStart;    // Time the current kick began
+static unsigned long long PoweredTicks; // Powered time since the last tachometer edge
+static unsigned int KickEdgeCount;      // Tachometer edges when the current kick began
+static unsigned int LastEdges;          // Tachometer edges at the previous call
+static unsigned long long FloorTicks;   // Powered time held at the minimum without a stall
+
+/*
+* Function: StartAssist
+* --------------------------------
+* Sits between the controllers and PWMGenerator. A fan that is asked
+* to turn at a low on-time often cannot break away from rest, and the
+* closed-loop controller then winds up until it does and overshoots.
+* When the on-time rises from 0 after the fan has been unpowered for
+* KickRestTicks, or no tachometer edge is seen for KickStallTicks of
+* powered time, the fan is driven at full duty until it has turned
+* KickEdges edges or KickTicks have passed, and then handed back.
+* Each stall at an on-time of up to KickMaxSustain raises the minimum
+* sustain duty, below which a non-zero on-time is never driven; a
+* stall at a higher on-time is a blocked fan or a tachometer fault
+* rather than friction, so it is counted as a fault and the fan is
+* only kicked. Every KickProbeTicks of powered time
+* held at that minimum without a stall lowers it again by
+* KickProbeStep, so it settles just above the lowest duty the fan
+* keeps turning at.
+*
+* The tachometer only counts edges while the fan is powered, so only
+* powered time counts towards a stall.
+*
+* OnTime: The on-time asked for by the controller (0-100).
+* FanOn: Set if the fan was powered during the previous pass.
+*
+* Returns: OnTime, the on-time to drive the fan at (0-100).
+*/
+
+int StartAssist(int OnTime, int FanOn)
+{
+
+    unsigned long long Now = TimeNow();
+    unsigned int Edges = FanStatsGet()->TachEdges;
+
+    // The fan is taken to be at rest when the program starts
+    if (!Started)
+    {
+        StoppedAt = Now - KickRestTicks;
+        Started = 1;
+    }
+
+    if (OnTime <= 0)
+    {
+        if (PrevOnTime > 0)
+        {
+            StoppedAt = Now;
+        }
+        Kicking = 0;
+        PrevOnTime = 0;
+        PrevTime = Now;
+        return 0;
+    }
+
+    // Counting powered time since the last tachometer edge
+    if (Edges != LastEdges)
+    {
+        PoweredTicks = 0;
+        LastEdges = Edges;
+    }
+    else if (FanOn)
+    {
+        PoweredTicks += Now - PrevTime;
+    }
+
+    if (!Kicking)
+    {
+        if (PrevOnTime <= 0 && Now - StoppedAt >= KickRestTicks)
+        {
+            // Starting from rest
+            Kicking = 1;
+        }
+        else if (PrevOnTime > 0 && PoweredTicks >= KickStallTicks && OnTime > KickMaxSustain)
+        {
+            // The fan has stopped at an on-time it should turn at
+            Kicking = 1;
+            Stats.Faults++;
+        }
+        else if (PrevOnTime > 0 && PoweredTicks >= KickStallTicks)
+        {
+            // The fan has stalled, so it is not driven this low again
+            Kicking = 1;
+            Stats.Stalls++;
+            Stats.SustainDuty = ((OnTime > Stats.SustainDuty) ? OnTime : Stats.SustainDuty) + KickLearnStep;
+            Stats.SustainDuty = (Stats.SustainDuty > KickMaxSustain) ? KickMaxSustain : Stats.SustainDuty;
+            FloorTicks = 0;
+        }
+
+        if (Kicking)
+        {
+            Stats.Kicks++;
+            KickStart = Now;
+            KickEdgeCount = Edges;
+        }
+    }
+
+    // Ending the kick once the fan is turning or the kick has run its course
+    if (Kicking && (Edges - KickEdgeCount >= KickEdges || Now - KickStart >= KickTicks))
+    {
+        Kicking = 0;
+        PoweredTicks = 0;
+    }
+
+    // Probing a lower minimum once the fan has been held at the minimum
+    // for KickProbeTicks without stalling, so that a spurious stall is
+    // unlearnt while a real one is soon learnt again
+    if (!Kicking && FanOn && Stats.SustainDuty > 0 && OnTime <= Stats.SustainDuty)
+    {
+        FloorTicks += Now - PrevTime;
+        if (FloorTicks >= KickProbeTicks)
+        {
+            Stats.SustainDuty -= KickProbeStep;
+            FloorTicks = 0;
+        }
+    }
+
+    PrevOnTime = OnTime;
+    PrevTime = Now;
+
+    if (Kicking)
+    {
+        return 100;
+    }
+
+    return (OnTime < Stats.SustainDuty) ? Stats.SustainDuty : OnTime;
+}
+
+/*
+* Function: KickStatsGet
+* --------------------------------
+* Gives access to the counters and the learnt minimum sustain duty,
+* for the metrics page. The counters wrap around.
+*
+* Returns: A pointer to the statistics, updated in place.
+*/
+
+const struct KickStats *KickStatsGet(void)
+{
+
+    return &Stats;
+}
+
+/*
+* Function: KickRestore
+* --------------------------------
+* Starts from a minimum sustain duty learnt before a restart, so that
+* the stalls that taught it are not repeated. Called before the control
+* path starts.
+*
+* SustainDuty: The learnt minimum (0-100), limited to KickMaxSustain.
+*/
+
+void KickRestore(int SustainDuty)
+{
+
+    SustainDuty = (SustainDuty < 0) ? 0 : SustainDuty;
+    Stats.SustainDuty = (SustainDuty > KickMaxSustain) ? KickMaxSustain : SustainDuty;
+
+}
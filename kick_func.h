@@ -0,0 +1,52 @@
+/*
+*  kick_func.h
+*  start-assist functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO START THE FAN AND RECOVER STALLS */
+/* ------------------------------------------------------------------ */
+
+#ifndef KICK_FUNC_H
+#define KICK_FUNC_H
+
+// Start-assist constants, times in counter ticks
+#define KickTicks 15000000          // Longest full-duty kick (300 ms)
+#define KickEdges 4                 // Tachometer edges that end a kick early (two revolutions)
+#define KickRestTicks 100000000     // Time unpowered after which the fan is taken to be at rest (2 s)
+#define KickStallTicks 12500000     // Powered time without a tachometer edge that counts as a stall (250 ms)
+#define KickLearnStep 5             // Rise in the minimum sustain duty after each stall
+#define KickMaxSustain 50           // Highest minimum sustain duty that can be learnt, and highest
+                                    // on-time at which a stall is learnt from rather than a fault
+#define KickProbeTicks 3000000000ULL    // Stall-free time held at the minimum before it is lowered (60 s)
+#define KickProbeStep 1             // Fall in the minimum sustain duty after each stall-free probe
+
+/*
+* Counters and the learnt minimum kept by the start assist.
+*/
+
+struct KickStats
+{
+    unsigned int Kicks;             // Full-duty kicks applied, from rest or after a stall
+    unsigned int Stalls;            // Stalls detected while the fan was powered
+    unsigned int Faults;            // Stalls above KickMaxSustain, not learnt from
+    int SustainDuty;                // Lowest non-zero on-time the fan is driven at (0-100)
+};
+
+// FUNCTION DECLARATIONS //
+
+int StartAssist(int, int);    // Kicks the fan when it is started from rest or
+                              // has stalled and keeps the on-time above the
+                              // learnt minimum.
+
+
+const struct KickStats *KickStatsGet(void);    // Gives access to the counters and
+                                               // learnt minimum of the start assist.
+
+
+void KickRestore(int);    // Starts from a minimum sustain duty learnt
+                          // before a restart.
+
+#endif
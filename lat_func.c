@@ -0,0 +1,289 @@
+/*
+*  lat_func.c
+*  latency tracing functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO TRACE INPUT-TO-OUTPUT LATENCIES  */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "lat_func.h"
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "fan_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+static const char *SourceNames[LatSources] = {"encoder", "key"};
+static const char *StageNames[LatStages] = {"apply", "decide", "actuate", "respond", "display"};
+
+// Histograms, written by the control path except for LatDisplay, which
+// the user interface writes
+static unsigned int Counts[LatSources][LatStages][LatBuckets];  // Latencies in each bucket
+static unsigned int Timeouts[LatSources][LatStages];            // Traces abandoned at each stage
+static unsigned int Longest[LatSources][LatStages];             // Longest latency in microseconds
+
+// Trace in flight, owned by the control path
+static int Active;                      // Set while a trace is in flight
+static int Source;                      // Input the trace started from
+static int Waiting;                     // Stage the trace is waiting for
+static unsigned long long StageTime;    // Time the previous stage was reached
+static int BaseOnTime;                  // On-time before the input
+static int BaseRPS;                     // Measured speed when the new on-time was first driven
+static int PrevOnTime;                  // On-time at the previous pass
+static unsigned int PrevSteps;          // Encoder steps at the previous pass
+static int Started;                     // Set after the first pass
+
+// Display stage waiting for the user interface
+static unsigned long long DisplayStart;     // Time the new on-time was chosen, or 0
+static int DisplaySource;                   // Input of the trace the display stage belongs to
+
+/*
+* Function: Record
+* --------------------------------
+* Adds a latency to the histogram of a stage. Bucket 0 holds latencies
+* under a microsecond and bucket b latencies from 2^(b-1) to 2^b
+* microseconds; the last bucket also holds everything longer.
+*
+* Input: The input the trace started from.
+* Stage: The stage reached.
+* Ticks: The latency in counter ticks.
+*/
+
+static void Record(int Input, int Stage, unsigned long long Ticks)
+{
+
+    unsigned long long Microseconds = TimeToMicroseconds(Ticks);
+    int Bucket = 0;
+
+    while (Bucket < LatBuckets - 1 && (Microseconds >> Bucket) != 0)
+    {
+        Bucket++;
+    }
+
+    __atomic_fetch_add(&Counts[Input][Stage][Bucket], 1, __ATOMIC_RELAXED);
+    if (Microseconds > Longest[Input][Stage])
+    {
+        __atomic_store_n(&Longest[Input][Stage], (unsigned int)Microseconds, __ATOMIC_RELAXED);
+    }
+
+}
+
+/*
+* Function: LatInput
+* --------------------------------
+* Starts a trace from an input. The input is tagged with the low 32
+* bits of the counter when it was seen (for a key, before the mode
+* name is scrolled), and the time until the control path takes it up
+* is the first stage. Mode selections replace a trace in flight;
+* encoder steps are ignored while one is in flight, so a turn of the
+* encoder is traced from its first step.
+*
+* Input: LatEncoder or LatKey.
+* Stamp: Low 32 bits of the counter when the input was seen.
+*/
+
+void LatInput(int Input, unsigned int Stamp)
+{
+
+    unsigned long long Now = TimeNow();
+
+    if (Active && Input == LatEncoder)
+    {
+        return;
+    }
+
+    Active = 1;
+    Source = Input;
+    BaseOnTime = PrevOnTime;
+    Record(Input, LatApply, (unsigned int)((unsigned int)Now - Stamp));
+    StageTime = Now;
+    Waiting = LatDecide;
+
+}
+
+/*
+* Function: LatPass
+* --------------------------------
+* Called at the end of every pass of the control path, after the PWM
+* pin has been driven. Starts a trace when the encoder has stepped and
+* moves the trace in flight on through its stages: the on-time
+* changing from its value before the input, the PWM pin being driven
+* differently than the old on-time would have driven it, and the next
+* change of the measured speed. A trace that waits LatTimeoutTicks for
+* a stage (e.g. a step that leaves the on-time unchanged) is
+* abandoned and counted against that stage.
+*
+* *Control: Pointer to the state of the control path.
+* Cycle: The cycle count the PWM pin was driven at (0 in off-mode).
+*/
+
+void LatPass(const struct ControlState *Control, int Cycle)
+{
+
+    unsigned long long Now = TimeNow();
+    unsigned int Steps = FanStatsGet()->EncoderSteps;
+
+    if (Started && Steps != PrevSteps)
+    {
+        LatInput(LatEncoder, (unsigned int)Now);
+    }
+    PrevSteps = Steps;
+    Started = 1;
+
+    if (Active && Waiting == LatDecide && Control->OnTime != BaseOnTime)
+    {
+        Record(Source, LatDecide, Now - StageTime);
+        StageTime = Now;
+        Waiting = LatActuate;
+
+        // Handing the display stage to the user interface
+        DisplaySource = Source;
+        __atomic_store_n(&DisplayStart, Now, __ATOMIC_RELEASE);
+    }
+
+    if (Active && Waiting == LatActuate && (Cycle < Control->OnTime) != (Cycle < BaseOnTime))
+    {
+        Record(Source, LatActuate, Now - StageTime);
+        StageTime = Now;
+        BaseRPS = Control->RPS;
+        Waiting = LatRespond;
+    }
+    else if (Active && Waiting == LatRespond && Control->RPS != BaseRPS)
+    {
+        Record(Source, LatRespond, Now - StageTime);
+        Active = 0;
+    }
+
+    if (Active && Now - StageTime >= LatTimeoutTicks)
+    {
+        __atomic_fetch_add(&Timeouts[Source][Waiting], 1, __ATOMIC_RELAXED);
+        Active = 0;
+    }
+
+    PrevOnTime = Control->OnTime;
+
+}
+
+/*
+* Function: LatDisplayed
+* --------------------------------
+* Called by the user interface after it has refreshed the displays.
+* Completes the display stage if the measurements shown were taken
+* after the new on-time was chosen.
+*
+* ReadTime: Time at which the displayed measurements were taken from
+* the control path.
+*/
+
+void LatDisplayed(unsigned long long ReadTime)
+{
+
+    unsigned long long Start = __atomic_load_n(&DisplayStart, __ATOMIC_ACQUIRE);
+
+    if (Start == 0 || Start >= ReadTime)
+    {
+        return;
+    }
+
+    if (__atomic_compare_exchange_n(&DisplayStart, &Start, 0, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+    {
+        Record(DisplaySource, LatDisplay, TimeNow() - Start);
+    }
+
+}
+
+/*
+* Function: LatSummaryGet
+* --------------------------------
+* Summarises the histogram of one stage for one kind of input. Can be
+* called from any thread.
+*
+* Input: LatEncoder or LatKey.
+* Stage: The stage (LatApply to LatDisplay).
+* *Summary: Pointer to the structure to fill in.
+*/
+
+void LatSummaryGet(int Input, int Stage, struct LatSummary *Summary)
+{
+
+    unsigned int Bucket[LatBuckets]; // Copy of the histogram
+    unsigned int Seen = 0; // Latencies in the buckets so far
+    int i;
+
+    Summary->Count = 0;
+    for (i = 0; i < LatBuckets; i++)
+    {
+        Bucket[i] = __atomic_load_n(&Counts[Input][Stage][i], __ATOMIC_RELAXED);
+        Summary->Count += Bucket[i];
+    }
+    Summary->Timeouts = __atomic_load_n(&Timeouts[Input][Stage], __ATOMIC_RELAXED);
+    Summary->Max = __atomic_load_n(&Longest[Input][Stage], __ATOMIC_RELAXED);
+    Summary->Median = 0;
+    Summary->Percentile99 = 0;
+
+    for (i = 0; i < LatBuckets && Summary->Count > 0; i++)
+    {
+        Seen += Bucket[i];
+        if (Summary->Median == 0 && Seen*2 >= Summary->Count)
+        {
+            Summary->Median = 1u << i;
+        }
+        if (Seen*100 >= Summary->Count*99)
+        {
+            Summary->Percentile99 = 1u << i;
+            break;
+        }
+    }
+
+}
+
+/*
+* Function: LatDump
+* --------------------------------
+* Prints the summary and the non-empty buckets of every histogram,
+* e.g. at the end of a replayed trace so that runs can be compared.
+*/
+
+void LatDump(void)
+{
+
+    struct LatSummary Summary;
+    unsigned int Count;
+    int Input;
+    int Stage;
+    int i;
+
+    for (Input = 0; Input < LatSources; Input++)
+    {
+        for (Stage = 0; Stage < LatStages; Stage++)
+        {
+            LatSummaryGet(Input, Stage, &Summary);
+            printf("latency %-7s %-7s count %u timeouts %u p50 %u us p99 %u us max %u us\n",
+                   SourceNames[Input], StageNames[Stage], Summary.Count, Summary.Timeouts,
+                   Summary.Median, Summary.Percentile99, Summary.Max);
+            for (i = 0; i < LatBuckets; i++)
+            {
+                Count = __atomic_load_n(&Counts[Input][Stage][i], __ATOMIC_RELAXED);
+                if (Count != 0 && i == LatBuckets - 1)
+                {
+                    printf("    >= %u us: %u\n", 1u << (i - 1), Count);
+                }
+                else if (Count != 0)
+                {
+                    printf("    < %u us: %u\n", 1u << i, Count);
+                }
+            }
+        }
+    }
+    fflush(stdout);
+
+}
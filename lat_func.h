@@ -0,0 +1,68 @@
+/*
+*  lat_func.h
+*  latency tracing functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO TRACE INPUT-TO-OUTPUT LATENCIES  */
+/* ------------------------------------------------------------------ */
+
+#ifndef LAT_FUNC_H
+#define LAT_FUNC_H
+
+// Inputs a trace can start from
+#define LatEncoder 0            // Step of the rotary encoder
+#define LatKey 1                // Mode selected with the keys (or by an external client)
+#define LatSources 2
+
+// Stages of a trace, each timed from the one it follows
+#define LatApply 0              // Input taken up by the control path (from the input)
+#define LatDecide 1             // New on-time chosen (from LatApply)
+#define LatActuate 2            // PWM pin driven by the new on-time (from LatDecide)
+#define LatRespond 3            // Measured speed changed (from LatActuate)
+#define LatDisplay 4            // Displays refreshed with the new measurements (from LatDecide)
+#define LatStages 5
+
+// Tracing constants
+#define LatBuckets 24               // Histogram buckets: 0 us, then powers of two up to 2^22 us and above
+#define LatTimeoutTicks 250000000   // Time a stage is waited for before the trace is abandoned (5 s)
+
+/*
+* Summary of the latencies recorded for one stage, in microseconds.
+* Percentiles are the upper edges of their histogram buckets.
+*/
+
+struct LatSummary
+{
+    unsigned int Count;             // Latencies recorded
+    unsigned int Timeouts;          // Traces abandoned while waiting for the stage
+    unsigned int Median;            // Median latency
+    unsigned int Percentile99;      // 99th percentile latency
+    unsigned int Max;               // Longest latency
+};
+
+struct ControlState;
+
+// FUNCTION DECLARATIONS //
+
+void LatInput(int, unsigned int);    // Starts a trace from an input tagged
+                                     // with the counter value it was seen at.
+
+
+void LatPass(const struct ControlState *, int);    // Follows the trace in flight through
+                                                   // one pass of the control path.
+
+
+void LatDisplayed(unsigned long long);    // Marks the displays as refreshed with the
+                                          // measurements taken at a time.
+
+
+void LatSummaryGet(int, int, struct LatSummary *);    // Summarises the latencies of one
+                                                      // stage for one kind of input.
+
+
+void LatDump(void);    // Prints every histogram.
+
+#endif
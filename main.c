@@ -14,31 +14,44 @@
 #include "socal/socal.h"
 #include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 // Including custom header files
-#include "user_func.h"
-#include "fan_func.h"
-#include "disp_func.h"
-#include "misc_func.h"
+#include "input_func.h"
+#include "temp_func.h"
+#include "traj_func.h"
+#include "prof_func.h"
+#include "bump_func.h"
+#include "lat_func.h"
+#include "board_func.h"
+#include "task_func.h"
+#include "ipc_func.h"
+#include "metrics_func.h"
+#include "param_func.h"
+#include "autof_func.h"
+#include "persist_func.h"
 #include "globals.h"
 
-// Initializing global pointers that are used to interface with the FPGA
-volatile int * LEDs     = (volatile int *)ALT_LWFPGA_LED_BASE;
-volatile int * Switches = (volatile int *)ALT_LWFPGA_SWITCH_BASE;
-volatile unsigned int * Counter = (volatile unsigned int *)ALT_LWFPGA_COUNTER_BASE;
-volatile int * Keys = (volatile int *)ALT_LWFPGA_KEY_BASE;
-volatile int * GpioPort = (volatile int *) (ALT_LWFPGA_GPIO_0A_BASE);
-volatile int * Hex3to0 = (volatile int *)(ALT_LWFPGA_HEXA_BASE);
-volatile int * Hex5to4 = (volatile int *)(ALT_LWFPGA_HEXB_BASE);
-
 // Initializing global constants to be used in multiple functions
 const int ClockFrequency = 50000000;
-const int MaxRPS = 42;
+
+// Initializing tunable globals to their compiled-in values (see param_func)
+float Kp = 0.000025;
+float Ki = 0.000000000015;
+float Kd = 0.8;
+int MaxRPS = 42;
+int EncoderStep = 1;
+int FreqChoices[FreqChoiceCount] = {10, 100, 1000, 3000, 5000, 7500};
+int RespChoices[RespChoiceCount] = {1, 2, 5, 10, 20};
 
 int main(int argc, char** argv)
 {
-    // Function call to initialise the FPGA configuration
-    EE30186_Start();
+    // Function call to initialise the board and the global pointers
+    // that are used to interface with it
+    if (!BoardStart(argc, argv))
+    {
+        return 1;
+    }
 
     // Setting the data direction register to 1
     volatile int *GpioDdr = GpioPort + 1;
@@ -49,100 +62,106 @@ int main(int argc, char** argv)
     // Setting the 4th pin of * GpioPort as an output pin
     *GpioDdr = 0x08;
 
-    // Defining all main variables and setting initial conditions
-
-    int Mode = 0;               // Mode that is selected based on the pressed key
-    int PWMFrequency = 10;      // Operating frequency of the fan
-    int Responsiveness = 1;     // Constant that alters the rate at which the rotary encoder affects the duty cycle
-
-    unsigned int Cycle;         // Current cycle of the counter, loops from 0 to 100
-
-    int DutyCycle = 0;          // Duty cycle of the PWM, can be any integer between 0 and 100
-    int OnTime = DutyCycle;     // On-time of the PWM, equivalent to DutyCycle in this case due to the selected Cycle period
-    int DesiredSpeed;           // A function of DutyCycle with a minimum value of 0 and a maximum value of 50
-
-    int RPS = 0;                // Speed of the fan in RPS
-
-    int Switches4to0;           // Takes in the values of SW4 to SW0
-    int Switches8to5;           // Takes in the values of SW8 to SW5
-    int Switch9;                // Takes in the value of SW9
-
-    int FanOn = 0;              // Integer that determines if fan is on or off (0-1)
-    int ResetClosed = 0;        // Integer that determines if closed-loop errors should be reset
-
-    // Start of the main loop which runs continuously
-    while (1)
+    // Filtering the GPIO inputs with a 2-of-3 majority and no hold-off
+    InputFilterConfig(2, 3, 0);
+
+    // Turning on the feed-forward of the planned speed in closed-loop
+    // mode if the build asks for it
+#ifdef FAN_TRAJ_FF
+    TrajectoryConfig(1);
+#endif
+
+    // Turning on bumpless mode transfer if the build asks for it
+#ifdef FAN_BUMPLESS
+    BumplessConfig(1);
+#endif
+
+    // Choosing the PWM frequency automatically whatever the switches if
+    // the build asks for it
+#ifdef FAN_AUTO_FREQ
+    AutofConfig(1);
+#endif
+
+    // Selecting the temperature source used in thermostatic mode; the
+    // simulated sensor is used unless a file or hwmon sensor is given.
+    // --traj-ff turns on the feed-forward of the planned speed,
+    // --bumpless turns on bumpless mode transfer, --auto-freq chooses
+    // the PWM frequency automatically, --latency prints the latency
+    // histograms on exit and --profile selects the profile played in
+    // auto-mode
+    int Latency = 0;
+    int Arg;
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--traj-ff") == 0)
         {
-
-            // Extracting the required values from the switches
-            Switches4to0 = (*Switches)&31;
-            Switches8to5 = ((*Switches)&480) >> 5;
-            Switch9 = ((*Switches)&512) >> 9;
-
-            // Lighting up the LEDs based on the value of DutyCycle
-            LEDLights(DutyCycle);
-
-            // Selecting the PWMFrequency and Responsiveness based on the relevant switch values
-            PWMFrequency = FreqSelect(Switches4to0, PWMFrequency);
-            Responsiveness = RespSelect(Switches8to5, Responsiveness);
-
-            // Selecting the desired mode
-            Mode = ModeSelect(Mode, &DutyCycle, &RPS, &ResetClosed);
-
-            // Switch statement that determines which functions to run based on which mode is selected
-            switch (Mode)
-            {
-
-            // Mode 0: Off-mode; fan is turned off
-            case 0:
-                *GpioPort = 0x00;
-                break;
-
-            // Mode 1: Auto-mode; fan speed gradually increases and then decreases
-            case 1:
-                Cycle = Timer(PWMFrequency);
-                DutyCycle = AutoEncoder(DutyCycle, Responsiveness);
-                OnTime = DutyCycle;
-                PWMGenerator(Cycle, OnTime, &FanOn);
-                // Updating RPS only when the PWM signal is high or the fan is completely stationary
-                if (FanOn || (OnTime == 0)) { RPS = Tachometer(RPS); }
-                break;
-
-            // Mode 2: Closed-loop; uses PID control to make sure the speed of the fan is similar to the desired speed
-            case 2:
-                Cycle = Timer(PWMFrequency);
-                DutyCycle = RotaryEncoder(DutyCycle, Responsiveness);
-                DesiredSpeed = DutyCycle/2;
-                // Adjusting OnTime through PID control
-                OnTime = ClosedLoopController(DesiredSpeed, RPS, OnTime, &ResetClosed);
-                PWMGenerator(Cycle, OnTime, &FanOn);
-                // Updating RPS only when the PWM signal is high or the fan is completely stationary
-                if (FanOn || (OnTime == 0)) { RPS = Tachometer(RPS); }
-                break;
-
-            // Mode 3: Open-loop; standard mode that implements open-loop control
-            case 3:
-                Cycle = Timer(PWMFrequency);
-                DutyCycle = RotaryEncoder(DutyCycle, Responsiveness);
-                DesiredSpeed = DutyCycle/2;
-                OnTime = DutyCycle;
-                PWMGenerator(Cycle, OnTime, &FanOn);
-                // Updating RPS only when the PWM signal is high or the fan is completely stationary
-                if (FanOn || (OnTime == 0)) { RPS = Tachometer(RPS); }
-                break;
-
-            default:
-                break;
-
-            }
-
-            // Displaying relevant information on the seven-segment displays
-            Display(Mode, Switch9, DutyCycle, RPS, DesiredSpeed, OnTime, PWMFrequency);
-
+            TrajectoryConfig(1);
         }
-
-    // Function call to clean up and close the FPGA configuration
-    EE30186_End();
+        else if (strcmp(argv[Arg], "--bumpless") == 0)
+        {
+            BumplessConfig(1);
+        }
+        else if (strcmp(argv[Arg], "--auto-freq") == 0)
+        {
+            AutofConfig(1);
+        }
+        else if (strcmp(argv[Arg], "--latency") == 0)
+        {
+            Latency = 1;
+        }
+        else if (Arg + 1 >= argc)
+        {
+            break;
+        }
+        else if (strcmp(argv[Arg], "--temp-file") == 0)
+        {
+            TempSourceSelect(TempSourceFile, argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--temp-hwmon") == 0)
+        {
+            TempSourceSelect(TempSourceHwmon, argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--profile") == 0 && !ProfileSelect(argv[++Arg]))
+        {
+            fprintf(stderr, "%s: cannot read profile %s\n", argv[0], argv[Arg]);
+            BoardEnd();
+            return 1;
+        }
+    }
+
+    // Opening the local control interface, the metrics page and the
+    // parameter console, if they were asked for, and restoring the
+    // state learnt before the last restart
+    if (!IpcStart(argc, argv) || !MetricsStart(argc, argv) || !ParamStart(argc, argv) ||
+        !PersistStart(argc, argv))
+    {
+        IpcEnd();
+        BoardEnd();
+        return 1;
+    }
+
+    // Running the control path and the user interface until the board
+    // stops (or until a replayed trace ends)
+    if (!RunTasks(argc, argv))
+    {
+        PersistEnd();
+        MetricsEnd();
+        IpcEnd();
+        BoardEnd();
+        return 1;
+    }
+
+    if (Latency)
+    {
+        LatDump();
+    }
+
+    // Function call to save the learnt state and to clean up and close
+    // the metrics page, the local control interface and the board
+    PersistEnd();
+    MetricsEnd();
+    IpcEnd();
+    BoardEnd();
 
     return 0;
 
@@ -0,0 +1,229 @@
+/*
+*  metrics_func.c
+*  metrics page functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO PUBLISH THE CONTROLLER'S METRICS */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include "metrics_func.h"
+
+#ifdef FAN_LINUX
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "fan_func.h"
+#include "board_func.h"
+#include "kick_func.h"
+#include "wdog_func.h"
+#include "stats_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Page used until (or unless) a file is mapped; on the bare-metal build
+// it can be read through the debugger
+static struct MetricsPage LocalPage;
+static volatile struct MetricsPage *Page = &LocalPage;
+
+static unsigned int Loops;          // Passes of the control path
+static unsigned int WindowLoops;    // Passes counted in the current half-second
+static struct TimeWindow Window;    // Current half-second
+static unsigned int WindowIdle;     // Idle ticks at the start of the current half-second
+static unsigned int LoopRate;       // Passes per second over the last half-second
+static unsigned int IdleShare;      // Share of the last half-second spent asleep (per mille)
+
+/*
+* Function: MetricsHeader
+* --------------------------------
+* Writes the identification of the page. The magic number is written
+* last so that readers only use a page that is ready.
+*/
+
+static void MetricsHeader(void)
+{
+
+    Page->Version = MetricsVersion;
+    Page->Size = sizeof(struct MetricsPage);
+    Page->ClockFrequency = ClockFrequency;
+    __atomic_store_n(&Page->Magic, MetricsMagic, __ATOMIC_RELEASE);
+
+}
+
+/*
+* Function: MetricsStart
+* --------------------------------
+* On the Linux build (FAN_LINUX) maps the file given by
+* --metrics PATH (e.g. /dev/shm/fan_metrics) as the metrics page, so
+* that monitoring programs can map it read-only and poll it at any
+* rate. Without --metrics the page stays in the controller's memory.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1 if the page is ready or 0 if the file could not be mapped.
+*/
+
+int MetricsStart(int argc, char **argv)
+{
+
+#ifdef FAN_LINUX
+    int Descriptor;
+    void *Mapped;
+    int Arg;
+
+    for (Arg = 1; Arg + 1 < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--metrics") != 0)
+        {
+            continue;
+        }
+
+        Descriptor = open(argv[++Arg], O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (Descriptor < 0 || ftruncate(Descriptor, sizeof(struct MetricsPage)) != 0)
+        {
+            perror(argv[Arg]);
+            if (Descriptor >= 0)
+            {
+                close(Descriptor);
+            }
+            return 0;
+        }
+
+        Mapped = mmap(NULL, sizeof(struct MetricsPage), PROT_READ | PROT_WRITE, MAP_SHARED, Descriptor, 0);
+        close(Descriptor);
+        if (Mapped == MAP_FAILED)
+        {
+            perror(argv[Arg]);
+            return 0;
+        }
+        Page = (volatile struct MetricsPage *)Mapped;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    MetricsHeader();
+
+    return 1;
+}
+
+/*
+* Function: MetricsPublish
+* --------------------------------
+* Called at the end of every pass of the control path. Costs a few
+* plain stores and two barriers; the loop rate is worked out once per
+* half-second of the counter.
+*
+* *Control: Pointer to the state of the control path.
+*/
+
+void MetricsPublish(const struct ControlState *Control)
+{
+
+    const struct FanStats *Stats = FanStatsGet();
+    const struct IdleStats *Idle = BoardIdleStats();
+    const struct KickStats *Kick = KickStatsGet();
+    const struct WdogStats *Wdog = WdogStatsGet();
+    unsigned int Sequence = Page->Sequence;
+    unsigned int Now = (unsigned int)TimeNow();
+    int i;
+    int j;
+
+    // Working out the loop rate whenever a half-second has passed
+    Loops++;
+    WindowLoops++;
+    if (TimeWindowUpdate(&Window, ClockFrequency/2))
+    {
+        LoopRate = WindowLoops*2;
+        IdleShare = (unsigned long long)(Idle->IdleTicks - WindowIdle)*1000/(ClockFrequency/2);
+        WindowLoops = 0;
+        WindowIdle = Idle->IdleTicks;
+    }
+
+    // Publishing less often while the watchdog is shedding load
+    if (!WdogAllow(WdogMetrics))
+    {
+        return;
+    }
+
+    // Marking the values as being updated before any of them change
+    Page->Sequence = Sequence + 1;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    Page->Counter = Now;
+    Page->Loops = Loops;
+    Page->LoopRate = LoopRate;
+    Page->IdleShare = IdleShare;
+    Page->Mode = Control->Setpoints.Mode;
+    Page->DutyCycle = Control->DutyCycle;
+    Page->OnTime = Control->OnTime;
+    Page->DesiredSpeed = Control->DesiredSpeed;
+    Page->RPS = Control->RPS;
+    Page->PWMFrequency = Control->Setpoints.PWMFrequency;
+    Page->Temperature = Control->Temperature;
+    Page->Proportional = Stats->Proportional;
+    Page->Integral = Stats->Integral;
+    Page->Derivative = Stats->Derivative;
+    Page->TachEdges = Stats->TachEdges;
+    Page->EncoderSteps = Stats->EncoderSteps;
+    Page->EncoderMissed = Stats->EncoderMissed;
+    Page->GpioWrites = Stats->GpioWrites;
+    Page->IdleTicks = Idle->IdleTicks;
+    Page->Sleeps = Idle->Sleeps;
+    Page->LateTicks = Idle->LateTicks;
+    Page->Kicks = Kick->Kicks;
+    Page->Stalls = Kick->Stalls;
+    Page->Faults = Kick->Faults;
+    Page->SustainDuty = Kick->SustainDuty;
+    for (i = 0; i < WdogStages; i++)
+    {
+        Page->Misses[i] = Wdog->Misses[i];
+    }
+    Page->ShedLevel = Wdog->Level;
+    for (i = 0; i < StatsSignals; i++)
+    {
+        for (j = 0; j < StatsWindows; j++)
+        {
+            Page->Stats[i][j] = *StatsSummaryGet(i, j);
+        }
+    }
+
+    // Marking the update as complete after every value has changed
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    Page->Sequence = Sequence + 2;
+
+}
+
+/*
+* Function: MetricsEnd
+* --------------------------------
+* Unmaps the metrics page. The file is left in place with the last
+* values published.
+*/
+
+void MetricsEnd(void)
+{
+
+#ifdef FAN_LINUX
+    if (Page != &LocalPage)
+    {
+        munmap((void *)Page, sizeof(struct MetricsPage));
+        Page = &LocalPage;
+    }
+#endif
+
+}
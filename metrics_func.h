@@ -0,0 +1,98 @@
+/*
+*  metrics_func.h
+*  metrics page functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO PUBLISH THE CONTROLLER'S METRICS */
+/* ------------------------------------------------------------------ */
+
+#ifndef METRICS_FUNC_H
+#define METRICS_FUNC_H
+
+#include "wdog_func.h"
+#include "stats_func.h"
+
+// Identification of the metrics page
+#define MetricsMagic 0x5254454D         // "METR" when read as little-endian bytes
+#define MetricsVersion 6
+
+// Size of a cache line on the Cortex-A9
+#define MetricsLineSize 64
+
+/*
+* Layout of the metrics page. The first cache line is written once at
+* start-up; the values are guarded by Sequence, which is odd while the
+* controller updates them (see SharedWrite). Readers map the page
+* read-only, copy the values and keep the copy only if Sequence was
+* even and unchanged. New fields are only ever added at the end, with
+* a new version.
+*/
+
+struct MetricsPage
+{
+    // Written once
+    unsigned int Magic __attribute__((aligned(MetricsLineSize)));    // MetricsMagic
+    unsigned int Version;               // MetricsVersion
+    unsigned int Size;                  // Size of the page in bytes
+    unsigned int ClockFrequency;        // Frequency of the counter in Hz
+
+    // Written on every pass of the control path
+    unsigned int Sequence __attribute__((aligned(MetricsLineSize)));    // Odd while the values are updated
+    unsigned int Counter;               // Counter value at the update (low 32 bits of the time)
+    unsigned int Loops;                 // Passes of the control path
+    unsigned int LoopRate;              // Passes per second over the last half-second
+    int Mode;                           // Selected mode
+    int DutyCycle;                      // Duty cycle of the PWM (0-100)
+    int OnTime;                         // On-time of the PWM (0-100)
+    int DesiredSpeed;                   // Desired speed of the fan (0-50)
+    int RPS;                            // Speed of the fan in RPS
+    int PWMFrequency;                   // Operating frequency of the fan in Hz
+    int Temperature;                    // Measured temperature in millidegrees Celsius
+    float Proportional;                 // Proportional term of the last PID update
+    float Integral;                     // Integral term of the last PID update
+    float Derivative;                   // Derivative term of the last PID update
+    unsigned int TachEdges;             // Rising edges counted by the tachometer
+    unsigned int EncoderSteps;          // Steps decoded from the rotary encoder
+    unsigned int EncoderMissed;         // Encoder samples in which both pins changed
+    unsigned int GpioWrites;            // Writes to GPIO port 0 by the PWM generator
+
+    // Added in version 2
+    unsigned int IdleTicks;             // Counter ticks spent asleep between passes
+    unsigned int Sleeps;                // Number of times the loop went to sleep
+    unsigned int LateTicks;             // Counter ticks by which sleeps overran their deadlines
+    unsigned int IdleShare;             // Share of the last half-second spent asleep (per mille)
+
+    // Added in version 3
+    unsigned int Kicks;                 // Full-duty kicks applied by the start assist
+    unsigned int Stalls;                // Stalls detected while the fan was powered
+    int SustainDuty;                    // Learnt minimum sustain duty (0-100)
+
+    // Added in version 4
+    unsigned int Misses[WdogStages];    // Deadline misses blamed on each stage (see wdog_func.h)
+    int ShedLevel;                      // Current load shedding level
+
+    // Added in version 5
+    struct StatsSummary Stats[StatsSignals][StatsWindows];    // Windowed statistics (see stats_func.h)
+
+    // Added in version 6
+    unsigned int Faults;                // Stalls at on-times above the learnt range
+};
+
+struct ControlState;
+
+// FUNCTION DECLARATIONS //
+
+int MetricsStart(int, char **);    // Maps the metrics page given on the
+                                   // command line.
+
+
+void MetricsPublish(const struct ControlState *);    // Publishes the metrics of one
+                                                     // pass of the control path.
+
+
+void MetricsEnd(void);    // Unmaps the metrics page.
+
+#endif
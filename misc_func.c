@@ -17,8 +17,13 @@
 #include "misc_func.h"
 
 // Including other necessary custom headers
+#include "board_func.h"
 #include "globals.h"
 
+// Sine of 0 to 90 degrees in 16 steps, scaled to 1000
+static const short SineTable[17] = {0, 98, 195, 290, 383, 471, 556, 634, 707,
+                                    773, 831, 882, 924, 957, 981, 995, 1000};
+
 /*
 * Function: Set
 * --------------------------------
@@ -41,7 +46,8 @@ void Set(int *X, int SetValue)
 * --------------------------------
 * Creates a manual delay by looping through the length of an
 * inputted integer. The greater the value of the input the
-* longer the delay.
+* longer the delay. On the Linux build the board waits for the
+* time the loop would have taken instead.
 *
 * Length: An integer that determines the length of the loop
 * used to create a delay.
@@ -50,11 +56,49 @@ void Set(int *X, int SetValue)
 void Delay(int Length)
 {
 
+#ifdef FAN_LINUX
+    BoardDelay(Length);
+#else
     int i = 0;
 
     while (i < Length)
     {
         i++;
     }
+#endif
+
+}
+
+/*
+* Function: SineLookup
+* --------------------------------
+* Works out a sine from the table by straight-line interpolation.
+*
+* Phase: Position within one period (0-1023).
+*
+* Returns: The sine scaled to 1000 (-1000 to 1000).
+*/
+
+int SineLookup(unsigned int Phase)
+{
+
+    unsigned int Quarter = (Phase >> 8) & 0x03; // Quarter of the period
+    unsigned int Angle = Phase & 0xFF; // Position within the quarter (0-255)
+    int Value;
+
+    // The second and fourth quarters run backwards through the table
+    if (Quarter & 0x01)
+    {
+        Angle = 256 - Angle;
+    }
+    if (Angle >= 256)
+    {
+        Value = SineTable[16];
+    }
+    else
+    {
+        Value = SineTable[Angle >> 4] + ((SineTable[(Angle >> 4) + 1] - SineTable[Angle >> 4])*(int)(Angle & 0x0F))/16;
+    }
 
+    return (Quarter & 0x02) ? -Value : Value;
 }
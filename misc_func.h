@@ -20,5 +20,8 @@ void Set(int *, int);   // Sets the value of the first integer to the
 void Delay(int);    // Sets a delay by looping continuously over
                     // an input.
 
+int SineLookup(unsigned int);    // Works out a sine from a table, for
+                                 // phases of 0 to 1023 per period.
+
 #endif
 
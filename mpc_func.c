@@ -0,0 +1,178 @@
+/*
+*  mpc_func.c
+*  model-predictive controller functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO CONTROL THE FAN FROM MPC TABLES  */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "mpc_func.h"
+
+// Including other necessary custom headers
+#include "fan_func.h"
+#include "globals.h"
+
+static int OnTime;                  // On-time chosen at the last measurement
+static int Disturbance;             // Estimated offset of the measured speed from the model (1/256 RPS)
+static int PrevMeasured;            // Previous measured speed (1/256 RPS)
+static int Started;                 // Set once a speed has been measured
+static unsigned int LastWindows;    // Tachometer windows at the last measurement
+
+/*
+* Function: GridIndex
+* --------------------------------
+* Finds the grid cell a value falls in and its position within it.
+*
+* Value: The value, in 1/256 of the units of the grid.
+* Step: Spacing of the grid points.
+* Points: Number of grid points.
+* *Fraction: Set to the position within the cell (0-256).
+*
+* Returns: The index of the lower grid point of the cell.
+*/
+
+static int GridIndex(int Value, int Step, int Points, int *Fraction)
+{
+
+    int Index;
+
+    // Restricting the value to the grid
+    Value = (Value < 0) ? 0 : Value;
+    Value = (Value > (Points - 1)*Step*256) ? (Points - 1)*Step*256 : Value;
+
+    Index = Value/(Step*256);
+    *Fraction = (Value - Index*Step*256)/Step;
+    if (Index >= Points - 1)
+    {
+        Index = Points - 2;
+        *Fraction = 256;
+    }
+
+    return Index;
+}
+
+/*
+* Function: Lookup
+* --------------------------------
+* Reads the control table by trilinear interpolation between the
+* eight grid points around the state.
+*
+* Speed: The measured speed (1/256 RPS).
+* Target: The target speed (1/256 RPS).
+* Previous: The previous on-time (0-100).
+*
+* Returns: The on-time (0-100).
+*/
+
+static int Lookup(int Speed, int Target, int Previous)
+{
+
+    int Fs, Ft, Fp; // Positions within the cell (0-256)
+    int s = GridIndex(Speed, MpcSpeedStep, MpcSpeedPoints, &Fs);
+    int t = GridIndex(Target, MpcSpeedStep, MpcTargetPoints, &Ft);
+    int p = GridIndex(Previous*256, MpcOnTimeStep, MpcOnTimePoints, &Fp);
+    int Corner[2][2]; // Interpolated along the on-time axis (1/256 percent)
+    int Edge[2]; // Interpolated along the target axis (1/256 percent)
+    int i, j;
+
+    for (i = 0; i < 2; i++)
+    {
+        for (j = 0; j < 2; j++)
+        {
+            Corner[i][j] = MpcTable[s + i][t + j][p]*(256 - Fp) + MpcTable[s + i][t + j][p + 1]*Fp;
+        }
+        Edge[i] = (Corner[i][0]*(256 - Ft) + Corner[i][1]*Ft) >> 8;
+    }
+
+    return (((Edge[0]*(256 - Fs) + Edge[1]*Fs) >> 8) + 128) >> 8;
+}
+
+/*
+* Function: MpcReset
+* --------------------------------
+* Starts the controller from an on-time. From an on-time of 0 the fan
+* is taken to be at a standstill with no estimated offset. Otherwise
+* (a bumpless transfer) the fan is taken to be steady at the measured
+* speed, and the offset is set to whatever the model leaves between
+* that speed and the speed the on-time should give. The on-time is
+* then held until the next measurement.
+*
+* Start: The on-time the fan is driven at (0-100).
+* RPS: The measured speed of the fan in RPS.
+*/
+
+void MpcReset(int Start, int RPS)
+{
+
+    OnTime = Start;
+    Disturbance = 0;
+    PrevMeasured = 0;
+    Started = 0;
+    LastWindows = FanStatsGet()->TachWindows;
+
+    if (Start > 0)
+    {
+        PrevMeasured = RPS*256;
+        Disturbance = PrevMeasured - MpcGain*Start;
+        Started = 1;
+    }
+
+}
+
+/*
+* Function: MpcController
+* --------------------------------
+* Explicit model-predictive control of the speed (mode 6). The
+* constrained problem was solved offline by tools/mpc_gen.c over a grid
+* of measured speed, target speed and previous on-time, so each new
+* measurement costs one trilinear interpolation in MpcTable and the
+* on-time is held in between. The on-time limits and the half-second
+* measurement delay are part of the offline problem, so the controller
+* neither winds up nor has to wait for the delay to show its effect.
+*
+* A disturbance observer compares each measurement with the speed the
+* model predicted and moves the state and target by the difference,
+* which removes the steady-state error a model that does not match
+* the fan exactly would leave.
+*
+* DesiredSpeed: The desired speed of the fan set by the user (0-50).
+* RPS: The measured speed of the fan in revolutions per second.
+*
+* Returns: OnTime, the on-time of the fan (0-100).
+*/
+
+int MpcController(int DesiredSpeed, int RPS)
+{
+
+    unsigned int Windows = FanStatsGet()->TachWindows;
+    int Measured = RPS*256; // Measured speed in 1/256 RPS
+    int Target = DesiredSpeed*MaxRPS*256/50; // Target speed in 1/256 RPS
+    int Predicted; // Speed the model predicted for this measurement
+
+    // Only a new measurement changes the on-time
+    if (Windows == LastWindows)
+    {
+        return OnTime;
+    }
+    LastWindows = Windows;
+
+    if (Started)
+    {
+        Predicted = (MpcDecay*(PrevMeasured - Disturbance) + (256 - MpcDecay)*MpcGain*OnTime)/256 + Disturbance;
+        Disturbance += (Measured - Predicted)*MpcObserverGain/256;
+    }
+    PrevMeasured = Measured;
+    Started = 1;
+
+    OnTime = (DesiredSpeed > 0) ? Lookup(Measured - Disturbance, Target - Disturbance, OnTime) : 0;
+
+    return OnTime;
+}
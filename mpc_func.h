@@ -0,0 +1,39 @@
+/*
+*  mpc_func.h
+*  model-predictive controller functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO CONTROL THE FAN FROM MPC TABLES  */
+/* ------------------------------------------------------------------ */
+
+#ifndef MPC_FUNC_H
+#define MPC_FUNC_H
+
+// Grid of the control table (speeds in RPS, on-times in percent)
+#define MpcSpeedPoints 22       // Measured speeds 0, 2, ... 42
+#define MpcTargetPoints 22      // Target speeds 0, 2, ... 42
+#define MpcOnTimePoints 11      // Previous on-times 0, 10, ... 100
+#define MpcSpeedStep 2          // Spacing of the speed and target points
+#define MpcOnTimeStep 10        // Spacing of the on-time points
+
+// Gain of the disturbance observer (out of 256)
+#define MpcObserverGain 64
+
+// Control table and model, generated by tools/mpc_gen.c into mpc_table.c
+extern const unsigned char MpcTable[MpcSpeedPoints][MpcTargetPoints][MpcOnTimePoints];
+extern const int MpcDecay;      // Fraction of the speed left after one half-second (out of 256)
+extern const int MpcGain;       // Steady speed per percent of on-time in 1/256 RPS
+
+// FUNCTION DECLARATIONS //
+
+void MpcReset(int, int);    // Starts the controller from an on-time
+                           // and measured speed.
+
+
+int MpcController(int, int);    // Works out the on-time from the control table
+                                // whenever a new speed has been measured.
+
+#endif
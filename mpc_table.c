@@ -0,0 +1,544 @@
+/*
+*  mpc_table.c
+*  model-predictive control table
+*
+*  Generated by tools/mpc_gen.c with --gain 0.42 --tau 1 --weight 0.05 --horizon 10.
+*  Do not edit; run the generator again instead.
+*/
+
+#include "mpc_func.h"
+
+const int MpcDecay = 155;
+const int MpcGain = 108;
+
+// On-time by measured speed, target speed and previous on-time
+const unsigned char MpcTable[MpcSpeedPoints][MpcTargetPoints][MpcOnTimePoints] = {
+    {
+        {  0,   2,   5,   7,  10,  12,  15,  17,  20,  22,  25},
+        {  5,   8,  11,  13,  16,  18,  21,  23,  26,  28,  31},
+        { 11,  13,  16,  18,  21,  24,  26,  29,  31,  34,  36},
+        { 16,  19,  21,  24,  26,  29,  32,  34,  37,  39,  42},
+        { 22,  24,  27,  29,  32,  34,  37,  40,  42,  45,  47},
+        { 27,  30,  32,  35,  37,  40,  42,  45,  48,  50,  53},
+        { 33,  35,  38,  40,  43,  45,  48,  50,  53,  55,  58},
+        { 38,  40,  43,  46,  48,  51,  53,  56,  58,  61,  63},
+        { 43,  46,  48,  51,  54,  56,  59,  61,  64,  66,  69},
+        { 49,  51,  54,  56,  59,  62,  64,  67,  69,  72,  74},
+        { 54,  57,  59,  62,  64,  67,  70,  72,  75,  77,  80},
+        { 60,  62,  65,  67,  70,  72,  75,  77,  80,  83,  85},
+        { 65,  68,  70,  73,  75,  78,  80,  83,  85,  88,  91},
+        { 70,  73,  76,  78,  81,  83,  86,  88,  91,  93,  96},
+        { 76,  78,  81,  84,  86,  89,  91,  94,  96,  99, 100},
+        { 81,  84,  86,  89,  91,  94,  97,  99, 100, 100, 100},
+        { 86,  89,  92,  94,  97,  99, 100, 100, 100, 100, 100},
+        { 91,  93,  96,  99, 100, 100, 100, 100, 100, 100, 100},
+        { 96,  98, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   1,   3,   6,   8,  11,  13,  16,  18,  20,  23},
+        {  4,   6,   9,  11,  14,  16,  19,  21,  24,  26,  29},
+        {  9,  12,  14,  17,  19,  22,  24,  27,  29,  32,  35},
+        { 14,  17,  19,  22,  25,  27,  30,  32,  35,  37,  40},
+        { 20,  22,  25,  27,  30,  33,  35,  38,  40,  43,  45},
+        { 25,  28,  30,  33,  35,  38,  41,  43,  46,  48,  51},
+        { 31,  33,  36,  38,  41,  43,  46,  49,  51,  54,  56},
+        { 36,  39,  41,  44,  46,  49,  51,  54,  56,  59,  62},
+        { 41,  44,  47,  49,  52,  54,  57,  59,  62,  64,  67},
+        { 47,  49,  52,  55,  57,  60,  62,  65,  67,  70,  72},
+        { 52,  55,  57,  60,  63,  65,  68,  70,  73,  75,  78},
+        { 58,  60,  63,  65,  68,  71,  73,  76,  78,  81,  83},
+        { 63,  66,  68,  71,  73,  76,  78,  81,  84,  86,  89},
+        { 69,  71,  74,  76,  79,  81,  84,  86,  89,  92,  94},
+        { 74,  77,  79,  82,  84,  87,  89,  92,  94,  97, 100},
+        { 79,  82,  85,  87,  90,  92,  95,  97, 100, 100, 100},
+        { 85,  87,  90,  92,  95,  98, 100, 100, 100, 100, 100},
+        { 89,  92,  94,  97, 100, 100, 100, 100, 100, 100, 100},
+        { 94,  96,  99, 100, 100, 100, 100, 100, 100, 100, 100},
+        { 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   1,   4,   6,   9,  11,  14,  16,  19,  21},
+        {  2,   4,   7,   9,  12,  14,  17,  19,  22,  24,  27},
+        {  7,  10,  12,  15,  17,  20,  22,  25,  28,  30,  33},
+        { 13,  15,  18,  20,  23,  25,  28,  30,  33,  35,  38},
+        { 18,  20,  23,  26,  28,  31,  33,  36,  38,  41,  43},
+        { 23,  26,  28,  31,  34,  36,  39,  41,  44,  46,  49},
+        { 29,  31,  34,  36,  39,  42,  44,  47,  49,  52,  54},
+        { 34,  37,  39,  42,  44,  47,  50,  52,  55,  57,  60},
+        { 40,  42,  45,  47,  50,  52,  55,  57,  60,  63,  65},
+        { 45,  48,  50,  53,  55,  58,  60,  63,  65,  68,  71},
+        { 50,  53,  56,  58,  61,  63,  66,  68,  71,  73,  76},
+        { 56,  58,  61,  64,  66,  69,  71,  74,  76,  79,  81},
+        { 61,  64,  66,  69,  71,  74,  77,  79,  82,  84,  87},
+        { 67,  69,  72,  74,  77,  79,  82,  85,  87,  90,  92},
+        { 72,  75,  77,  80,  82,  85,  87,  90,  93,  95,  98},
+        { 78,  80,  83,  85,  88,  90,  93,  95,  98, 100, 100},
+        { 83,  86,  88,  91,  93,  96,  98, 100, 100, 100, 100},
+        { 88,  90,  93,  95,  98, 100, 100, 100, 100, 100, 100},
+        { 92,  95,  97, 100, 100, 100, 100, 100, 100, 100, 100},
+        { 97, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   2,   5,   7,  10,  12,  15,  17,  19},
+        {  0,   2,   5,   7,  10,  13,  15,  18,  20,  23,  25},
+        {  5,   8,  10,  13,  15,  18,  21,  23,  26,  28,  31},
+        { 11,  13,  16,  18,  21,  23,  26,  29,  31,  34,  36},
+        { 16,  19,  21,  24,  26,  29,  31,  34,  36,  39,  42},
+        { 21,  24,  27,  29,  32,  34,  37,  39,  42,  44,  47},
+        { 27,  29,  32,  35,  37,  40,  42,  45,  47,  50,  52},
+        { 32,  35,  37,  40,  43,  45,  48,  50,  53,  55,  58},
+        { 38,  40,  43,  45,  48,  51,  53,  56,  58,  61,  63},
+        { 43,  46,  48,  51,  53,  56,  58,  61,  64,  66,  69},
+        { 49,  51,  54,  56,  59,  61,  64,  66,  69,  72,  74},
+        { 54,  57,  59,  62,  64,  67,  69,  72,  74,  77,  80},
+        { 59,  62,  65,  67,  70,  72,  75,  77,  80,  82,  85},
+        { 65,  67,  70,  72,  75,  78,  80,  83,  85,  88,  90},
+        { 70,  73,  75,  78,  80,  83,  86,  88,  91,  93,  96},
+        { 76,  78,  81,  83,  86,  88,  91,  94,  96,  99, 100},
+        { 81,  84,  86,  89,  91,  94,  96,  99, 100, 100, 100},
+        { 86,  89,  91,  94,  96,  99, 100, 100, 100, 100, 100},
+        { 91,  93,  96,  98, 100, 100, 100, 100, 100, 100, 100},
+        { 95,  98, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   3,   5,   8,  10,  13,  15,  18},
+        {  0,   0,   3,   6,   8,  11,  13,  16,  18,  21,  23},
+        {  3,   6,   8,  11,  14,  16,  19,  21,  24,  26,  29},
+        {  9,  11,  14,  16,  19,  22,  24,  27,  29,  32,  34},
+        { 14,  17,  19,  22,  24,  27,  30,  32,  35,  37,  40},
+        { 20,  22,  25,  27,  30,  32,  35,  37,  40,  43,  45},
+        { 25,  28,  30,  33,  35,  38,  40,  43,  45,  48,  51},
+        { 30,  33,  36,  38,  41,  43,  46,  48,  51,  53,  56},
+        { 36,  38,  41,  44,  46,  49,  51,  54,  56,  59,  61},
+        { 41,  44,  46,  49,  51,  54,  57,  59,  62,  64,  67},
+        { 47,  49,  52,  54,  57,  59,  62,  65,  67,  70,  72},
+        { 52,  55,  57,  60,  62,  65,  67,  70,  73,  75,  78},
+        { 58,  60,  63,  65,  68,  70,  73,  75,  78,  81,  83},
+        { 63,  66,  68,  71,  73,  76,  78,  81,  83,  86,  88},
+        { 68,  71,  73,  76,  79,  81,  84,  86,  89,  91,  94},
+        { 74,  76,  79,  81,  84,  87,  89,  92,  94,  97,  99},
+        { 79,  82,  84,  87,  89,  92,  95,  97, 100, 100, 100},
+        { 84,  87,  90,  92,  95,  97, 100, 100, 100, 100, 100},
+        { 89,  91,  94,  96,  99, 100, 100, 100, 100, 100, 100},
+        { 94,  96,  99, 100, 100, 100, 100, 100, 100, 100, 100},
+        { 99, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   1,   4,   6,   9,  11,  14,  16},
+        {  0,   0,   1,   4,   7,   9,  12,  14,  17,  19,  22},
+        {  1,   4,   7,   9,  12,  14,  17,  19,  22,  24,  27},
+        {  7,   9,  12,  15,  17,  20,  22,  25,  27,  30,  32},
+        { 12,  15,  17,  20,  23,  25,  28,  30,  33,  35,  38},
+        { 18,  20,  23,  25,  28,  30,  33,  36,  38,  41,  43},
+        { 23,  26,  28,  31,  33,  36,  38,  41,  44,  46,  49},
+        { 29,  31,  34,  36,  39,  41,  44,  46,  49,  52,  54},
+        { 34,  37,  39,  42,  44,  47,  49,  52,  54,  57,  60},
+        { 39,  42,  45,  47,  50,  52,  55,  57,  60,  62,  65},
+        { 45,  47,  50,  52,  55,  58,  60,  63,  65,  68,  70},
+        { 50,  53,  55,  58,  60,  63,  66,  68,  71,  73,  76},
+        { 56,  58,  61,  63,  66,  68,  71,  74,  76,  79,  81},
+        { 61,  64,  66,  69,  71,  74,  76,  79,  82,  84,  87},
+        { 67,  69,  72,  74,  77,  79,  82,  84,  87,  89,  92},
+        { 72,  74,  77,  80,  82,  85,  87,  90,  92,  95,  97},
+        { 77,  80,  82,  85,  88,  90,  93,  95,  98, 100, 100},
+        { 83,  85,  88,  90,  93,  96,  98, 100, 100, 100, 100},
+        { 87,  90,  92,  95,  97, 100, 100, 100, 100, 100, 100},
+        { 92,  95,  97, 100, 100, 100, 100, 100, 100, 100, 100},
+        { 97, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   2,   4,   7,   9,  12,  14},
+        {  0,   0,   0,   2,   5,   7,  10,  12,  15,  17,  20},
+        {  0,   2,   5,   7,  10,  12,  15,  17,  20,  23,  25},
+        {  5,   8,  10,  13,  15,  18,  20,  23,  25,  28,  31},
+        { 10,  13,  16,  18,  21,  23,  26,  28,  31,  33,  36},
+        { 16,  18,  21,  24,  26,  29,  31,  34,  36,  39,  41},
+        { 21,  24,  26,  29,  31,  34,  37,  39,  42,  44,  47},
+        { 27,  29,  32,  34,  37,  39,  42,  45,  47,  50,  52},
+        { 32,  35,  37,  40,  42,  45,  47,  50,  53,  55,  58},
+        { 38,  40,  43,  45,  48,  50,  53,  55,  58,  61,  63},
+        { 43,  46,  48,  51,  53,  56,  58,  61,  63,  66,  68},
+        { 48,  51,  53,  56,  59,  61,  64,  66,  69,  71,  74},
+        { 54,  56,  59,  61,  64,  67,  69,  72,  74,  77,  79},
+        { 59,  62,  64,  67,  69,  72,  75,  77,  80,  82,  85},
+        { 65,  67,  70,  72,  75,  77,  80,  83,  85,  88,  90},
+        { 70,  73,  75,  78,  80,  83,  85,  88,  90,  93,  96},
+        { 75,  78,  81,  83,  86,  88,  91,  93,  96,  98, 100},
+        { 81,  83,  86,  89,  91,  94,  96,  99, 100, 100, 100},
+        { 85,  88,  91,  93,  96,  98, 100, 100, 100, 100, 100},
+        { 90,  93,  95,  98, 100, 100, 100, 100, 100, 100, 100},
+        { 96,  98, 100, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   3,   5,   8,  10,  13},
+        {  0,   0,   0,   1,   3,   6,   8,  11,  13,  16,  18},
+        {  0,   0,   3,   5,   8,  10,  13,  16,  18,  21,  23},
+        {  3,   6,   8,  11,  13,  16,  18,  21,  24,  26,  29},
+        {  9,  11,  14,  16,  19,  21,  24,  26,  29,  32,  34},
+        { 14,  17,  19,  22,  24,  27,  29,  32,  34,  37,  40},
+        { 19,  22,  25,  27,  30,  32,  35,  37,  40,  42,  45},
+        { 25,  27,  30,  32,  35,  38,  40,  43,  45,  48,  50},
+        { 30,  33,  35,  38,  40,  43,  46,  48,  51,  53,  56},
+        { 36,  38,  41,  43,  46,  48,  51,  54,  56,  59,  61},
+        { 41,  44,  46,  49,  51,  54,  56,  59,  62,  64,  67},
+        { 46,  49,  52,  54,  57,  59,  62,  64,  67,  69,  72},
+        { 52,  54,  57,  60,  62,  65,  67,  70,  72,  75,  77},
+        { 57,  60,  62,  65,  68,  70,  73,  75,  78,  80,  83},
+        { 63,  65,  68,  70,  73,  76,  78,  81,  83,  86,  88},
+        { 68,  71,  73,  76,  78,  81,  83,  86,  89,  91,  94},
+        { 74,  76,  79,  81,  84,  86,  89,  91,  94,  97,  99},
+        { 79,  82,  84,  87,  89,  92,  94,  97,  99, 100, 100},
+        { 84,  86,  89,  92,  94,  97,  99, 100, 100, 100, 100},
+        { 89,  91,  94,  96,  99, 100, 100, 100, 100, 100, 100},
+        { 94,  96,  99, 100, 100, 100, 100, 100, 100, 100, 100},
+        {100, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   1,   3,   6,   8,  11},
+        {  0,   0,   0,   0,   1,   4,   6,   9,  11,  14,  16},
+        {  0,   0,   1,   4,   6,   9,  11,  14,  16,  19,  21},
+        {  1,   4,   6,   9,  11,  14,  17,  19,  22,  24,  27},
+        {  7,   9,  12,  14,  17,  19,  22,  25,  27,  30,  32},
+        { 12,  15,  17,  20,  22,  25,  27,  30,  33,  35,  38},
+        { 18,  20,  23,  25,  28,  30,  33,  35,  38,  41,  43},
+        { 23,  26,  28,  31,  33,  36,  38,  41,  43,  46,  48},
+        { 28,  31,  33,  36,  39,  41,  44,  46,  49,  51,  54},
+        { 34,  36,  39,  41,  44,  47,  49,  52,  54,  57,  59},
+        { 39,  42,  44,  47,  49,  52,  55,  57,  60,  62,  65},
+        { 45,  47,  50,  52,  55,  57,  60,  62,  65,  68,  70},
+        { 50,  53,  55,  58,  60,  63,  65,  68,  70,  73,  76},
+        { 55,  58,  61,  63,  66,  68,  71,  73,  76,  78,  81},
+        { 61,  63,  66,  69,  71,  74,  76,  79,  81,  84,  86},
+        { 66,  69,  71,  74,  77,  79,  82,  84,  87,  89,  92},
+        { 72,  74,  77,  79,  82,  84,  87,  90,  92,  95,  97},
+        { 77,  80,  82,  85,  87,  90,  92,  95,  98, 100, 100},
+        { 82,  85,  87,  90,  93,  95,  98, 100, 100, 100, 100},
+        { 87,  90,  92,  95,  97, 100, 100, 100, 100, 100, 100},
+        { 92,  95,  97, 100, 100, 100, 100, 100, 100, 100, 100},
+        { 98, 100, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   2,   4,   7,   9},
+        {  0,   0,   0,   0,   0,   2,   5,   7,  10,  12,  15},
+        {  0,   0,   0,   2,   4,   7,  10,  12,  15,  17,  20},
+        {  0,   2,   5,   7,  10,  12,  15,  17,  20,  22,  25},
+        {  5,   7,  10,  12,  15,  18,  20,  23,  25,  28,  30},
+        { 10,  13,  15,  18,  20,  23,  26,  28,  31,  33,  36},
+        { 16,  18,  21,  23,  26,  28,  31,  34,  36,  39,  41},
+        { 21,  24,  26,  29,  31,  34,  36,  39,  42,  44,  47},
+        { 26,  29,  32,  34,  37,  39,  42,  44,  47,  49,  52},
+        { 32,  34,  37,  40,  42,  45,  47,  50,  52,  55,  57},
+        { 37,  40,  42,  45,  48,  50,  53,  55,  58,  60,  63},
+        { 43,  45,  48,  50,  53,  56,  58,  61,  63,  66,  68},
+        { 48,  51,  53,  56,  58,  61,  63,  66,  69,  71,  74},
+        { 54,  56,  59,  61,  64,  66,  69,  71,  74,  77,  79},
+        { 59,  62,  64,  67,  69,  72,  74,  77,  79,  82,  85},
+        { 64,  67,  70,  72,  75,  77,  80,  82,  85,  87,  90},
+        { 70,  72,  75,  78,  80,  83,  85,  88,  90,  93,  95},
+        { 75,  78,  80,  83,  85,  88,  91,  93,  96,  98, 100},
+        { 81,  83,  86,  88,  91,  93,  96,  99, 100, 100, 100},
+        { 85,  88,  90,  93,  95,  98, 100, 100, 100, 100, 100},
+        { 90,  93,  95,  98, 100, 100, 100, 100, 100, 100, 100},
+        { 96,  99, 100, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   2,   5,   7},
+        {  0,   0,   0,   0,   0,   1,   3,   6,   8,  10,  13},
+        {  0,   0,   0,   0,   3,   5,   8,  11,  13,  16,  18},
+        {  0,   0,   3,   5,   8,  10,  13,  15,  18,  21,  23},
+        {  3,   5,   8,  11,  13,  16,  18,  21,  23,  26,  28},
+        {  8,  11,  13,  16,  19,  21,  24,  26,  29,  31,  34},
+        { 14,  16,  19,  21,  24,  27,  29,  32,  34,  37,  39},
+        { 19,  22,  24,  27,  29,  32,  35,  37,  40,  42,  45},
+        { 25,  27,  30,  32,  35,  37,  40,  42,  45,  48,  50},
+        { 30,  33,  35,  38,  40,  43,  45,  48,  50,  53,  56},
+        { 35,  38,  41,  43,  46,  48,  51,  53,  56,  58,  61},
+        { 41,  43,  46,  49,  51,  54,  56,  59,  61,  64,  66},
+        { 46,  49,  51,  54,  57,  59,  62,  64,  67,  69,  72},
+        { 52,  54,  57,  59,  62,  64,  67,  70,  72,  75,  77},
+        { 57,  60,  62,  65,  67,  70,  72,  75,  78,  80,  83},
+        { 63,  65,  68,  70,  73,  75,  78,  80,  83,  86,  88},
+        { 68,  71,  73,  76,  78,  81,  83,  86,  88,  91,  94},
+        { 73,  76,  78,  81,  84,  86,  89,  91,  94,  96,  99},
+        { 79,  81,  84,  86,  89,  92,  94,  97,  99, 100, 100},
+        { 84,  86,  89,  91,  94,  96,  99, 100, 100, 100, 100},
+        { 89,  91,  94,  96,  99, 100, 100, 100, 100, 100, 100},
+        { 94,  97,  99, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   1,   3,   6},
+        {  0,   0,   0,   0,   0,   0,   1,   4,   6,   9,  11},
+        {  0,   0,   0,   0,   1,   4,   6,   9,  11,  14,  16},
+        {  0,   0,   1,   3,   6,   8,  11,  14,  16,  19,  21},
+        {  1,   4,   6,   9,  11,  14,  16,  19,  22,  24,  27},
+        {  6,   9,  12,  14,  17,  19,  22,  24,  27,  29,  32},
+        { 12,  14,  17,  20,  22,  25,  27,  30,  32,  35,  37},
+        { 17,  20,  22,  25,  28,  30,  33,  35,  38,  40,  43},
+        { 23,  25,  28,  30,  33,  36,  38,  41,  43,  46,  48},
+        { 28,  31,  33,  36,  38,  41,  43,  46,  49,  51,  54},
+        { 34,  36,  39,  41,  44,  46,  49,  51,  54,  57,  59},
+        { 39,  42,  44,  47,  49,  52,  54,  57,  59,  62,  65},
+        { 44,  47,  50,  52,  55,  57,  60,  62,  65,  67,  70},
+        { 50,  52,  55,  58,  60,  63,  65,  68,  70,  73,  75},
+        { 55,  58,  60,  63,  65,  68,  71,  73,  76,  78,  81},
+        { 61,  63,  66,  68,  71,  73,  76,  79,  81,  84,  86},
+        { 66,  69,  71,  74,  76,  79,  81,  84,  87,  89,  92},
+        { 72,  74,  77,  79,  82,  84,  87,  89,  92,  95,  97},
+        { 77,  79,  82,  85,  87,  90,  92,  95,  97, 100, 100},
+        { 82,  84,  87,  89,  92,  95,  97, 100, 100, 100, 100},
+        { 87,  90,  92,  94,  97,  99, 100, 100, 100, 100, 100},
+        { 93,  95,  98, 100, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   4},
+        {  0,   0,   0,   0,   0,   0,   0,   2,   5,   7,  10},
+        {  0,   0,   0,   0,   0,   2,   5,   7,  10,  12,  15},
+        {  0,   0,   0,   1,   4,   7,   9,  12,  14,  17,  19},
+        {  0,   2,   4,   7,   9,  12,  15,  17,  20,  22,  25},
+        {  5,   7,  10,  12,  15,  17,  20,  22,  25,  28,  30},
+        { 10,  13,  15,  18,  20,  23,  25,  28,  30,  33,  36},
+        { 15,  18,  21,  23,  26,  28,  31,  33,  36,  38,  41},
+        { 21,  23,  26,  29,  31,  34,  36,  39,  41,  44,  46},
+        { 26,  29,  31,  34,  37,  39,  42,  44,  47,  49,  52},
+        { 32,  34,  37,  39,  42,  44,  47,  50,  52,  55,  57},
+        { 37,  40,  42,  45,  47,  50,  52,  55,  58,  60,  63},
+        { 43,  45,  48,  50,  53,  55,  58,  60,  63,  66,  68},
+        { 48,  51,  53,  56,  58,  61,  63,  66,  68,  71,  74},
+        { 53,  56,  58,  61,  64,  66,  69,  71,  74,  76,  79},
+        { 59,  61,  64,  66,  69,  72,  74,  77,  79,  82,  84},
+        { 64,  67,  69,  72,  74,  77,  80,  82,  85,  87,  90},
+        { 70,  72,  75,  77,  80,  82,  85,  88,  90,  93,  95},
+        { 75,  78,  80,  83,  85,  88,  90,  93,  95,  98, 100},
+        { 80,  83,  85,  88,  90,  93,  96,  98, 100, 100, 100},
+        { 85,  88,  90,  93,  95,  98, 100, 100, 100, 100, 100},
+        { 91,  93,  96,  98, 100, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   2},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   3,   5,   8},
+        {  0,   0,   0,   0,   0,   0,   3,   5,   8,  10,  13},
+        {  0,   0,   0,   0,   2,   5,   7,  10,  13,  15,  18},
+        {  0,   0,   2,   5,   8,  10,  13,  15,  18,  20,  23},
+        {  3,   5,   8,  10,  13,  16,  18,  21,  23,  26,  28},
+        {  8,  11,  13,  16,  18,  21,  23,  26,  29,  31,  34},
+        { 14,  16,  19,  21,  24,  26,  29,  31,  34,  37,  39},
+        { 19,  22,  24,  27,  29,  32,  34,  37,  39,  42,  45},
+        { 24,  27,  30,  32,  35,  37,  40,  42,  45,  47,  50},
+        { 30,  32,  35,  38,  40,  43,  45,  48,  50,  53,  55},
+        { 35,  38,  40,  43,  45,  48,  51,  53,  56,  58,  61},
+        { 41,  43,  46,  48,  51,  53,  56,  59,  61,  64,  66},
+        { 46,  49,  51,  54,  56,  59,  61,  64,  67,  69,  72},
+        { 52,  54,  57,  59,  62,  64,  67,  69,  72,  74,  77},
+        { 57,  59,  62,  65,  67,  70,  72,  75,  77,  80,  82},
+        { 62,  65,  67,  70,  73,  75,  78,  80,  83,  85,  88},
+        { 68,  70,  73,  75,  78,  81,  83,  86,  88,  91,  93},
+        { 73,  76,  78,  81,  83,  86,  89,  91,  94,  96,  99},
+        { 79,  81,  84,  86,  89,  91,  94,  96,  99, 100, 100},
+        { 84,  86,  89,  91,  94,  96,  99, 100, 100, 100, 100},
+        { 89,  92,  94,  97,  99, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   1,   4,   6},
+        {  0,   0,   0,   0,   0,   0,   1,   4,   6,   9,  11},
+        {  0,   0,   0,   0,   1,   3,   6,   8,  11,  14,  16},
+        {  0,   0,   1,   3,   6,   8,  11,  13,  16,  18,  21},
+        {  1,   3,   6,   9,  11,  14,  16,  19,  21,  24,  26},
+        {  6,   9,  11,  14,  17,  19,  22,  24,  27,  29,  32},
+        { 12,  14,  17,  19,  22,  24,  27,  30,  32,  35,  37},
+        { 17,  20,  22,  25,  27,  30,  32,  35,  38,  40,  43},
+        { 23,  25,  28,  30,  33,  35,  38,  40,  43,  46,  48},
+        { 28,  31,  33,  36,  38,  41,  43,  46,  48,  51,  54},
+        { 33,  36,  38,  41,  44,  46,  49,  51,  54,  56,  59},
+        { 39,  41,  44,  46,  49,  52,  54,  57,  59,  62,  64},
+        { 44,  47,  49,  52,  54,  57,  60,  62,  65,  67,  70},
+        { 50,  52,  55,  57,  60,  62,  65,  68,  70,  73,  75},
+        { 55,  58,  60,  63,  65,  68,  70,  73,  75,  78,  81},
+        { 60,  63,  66,  68,  71,  73,  76,  78,  81,  83,  86},
+        { 66,  68,  71,  74,  76,  79,  81,  84,  86,  89,  91},
+        { 71,  74,  76,  79,  82,  84,  87,  89,  92,  94,  97},
+        { 77,  79,  82,  84,  87,  90,  92,  95,  97, 100, 100},
+        { 82,  84,  87,  89,  92,  94,  97,  99, 100, 100, 100},
+        { 87,  90,  92,  95,  97, 100, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   2,   4},
+        {  0,   0,   0,   0,   0,   0,   0,   2,   5,   7,  10},
+        {  0,   0,   0,   0,   0,   2,   4,   7,   9,  12,  15},
+        {  0,   0,   0,   1,   4,   6,   9,  11,  14,  17,  19},
+        {  0,   2,   4,   7,   9,  12,  14,  17,  19,  22,  25},
+        {  4,   7,  10,  12,  15,  17,  20,  22,  25,  27,  30},
+        { 10,  12,  15,  17,  20,  23,  25,  28,  30,  33,  35},
+        { 15,  18,  20,  23,  25,  28,  31,  33,  36,  38,  41},
+        { 21,  23,  26,  28,  31,  33,  36,  39,  41,  44,  46},
+        { 26,  29,  31,  34,  36,  39,  41,  44,  47,  49,  52},
+        { 32,  34,  37,  39,  42,  44,  47,  49,  52,  54,  57},
+        { 37,  39,  42,  45,  47,  50,  52,  55,  57,  60,  62},
+        { 42,  45,  47,  50,  53,  55,  58,  60,  63,  65,  68},
+        { 48,  50,  53,  55,  58,  61,  63,  66,  68,  71,  73},
+        { 53,  56,  58,  61,  63,  66,  69,  71,  74,  76,  79},
+        { 59,  61,  64,  66,  69,  71,  74,  76,  79,  82,  84},
+        { 64,  67,  69,  72,  74,  77,  79,  82,  84,  87,  90},
+        { 69,  72,  75,  77,  80,  82,  85,  87,  90,  92,  95},
+        { 75,  77,  80,  83,  85,  88,  90,  93,  95,  98, 100},
+        { 80,  83,  85,  88,  90,  93,  95,  98, 100, 100, 100},
+        { 86,  88,  91,  93,  96,  98, 100, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   3},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   3,   5,   8},
+        {  0,   0,   0,   0,   0,   0,   3,   5,   8,  10,  13},
+        {  0,   0,   0,   0,   2,   4,   7,  10,  12,  15,  17},
+        {  0,   0,   2,   5,   7,  10,  12,  15,  18,  20,  23},
+        {  3,   5,   8,  10,  13,  15,  18,  20,  23,  26,  28},
+        {  8,  11,  13,  16,  18,  21,  23,  26,  28,  31,  33},
+        { 13,  16,  18,  21,  24,  26,  29,  31,  34,  36,  39},
+        { 19,  21,  24,  26,  29,  32,  34,  37,  39,  42,  44},
+        { 24,  27,  29,  32,  34,  37,  40,  42,  45,  47,  50},
+        { 30,  32,  35,  37,  40,  42,  45,  48,  50,  53,  55},
+        { 35,  38,  40,  43,  45,  48,  50,  53,  55,  58,  61},
+        { 40,  43,  46,  48,  51,  53,  56,  58,  61,  63,  66},
+        { 46,  48,  51,  54,  56,  59,  61,  64,  66,  69,  71},
+        { 51,  54,  56,  59,  62,  64,  67,  69,  72,  74,  77},
+        { 57,  59,  62,  64,  67,  70,  72,  75,  77,  80,  82},
+        { 62,  65,  67,  70,  72,  75,  77,  80,  83,  85,  88},
+        { 68,  70,  73,  75,  78,  80,  83,  85,  88,  91,  93},
+        { 73,  76,  78,  81,  83,  86,  88,  91,  93,  96,  99},
+        { 78,  81,  83,  86,  88,  91,  93,  96,  99, 100, 100},
+        { 84,  86,  89,  91,  94,  96,  99, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   1,   4,   6},
+        {  0,   0,   0,   0,   0,   0,   1,   4,   6,   9,  11},
+        {  0,   0,   0,   0,   0,   3,   5,   8,  10,  13,  16},
+        {  0,   0,   0,   3,   5,   8,  11,  13,  16,  18,  21},
+        {  1,   3,   6,   8,  11,  13,  16,  19,  21,  24,  26},
+        {  6,   9,  11,  14,  16,  19,  21,  24,  27,  29,  32},
+        { 12,  14,  17,  19,  22,  24,  27,  29,  32,  34,  37},
+        { 17,  19,  22,  25,  27,  30,  32,  35,  37,  40,  42},
+        { 22,  25,  27,  30,  33,  35,  38,  40,  43,  45,  48},
+        { 28,  30,  33,  35,  38,  41,  43,  46,  48,  51,  53},
+        { 33,  36,  38,  41,  43,  46,  49,  51,  54,  56,  59},
+        { 39,  41,  44,  46,  49,  51,  54,  56,  59,  62,  64},
+        { 44,  47,  49,  52,  54,  57,  59,  62,  64,  67,  70},
+        { 49,  52,  55,  57,  60,  62,  65,  67,  70,  72,  75},
+        { 55,  57,  60,  63,  65,  68,  70,  73,  75,  78,  80},
+        { 60,  63,  65,  68,  70,  73,  76,  78,  81,  83,  86},
+        { 66,  68,  71,  73,  76,  78,  81,  84,  86,  89,  91},
+        { 71,  74,  76,  79,  81,  84,  86,  89,  92,  94,  97},
+        { 77,  79,  82,  84,  87,  89,  92,  94,  97, 100, 100},
+        { 82,  85,  87,  90,  92,  95,  97, 100, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   2,   5},
+        {  0,   0,   0,   0,   0,   0,   0,   2,   4,   7,   9},
+        {  0,   0,   0,   0,   0,   1,   4,   6,   9,  11,  14},
+        {  0,   0,   0,   1,   4,   6,   9,  11,  14,  16,  19},
+        {  0,   1,   4,   6,   9,  12,  14,  17,  19,  22,  24},
+        {  4,   7,   9,  12,  14,  17,  20,  22,  25,  27,  30},
+        { 10,  12,  15,  17,  20,  22,  25,  28,  30,  33,  35},
+        { 15,  18,  20,  23,  25,  28,  30,  33,  35,  38,  41},
+        { 20,  23,  26,  28,  31,  33,  36,  38,  41,  43,  46},
+        { 26,  28,  31,  34,  36,  39,  41,  44,  46,  49,  51},
+        { 31,  34,  36,  39,  42,  44,  47,  49,  52,  54,  57},
+        { 37,  39,  42,  44,  47,  49,  52,  55,  57,  60,  62},
+        { 42,  45,  47,  50,  52,  55,  57,  60,  63,  65,  68},
+        { 48,  50,  53,  55,  58,  60,  63,  65,  68,  71,  73},
+        { 53,  56,  58,  61,  63,  66,  68,  71,  73,  76,  79},
+        { 58,  61,  64,  66,  69,  71,  74,  76,  79,  81,  84},
+        { 64,  66,  69,  71,  74,  77,  79,  82,  84,  87,  89},
+        { 69,  72,  74,  77,  79,  82,  85,  87,  90,  92,  95},
+        { 75,  77,  80,  82,  85,  87,  90,  93,  95,  98, 100},
+        { 81,  83,  85,  88,  90,  93,  95,  98, 100, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   3},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   3,   5,   8},
+        {  0,   0,   0,   0,   0,   0,   2,   5,   7,  10,  12},
+        {  0,   0,   0,   0,   2,   4,   7,   9,  12,  14,  17},
+        {  0,   0,   2,   5,   7,  10,  12,  15,  17,  20,  22},
+        {  2,   5,   7,  10,  13,  15,  18,  20,  23,  25,  28},
+        {  8,  10,  13,  15,  18,  21,  23,  26,  28,  31,  33},
+        { 13,  16,  18,  21,  23,  26,  29,  31,  34,  36,  39},
+        { 19,  21,  24,  26,  29,  31,  34,  36,  39,  42,  44},
+        { 24,  27,  29,  32,  34,  37,  39,  42,  44,  47,  50},
+        { 29,  32,  35,  37,  40,  42,  45,  47,  50,  52,  55},
+        { 35,  37,  40,  43,  45,  48,  50,  53,  55,  58,  60},
+        { 40,  43,  45,  48,  50,  53,  56,  58,  61,  63,  66},
+        { 46,  48,  51,  53,  56,  58,  61,  64,  66,  69,  71},
+        { 51,  54,  56,  59,  61,  64,  66,  69,  72,  74,  77},
+        { 57,  59,  62,  64,  67,  69,  72,  74,  77,  80,  82},
+        { 62,  65,  67,  70,  72,  75,  77,  80,  82,  85,  87},
+        { 67,  70,  72,  75,  78,  80,  83,  85,  88,  90,  93},
+        { 73,  76,  78,  81,  83,  86,  88,  91,  93,  96,  98},
+        { 79,  81,  84,  86,  89,  91,  94,  96,  99, 100, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   1,   4,   6},
+        {  0,   0,   0,   0,   0,   0,   0,   3,   6,   8,  11},
+        {  0,   0,   0,   0,   0,   2,   5,   8,  10,  13,  15},
+        {  0,   0,   0,   3,   5,   8,  10,  13,  15,  18,  21},
+        {  0,   3,   6,   8,  11,  13,  16,  18,  21,  23,  26},
+        {  6,   8,  11,  14,  16,  19,  21,  24,  26,  29,  31},
+        { 11,  14,  16,  19,  22,  24,  27,  29,  32,  34,  37},
+        { 17,  19,  22,  24,  27,  29,  32,  35,  37,  40,  42},
+        { 22,  25,  27,  30,  32,  35,  37,  40,  43,  45,  48},
+        { 28,  30,  33,  35,  38,  40,  43,  45,  48,  51,  53},
+        { 33,  36,  38,  41,  43,  46,  48,  51,  53,  56,  59},
+        { 38,  41,  44,  46,  49,  51,  54,  56,  59,  61,  64},
+        { 44,  46,  49,  51,  54,  57,  59,  62,  64,  67,  69},
+        { 49,  52,  54,  57,  59,  62,  65,  67,  70,  72,  75},
+        { 55,  57,  60,  62,  65,  67,  70,  73,  75,  78,  80},
+        { 60,  63,  65,  68,  70,  73,  75,  78,  81,  83,  86},
+        { 65,  68,  71,  73,  76,  78,  81,  83,  86,  88,  91},
+        { 71,  74,  76,  79,  81,  84,  86,  89,  91,  94,  96},
+        { 77,  80,  82,  84,  87,  89,  92,  94,  97,  99, 100}
+    },
+    {
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0},
+        {  0,   0,   0,   0,   0,   0,   0,   0,   0,   2,   4},
+        {  0,   0,   0,   0,   0,   0,   0,   1,   4,   7,   9},
+        {  0,   0,   0,   0,   0,   1,   3,   6,   8,  11,  14},
+        {  0,   0,   0,   1,   3,   6,   9,  11,  14,  16,  19},
+        {  0,   1,   4,   6,   9,  11,  14,  16,  19,  22,  24},
+        {  4,   7,   9,  12,  14,  17,  19,  22,  24,  27,  30},
+        {  9,  12,  15,  17,  20,  22,  25,  27,  30,  32,  35},
+        { 15,  17,  20,  23,  25,  28,  30,  33,  35,  38,  40},
+        { 20,  23,  25,  28,  30,  33,  36,  38,  41,  43,  46},
+        { 26,  28,  31,  33,  36,  38,  41,  44,  46,  49,  51},
+        { 31,  34,  36,  39,  41,  44,  46,  49,  52,  54,  57},
+        { 37,  39,  42,  44,  47,  49,  52,  54,  57,  60,  62},
+        { 42,  45,  47,  50,  52,  55,  57,  60,  62,  65,  67},
+        { 47,  50,  52,  55,  58,  60,  63,  65,  68,  70,  73},
+        { 53,  55,  58,  60,  63,  66,  68,  71,  73,  76,  78},
+        { 58,  61,  63,  66,  68,  71,  74,  76,  79,  81,  84},
+        { 64,  66,  69,  71,  74,  76,  79,  82,  84,  87,  89},
+        { 69,  72,  74,  77,  79,  82,  84,  87,  89,  92,  95},
+        { 75,  78,  80,  83,  85,  88,  90,  93,  95,  98, 100}
+    }
+};
@@ -0,0 +1,669 @@
+/*
+*  param_func.c
+*  parameter registry functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO TUNE PARAMETERS WHILE RUNNING    */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "param_func.h"
+
+#ifdef FAN_LINUX
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// Including other necessary custom headers
+#include "shared_func.h"
+#include "persist_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Address of the JTAG UART used as the console on the board
+#ifndef ALT_LWFPGA_JTAG_UART_BASE
+#define ALT_LWFPGA_JTAG_UART_BASE 0xFF201000
+#endif
+
+/*
+* One tunable parameter: the variable it is applied to, the path that
+* uses it and the values it may take.
+*/
+
+struct ParamDef
+{
+    const char *Name;       // Name used on the console
+    int Type;               // ParamInteger or ParamReal
+    int Path;               // ParamControl or ParamUi
+    void *Live;             // Variable the value is applied to
+    float Min;              // Smallest value allowed
+    float Max;              // Largest value allowed
+};
+
+/*
+* Value of a parameter, stored in one int so that the whole set can be
+* shared through a sequence lock.
+*/
+
+union ParamValue
+{
+    int Integer;
+    float Real;
+};
+
+static const struct ParamDef Params[] =
+{
+    {"kp", ParamReal, ParamControl, &Kp, 0, 1},
+    {"ki", ParamReal, ParamControl, &Ki, 0, 0.001f},
+    {"kd", ParamReal, ParamControl, &Kd, 0, 10},
+    {"max_rps", ParamInteger, ParamControl, &MaxRPS, 1, 500},
+    {"encoder_step", ParamInteger, ParamControl, &EncoderStep, 1, 10},
+    {"freq0", ParamInteger, ParamUi, &FreqChoices[0], 1, 10000},
+    {"freq1", ParamInteger, ParamUi, &FreqChoices[1], 1, 10000},
+    {"freq2", ParamInteger, ParamUi, &FreqChoices[2], 1, 10000},
+    {"freq3", ParamInteger, ParamUi, &FreqChoices[3], 1, 10000},
+    {"freq4", ParamInteger, ParamUi, &FreqChoices[4], 1, 10000},
+    {"freq5", ParamInteger, ParamUi, &FreqChoices[5], 1, 10000},
+    {"resp0", ParamInteger, ParamUi, &RespChoices[0], 1, 50},
+    {"resp1", ParamInteger, ParamUi, &RespChoices[1], 1, 50},
+    {"resp2", ParamInteger, ParamUi, &RespChoices[2], 1, 50},
+    {"resp3", ParamInteger, ParamUi, &RespChoices[3], 1, 50},
+    {"resp4", ParamInteger, ParamUi, &RespChoices[4], 1, 50},
+};
+
+#define ParamCount ((int)(sizeof(Params)/sizeof(Params[0])))
+
+// The whole set must fit in one shared structure
+typedef char ParamFitsShared[(ParamCount <= SharedMaxWords) ? 1 : -1];
+
+// Each value must be one 32-bit word for ParamExport and ParamImport
+typedef char ParamValueWord[(sizeof(union ParamValue) == sizeof(uint32_t)) ? 1 : -1];
+
+// The whole set must fit in the warm-start snapshot (see persist_func)
+typedef char ParamFitsSnapshot[(ParamCount <= PersistMaxParams) ? 1 : -1];
+
+// Values set on the console, owned by the user interface
+static union ParamValue Staged[ParamCount];
+static int Operated[ParamCount];    // Set for a parameter once it has been set on the console
+
+// Staged values published for both paths
+static struct Shared SharedParams;      // Written by the console, read by ParamApply
+static unsigned int Published;          // Incremented after every publication
+static unsigned int Applied[2];         // Publication last applied by each path
+
+// Console state, owned by the user interface
+static int Console;                         // Set if the console is open
+static char Line[ParamLineLength];          // Console line being received
+static int Length;                          // Bytes held in Line
+static unsigned long long LastCheck;        // Time of the last console check
+#ifndef FAN_LINUX
+static char Output[ParamOutputLength];      // Console output waiting for the JTAG UART
+static int OutputHead;                      // Next free byte of Output
+static int OutputTail;                      // Next byte of Output to send
+#endif
+
+/*
+* Function: Drain
+* --------------------------------
+* On the board, moves queued console output into the JTAG UART for as
+* long as its buffer has space, without waiting for it to empty.
+*/
+
+static void Drain(void)
+{
+
+#ifndef FAN_LINUX
+    volatile int *JtagUart = (volatile int *)ALT_LWFPGA_JTAG_UART_BASE;
+
+    // Upper half of the control register: space left for writing
+    while (OutputTail != OutputHead && (*(JtagUart + 1) & 0xFFFF0000) != 0)
+    {
+        *JtagUart = Output[OutputTail];
+        OutputTail = (OutputTail + 1) % ParamOutputLength;
+    }
+#endif
+
+}
+
+/*
+* Function: Print
+* --------------------------------
+* Writes a reply to the console. On the board the reply is queued and
+* fed to the JTAG UART as its buffer empties (see Drain), so a long
+* reply such as dump comes out whole; characters that do not fit in
+* the queue are dropped rather than waited for.
+*
+* Text: The reply.
+*/
+
+static void Print(const char *Text)
+{
+
+#ifdef FAN_LINUX
+    fputs(Text, stdout);
+    fflush(stdout);
+#else
+    while (*Text != '\0' && (OutputHead + 1) % ParamOutputLength != OutputTail)
+    {
+        Output[OutputHead] = *Text;
+        OutputHead = (OutputHead + 1) % ParamOutputLength;
+        Text++;
+    }
+    Drain();
+#endif
+
+}
+
+/*
+* Function: Find
+* --------------------------------
+* Looks a parameter up by name.
+*
+* Name: The name of the parameter.
+*
+* Returns: Its index in Params, or -1 if there is none.
+*/
+
+static int Find(const char *Name)
+{
+
+    int i;
+
+    for (i = 0; i < ParamCount; i++)
+    {
+        if (strcmp(Params[i].Name, Name) == 0)
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+* Function: Format
+* --------------------------------
+* Writes the staged value of a parameter, with its bounds if asked.
+*
+* Text: The buffer to write to.
+* Size: The size of the buffer.
+* Index: The index of the parameter.
+* Bounds: Set to add the smallest and largest values allowed.
+*/
+
+static void Format(char *Text, int Size, int Index, int Bounds)
+{
+
+    const struct ParamDef *Param = &Params[Index];
+
+    if (Param->Type == ParamInteger && Bounds)
+    {
+        snprintf(Text, Size, "%s %d %d %d\n", Param->Name, Staged[Index].Integer, (int)Param->Min, (int)Param->Max);
+    }
+    else if (Param->Type == ParamInteger)
+    {
+        snprintf(Text, Size, "%s %d\n", Param->Name, Staged[Index].Integer);
+    }
+    else if (Bounds)
+    {
+        snprintf(Text, Size, "%s %g %g %g\n", Param->Name, Staged[Index].Real, Param->Min, Param->Max);
+    }
+    else
+    {
+        snprintf(Text, Size, "%s %g\n", Param->Name, Staged[Index].Real);
+    }
+
+}
+
+/*
+* Function: Publish
+* --------------------------------
+* Publishes the staged values for both paths, which apply them at the
+* start of their next pass.
+*/
+
+static void Publish(void)
+{
+
+    SharedWrite(&SharedParams, Staged, sizeof(Staged));
+    __atomic_store_n(&Published, Published + 1, __ATOMIC_RELEASE);
+
+}
+
+/*
+* Function: Stage
+* --------------------------------
+* Stages a new value of a parameter if it lies within its bounds and
+* is whole for an integer. It is applied once published.
+*
+* Index: The index of the parameter.
+* Value: The new value.
+*
+* Returns: 1 if the value was staged or 0 if it is not allowed.
+*/
+
+static int Stage(int Index, float Value)
+{
+
+    const struct ParamDef *Param = &Params[Index];
+
+    if (!(Value >= Param->Min && Value <= Param->Max) ||
+        (Param->Type == ParamInteger && Value != (float)(int)Value))
+    {
+        return 0;
+    }
+
+    if (Param->Type == ParamInteger)
+    {
+        Staged[Index].Integer = (int)Value;
+    }
+    else
+    {
+        Staged[Index].Real = Value;
+    }
+
+    return 1;
+}
+
+/*
+* Function: Command
+* --------------------------------
+* Carries out one console line:
+*
+*   get NAME          report the value of a parameter
+*   set NAME VALUE    change a parameter; the value must lie within
+*                     its bounds and be whole for an integer
+*   dump              report every parameter with its bounds
+*
+* Each command is answered with one line (one per parameter for dump),
+* or with "error".
+*
+* Text: The console line without its newline.
+*/
+
+static void Command(const char *Text)
+{
+
+    char Name[16]; // Command name
+    char Target[16]; // Parameter name
+    char Reply[64];
+    float Value; // New value
+    int Index; // Index of the parameter
+    int Fields = sscanf(Text, "%15s %15s %f", Name, Target, &Value);
+    int i;
+
+    Index = (Fields >= 2) ? Find(Target) : -1;
+
+    if (Fields == 1 && strcmp(Name, "dump") == 0)
+    {
+        for (i = 0; i < ParamCount; i++)
+        {
+            Format(Reply, sizeof(Reply), i, 1);
+            Print(Reply);
+        }
+    }
+    else if (Fields == 2 && strcmp(Name, "get") == 0 && Index >= 0)
+    {
+        Format(Reply, sizeof(Reply), Index, 0);
+        Print(Reply);
+    }
+    else if (Fields == 3 && strcmp(Name, "set") == 0 && Index >= 0 && Stage(Index, Value))
+    {
+        Operated[Index] = 1;
+        Publish();
+        Print("ok\n");
+    }
+    else if (Fields >= 1)
+    {
+        Print("error\n");
+    }
+
+}
+
+/*
+* Function: Receive
+* --------------------------------
+* Adds one character to the console line and carries out the line when
+* it is complete. A line longer than ParamLineLength is discarded.
+*
+* Character: The character received.
+*/
+
+static void Receive(char Character)
+{
+
+    if (Character == '\n')
+    {
+        if (Length < ParamLineLength)
+        {
+            Line[Length] = '\0';
+            Command(Line);
+        }
+        else
+        {
+            Print("error\n");
+        }
+        Length = 0;
+    }
+    else if (Character != '\r' && Length < ParamLineLength - 1)
+    {
+        Line[Length++] = Character;
+    }
+    else if (Character != '\r')
+    {
+        // Marking the line as too long
+        Length = ParamLineLength;
+    }
+
+}
+
+/*
+* Function: ParamStart
+* --------------------------------
+* Publishes the compiled-in values of the parameters and opens the
+* console: standard input with --console on the Linux build, or the
+* JTAG UART on the board if the build defines FAN_CONSOLE.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1 (the console cannot fail to open).
+*/
+
+int ParamStart(int argc, char **argv)
+{
+
+    int Arg;
+    int i;
+
+    for (i = 0; i < ParamCount; i++)
+    {
+        if (Params[i].Type == ParamInteger)
+        {
+            Staged[i].Integer = *(int *)Params[i].Live;
+        }
+        else
+        {
+            Staged[i].Real = *(float *)Params[i].Live;
+        }
+    }
+    SharedWrite(&SharedParams, Staged, sizeof(Staged));
+
+#ifdef FAN_LINUX
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--console") == 0)
+        {
+            Console = 1;
+        }
+    }
+#else
+    (void)Arg;
+    (void)argc;
+    (void)argv;
+#ifdef FAN_CONSOLE
+    Console = 1;
+#endif
+#endif
+
+    LastCheck = TimeNow();
+
+    return 1;
+}
+
+/*
+* Function: ParamApply
+* --------------------------------
+* Called at the start of every pass of the control path (ParamControl)
+* and of the user interface (ParamUi). If parameters have been changed
+* since the path last applied them, those it uses are copied into their
+* variables together, so a pass never sees half of a change. When
+* nothing has changed this costs one load.
+*
+* Path: ParamControl or ParamUi.
+*/
+
+void ParamApply(int Path)
+{
+
+    union ParamValue Copy[ParamCount]; // Consistent copy of the published values
+    unsigned int Version = __atomic_load_n(&Published, __ATOMIC_ACQUIRE);
+    int i;
+
+    if (Version == Applied[Path] || !SharedRead(&SharedParams, Copy, sizeof(Copy)))
+    {
+        return;
+    }
+
+    for (i = 0; i < ParamCount; i++)
+    {
+        if (Params[i].Path != Path)
+        {
+            continue;
+        }
+        // Integers such as MaxRPS are also read by the other path
+        if (Params[i].Type == ParamInteger)
+        {
+            __atomic_store_n((int *)Params[i].Live, Copy[i].Integer, __ATOMIC_RELAXED);
+        }
+        else
+        {
+            *(float *)Params[i].Live = Copy[i].Real;
+        }
+    }
+    Applied[Path] = Version;
+
+}
+
+/*
+* Function: ParamPoll
+* --------------------------------
+* Called by the user interface on every pass, so the console is never
+* handled by the control path. Once every ParamPollTicks, queued
+* output is passed on, at most ParamReadLimit characters are taken
+* from the console without waiting, and every complete line is
+* carried out.
+*/
+
+void ParamPoll(void)
+{
+
+#ifdef FAN_LINUX
+    struct pollfd Ready;
+    char Buffer[ParamReadLimit];
+    int Received;
+#else
+    volatile int *JtagUart = (volatile int *)ALT_LWFPGA_JTAG_UART_BASE;
+    int Data;
+#endif
+    int i;
+
+    if (!Console || !TimeReached(LastCheck + ParamPollTicks))
+    {
+        return;
+    }
+    LastCheck = TimeNow();
+    Drain();
+
+#ifdef FAN_LINUX
+    Ready.fd = STDIN_FILENO;
+    Ready.events = POLLIN;
+    if (poll(&Ready, 1, 0) <= 0)
+    {
+        return;
+    }
+
+    // Closing the console at the end of its input
+    Received = read(STDIN_FILENO, Buffer, sizeof(Buffer));
+    if (Received <= 0)
+    {
+        Console = 0;
+        return;
+    }
+
+    for (i = 0; i < Received; i++)
+    {
+        Receive(Buffer[i]);
+    }
+#else
+    // Bit 15 of the data register is set while a character is waiting
+    for (i = 0; i < ParamReadLimit; i++)
+    {
+        Data = *JtagUart;
+        if ((Data & 0x8000) == 0)
+        {
+            break;
+        }
+        Receive((char)(Data & 0xFF));
+    }
+#endif
+
+}
+
+/*
+* Function: ParamSet
+* --------------------------------
+* Changes a parameter as the console's set command does, for values
+* learnt while running. Called by the user interface only.
+*
+* Name: The name of the parameter.
+* Value: The new value, which must lie within its bounds.
+*
+* Returns: 1 if the value was published or 0 if it is not allowed.
+*/
+
+int ParamSet(const char *Name, float Value)
+{
+
+    int Index = Find(Name);
+
+    if (Index < 0 || !Stage(Index, Value))
+    {
+        return 0;
+    }
+    Publish();
+
+    return 1;
+}
+
+/*
+* Function: ParamOperated
+* --------------------------------
+* Tells whether a parameter has been set on the console since the
+* controller started, so that it is not overridden by a learnt value.
+*
+* Name: The name of the parameter.
+*
+* Returns: 1 if it has been set on the console or 0 if not.
+*/
+
+int ParamOperated(const char *Name)
+{
+
+    int Index = Find(Name);
+
+    return (Index >= 0) ? Operated[Index] : 0;
+}
+
+/*
+* Function: ParamLayout
+* --------------------------------
+* Works out a hash (32-bit FNV-1a) of the name and type of every
+* parameter in the order of the registry, so that values copied by
+* ParamExport are never taken back by a registry that has been
+* reordered or has had a parameter replaced.
+*
+* Returns: The hash.
+*/
+
+uint32_t ParamLayout(void)
+{
+
+    uint32_t Hash = 2166136261u;
+    const char *Name;
+    int i;
+
+    for (i = 0; i < ParamCount; i++)
+    {
+        // Hashing the terminating NUL too, so that names cannot run together
+        Name = Params[i].Name;
+        do
+        {
+            Hash = (Hash ^ (unsigned char)*Name)*16777619u;
+        } while (*Name++ != '\0');
+        Hash = (Hash ^ (unsigned char)Params[i].Type)*16777619u;
+    }
+
+    return Hash;
+}
+
+/*
+* Function: ParamExport
+* --------------------------------
+* Copies the current value of every parameter, in the order of the
+* registry, as 32-bit words (the bit pattern of a float for a real
+* parameter). Called by the user interface only.
+*
+* *Words: Pointer to the words to fill in.
+* Count: The number of words there is room for.
+*
+* Returns: The number of parameters, or 0 if they do not fit.
+*/
+
+int ParamExport(uint32_t *Words, int Count)
+{
+
+    if (Count < ParamCount)
+    {
+        return 0;
+    }
+    memcpy(Words, Staged, sizeof(Staged));
+
+    return ParamCount;
+}
+
+/*
+* Function: ParamImport
+* --------------------------------
+* Takes back every parameter copied by ParamExport, for instance before
+* a restart. Nothing is taken unless the number of parameters and the
+* layout of the registry match, and a value outside its bounds is left
+* at its current value. The values are applied by both paths at their
+* next pass.
+*
+* *Words: Pointer to the words copied by ParamExport.
+* Count: The number of words.
+* Layout: ParamLayout of the registry the words were copied from.
+*
+* Returns: 1 if the values were taken or 0 if not.
+*/
+
+int ParamImport(const uint32_t *Words, int Count, uint32_t Layout)
+{
+
+    union ParamValue Value;
+    int i;
+
+    if (Count != ParamCount || Layout != ParamLayout())
+    {
+        return 0;
+    }
+
+    for (i = 0; i < ParamCount; i++)
+    {
+        memcpy(&Value, &Words[i], sizeof(Value));
+        Stage(i, (Params[i].Type == ParamInteger) ? (float)Value.Integer : Value.Real);
+    }
+    Publish();
+
+    return 1;
+}
@@ -0,0 +1,64 @@
+/*
+*  param_func.h
+*  parameter registry functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO TUNE PARAMETERS WHILE RUNNING    */
+/* ------------------------------------------------------------------ */
+
+#ifndef PARAM_FUNC_H
+#define PARAM_FUNC_H
+
+#include <stdint.h>
+
+// Types of parameter
+#define ParamInteger 0          // Applied to an int
+#define ParamReal 1             // Applied to a float
+
+// Paths a parameter belongs to, each applying it at the start of its own pass
+#define ParamControl 0          // Used by the control path (ControlTick)
+#define ParamUi 1               // Used by the user interface (UiTick)
+
+// Console constants
+#define ParamLineLength 64          // Longest console line in bytes
+#define ParamPollTicks 50000        // Counter ticks between checks of the console (1 ms)
+#define ParamReadLimit 32           // Characters taken from the console in one check
+#define ParamOutputLength 1024      // Console output queued for the JTAG UART on the board
+
+// FUNCTION DECLARATIONS //
+
+int ParamStart(int, char **);    // Publishes the compiled-in values and opens
+                                 // the console.
+
+
+void ParamApply(int);    // Applies changed parameters of one path at the
+                         // start of its pass.
+
+
+void ParamPoll(void);    // Carries out any complete console lines, without
+                         // waiting for input.
+
+
+int ParamSet(const char *, float);    // Changes a parameter learnt while
+                                      // running.
+
+
+int ParamOperated(const char *);    // Tells whether a parameter has been set
+                                    // on the console.
+
+
+uint32_t ParamLayout(void);    // Hashes the names and types of the
+                               // parameters in the order of the registry.
+
+
+int ParamExport(uint32_t *, int);    // Copies the value of every parameter
+                                     // as 32-bit words.
+
+
+int ParamImport(const uint32_t *, int, uint32_t);    // Takes back every parameter
+                                                     // copied by ParamExport.
+
+#endif
@@ -0,0 +1,394 @@
+/*
+*  persist_func.c
+*  warm-start functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO KEEP LEARNT STATE ACROSS RESTARTS */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stddef.h>
+#include <string.h>
+#include "persist_func.h"
+
+#ifdef FAN_LINUX
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// Including other necessary custom headers
+#include "kick_func.h"
+#include "param_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Longest path of the snapshot file, with room for the temporary suffix
+#define PersistPathLength 256
+
+// Bytes covered by the checksum
+#define PersistChecked (sizeof(struct PersistSnapshot) - offsetof(struct PersistSnapshot, SustainDuty))
+
+static int Keeping;                             // Set if a snapshot file was given
+static unsigned long long LastCheck;            // Time of the last check for changed state
+static int Learning;                            // Set if max_rps is learnt (--learn-max)
+static int Full;                                // Set while the fan is driven at full on-time
+static unsigned long long FullSince;            // Time the current settling window started
+static int FullLow;                             // Lowest speed seen in the window
+static int FullHigh;                            // Highest speed seen in the window
+
+#ifdef FAN_LINUX
+static const struct PersistSnapshot *Snapshot;  // Mapped snapshot, or NULL if there is no valid one
+static char Path[PersistPathLength];            // Snapshot file
+static char Temporary[PersistPathLength];       // File the snapshot is written to before it replaces Path
+static int Warned;                              // Set once a failed write has been reported
+
+/*
+* Function: Crc32
+* --------------------------------
+* Works out the CRC-32 (as used by zip and Ethernet) of a block of
+* bytes, bit by bit; the snapshot is small and rarely checked.
+*
+* *Data: Pointer to the bytes.
+* Length: The number of bytes.
+*
+* Returns: The CRC-32.
+*/
+
+static uint32_t Crc32(const void *Data, int Length)
+{
+
+    const unsigned char *Byte = (const unsigned char *)Data;
+    uint32_t Crc = 0xFFFFFFFF;
+    int i;
+    int Bit;
+
+    for (i = 0; i < Length; i++)
+    {
+        Crc ^= Byte[i];
+        for (Bit = 0; Bit < 8; Bit++)
+        {
+            Crc = (Crc >> 1) ^ (0xEDB88320 & -(Crc & 1));
+        }
+    }
+
+    return ~Crc;
+}
+
+/*
+* Function: Fill
+* --------------------------------
+* Builds the snapshot of the current learnt state. Called by the user
+* interface only, which owns the staged parameters.
+*
+* *Image: Pointer to the snapshot to fill in.
+*/
+
+static void Fill(struct PersistSnapshot *Image)
+{
+
+    memset(Image, 0, sizeof(*Image));
+    Image->Magic = PersistMagic;
+    Image->Version = PersistVersion;
+    Image->Size = sizeof(struct PersistSnapshot);
+    // The minimum is learnt by the control path
+    Image->SustainDuty = __atomic_load_n(&KickStatsGet()->SustainDuty, __ATOMIC_RELAXED);
+    Image->ParamCount = ParamExport(Image->Params, PersistMaxParams);
+    Image->ParamLayout = ParamLayout();
+    Image->Checksum = Crc32(&Image->SustainDuty, PersistChecked);
+
+}
+
+/*
+* Function: Valid
+* --------------------------------
+* Checks that a snapshot was written by this version of the controller
+* and has not been damaged.
+*
+* *Image: Pointer to the snapshot.
+*
+* Returns: 1 if it can be used or 0 if not.
+*/
+
+static int Valid(const struct PersistSnapshot *Image)
+{
+
+    return Image->Magic == PersistMagic && Image->Version == PersistVersion &&
+           Image->Size == sizeof(struct PersistSnapshot) &&
+           Image->Checksum == Crc32(&Image->SustainDuty, PersistChecked);
+}
+
+/*
+* Function: Map
+* --------------------------------
+* Maps the snapshot file read-only, replacing any earlier mapping.
+*
+* Returns: 1 if a valid snapshot was mapped or 0 if not.
+*/
+
+static int Map(void)
+{
+
+    struct stat Status;
+    void *Mapped;
+    int Descriptor;
+
+    if (Snapshot != NULL)
+    {
+        munmap((void *)Snapshot, sizeof(struct PersistSnapshot));
+        Snapshot = NULL;
+    }
+
+    Descriptor = open(Path, O_RDONLY | O_CLOEXEC);
+    if (Descriptor < 0)
+    {
+        // Starting cold if there is no snapshot yet
+        if (errno != ENOENT)
+        {
+            perror(Path);
+        }
+        return 0;
+    }
+    if (fstat(Descriptor, &Status) != 0 || Status.st_size != sizeof(struct PersistSnapshot))
+    {
+        fprintf(stderr, "%s: not a snapshot of this version, starting cold\n", Path);
+        close(Descriptor);
+        return 0;
+    }
+
+    Mapped = mmap(NULL, sizeof(struct PersistSnapshot), PROT_READ, MAP_SHARED, Descriptor, 0);
+    close(Descriptor);
+    if (Mapped == MAP_FAILED)
+    {
+        perror(Path);
+        return 0;
+    }
+
+    if (!Valid((const struct PersistSnapshot *)Mapped))
+    {
+        fprintf(stderr, "%s: damaged or of another version, starting cold\n", Path);
+        munmap(Mapped, sizeof(struct PersistSnapshot));
+        return 0;
+    }
+    Snapshot = (const struct PersistSnapshot *)Mapped;
+
+    return 1;
+}
+
+/*
+* Function: Save
+* --------------------------------
+* Replaces the snapshot file atomically: the new snapshot is written
+* to a temporary file, flushed to the disk and renamed over the old
+* one, so a crash leaves either the old or the new snapshot whole. The
+* new file is then mapped in place of the old one.
+*
+* *Image: Pointer to the new snapshot.
+*/
+
+static void Save(const struct PersistSnapshot *Image)
+{
+
+    int Descriptor = open(Temporary, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    int Written = -1;
+
+    if (Descriptor >= 0)
+    {
+        Written = write(Descriptor, Image, sizeof(*Image));
+        Written = (fsync(Descriptor) == 0) ? Written : -1;
+        close(Descriptor);
+    }
+
+    if (Written != (int)sizeof(*Image) || rename(Temporary, Path) != 0)
+    {
+        // Reporting the first failure only, as the write is retried
+        if (!Warned)
+        {
+            perror(Temporary);
+            Warned = 1;
+        }
+        unlink(Temporary);
+        return;
+    }
+    Warned = 0;
+
+    Map();
+
+}
+#endif
+
+/*
+* Function: PersistStart
+* --------------------------------
+* On the Linux build (FAN_LINUX) maps the snapshot file given by
+* --state PATH and restores the learnt state it holds: the minimum
+* sustain duty of the start assist and every tunable parameter,
+* including max_rps if it is learnt (--learn-max), unless the registry
+* of parameters has changed since it was saved. The snapshot
+* is read in place, without parsing. A missing, damaged or outdated
+* snapshot is ignored and the controller starts cold. Called after
+* ParamStart and before the control path starts.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1, or 0 if the path is too long.
+*/
+
+int PersistStart(int argc, char **argv)
+{
+
+#ifdef FAN_LINUX
+    int Arg;
+
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--learn-max") == 0)
+        {
+            Learning = 1;
+        }
+        if (strcmp(argv[Arg], "--state") != 0 || Arg + 1 >= argc)
+        {
+            continue;
+        }
+
+        if (snprintf(Temporary, sizeof(Temporary), "%s.tmp", argv[++Arg]) >= (int)sizeof(Temporary))
+        {
+            fprintf(stderr, "%s: path too long\n", argv[Arg]);
+            return 0;
+        }
+        snprintf(Path, sizeof(Path), "%s", argv[Arg]);
+        Keeping = 1;
+    }
+
+    if (Keeping && Map())
+    {
+        KickRestore(Snapshot->SustainDuty);
+        if (!ParamImport(Snapshot->Params, Snapshot->ParamCount, Snapshot->ParamLayout))
+        {
+            fprintf(stderr, "%s: saved for other parameters, not restoring them\n", Path);
+        }
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    LastCheck = TimeNow();
+
+    return 1;
+}
+
+/*
+* Function: PersistPoll
+* --------------------------------
+* Called by the user interface on every pass. With --learn-max, once
+* the fan has been driven at full on-time and its speed has stayed
+* within PersistSettleSpread for PersistSettleTicks, that speed is
+* taken as max_rps, unless max_rps has been set on the console. While
+* a snapshot file is kept, once every PersistCheckTicks the learnt
+* state is compared with the mapped snapshot, which is rewritten if
+* anything has changed.
+*
+* OnTime: The on-time the fan is driven at (0-100).
+* RPS: The speed of the fan in RPS.
+*/
+
+void PersistPoll(int OnTime, int RPS)
+{
+
+#ifdef FAN_LINUX
+    struct PersistSnapshot Image; // Current learnt state
+#endif
+    unsigned long long Now = TimeNow();
+
+    // Learning the speed of the fan at full on-time once it has settled
+    if (!Learning || OnTime != 100 || RPS <= 0 || ParamOperated("max_rps"))
+    {
+        Full = 0;
+    }
+    else if (!Full || RPS - FullLow > PersistSettleSpread || FullHigh - RPS > PersistSettleSpread)
+    {
+        // Starting a new window while the speed is still changing
+        Full = 1;
+        FullSince = Now;
+        FullLow = RPS;
+        FullHigh = RPS;
+    }
+    else
+    {
+        FullLow = (RPS < FullLow) ? RPS : FullLow;
+        FullHigh = (RPS > FullHigh) ? RPS : FullHigh;
+        if (Now - FullSince >= PersistSettleTicks)
+        {
+            if (RPS != MaxRPS)
+            {
+                ParamSet("max_rps", RPS);
+            }
+            FullSince = Now;
+            FullLow = RPS;
+            FullHigh = RPS;
+        }
+    }
+
+    if (!Keeping)
+    {
+        return;
+    }
+
+    if (!TimeReached(LastCheck + PersistCheckTicks))
+    {
+        return;
+    }
+    LastCheck = Now;
+
+#ifdef FAN_LINUX
+    Fill(&Image);
+    if (Snapshot == NULL || memcmp(&Image, Snapshot, sizeof(Image)) != 0)
+    {
+        Save(&Image);
+    }
+#endif
+
+}
+
+/*
+* Function: PersistEnd
+* --------------------------------
+* Saves any change of the learnt state made since the last check and
+* unmaps the snapshot. Called after the control path has stopped.
+*/
+
+void PersistEnd(void)
+{
+
+#ifdef FAN_LINUX
+    struct PersistSnapshot Image; // Current learnt state
+
+    if (!Keeping)
+    {
+        return;
+    }
+
+    Fill(&Image);
+    if (Snapshot == NULL || memcmp(&Image, Snapshot, sizeof(Image)) != 0)
+    {
+        Save(&Image);
+    }
+    if (Snapshot != NULL)
+    {
+        munmap((void *)Snapshot, sizeof(struct PersistSnapshot));
+        Snapshot = NULL;
+    }
+#endif
+
+}
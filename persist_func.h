@@ -0,0 +1,64 @@
+/*
+*  persist_func.h
+*  warm-start functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO KEEP LEARNT STATE ACROSS RESTARTS */
+/* ------------------------------------------------------------------ */
+
+#ifndef PERSIST_FUNC_H
+#define PERSIST_FUNC_H
+
+#include <stdint.h>
+
+// Identification of the snapshot file
+#define PersistMagic 0x54535746         // "FWST" when read as little-endian bytes
+#define PersistVersion 2
+
+// Parameter values the snapshot has room for (see ParamExport)
+#define PersistMaxParams 16
+
+// Timing, in counter ticks
+#define PersistCheckTicks 250000000     // Time between checks for changed state (5 s)
+#define PersistSettleTicks 150000000    // Time the speed must hold at full on-time to be taken as max_rps (3 s)
+
+// Largest change of the speed (RPS) over PersistSettleTicks that counts as settled
+#define PersistSettleSpread 1
+
+/*
+* Layout of the snapshot file: fixed-size 32-bit fields in the byte
+* order of the machine that wrote it. The file is mapped and read in
+* place. Checksum is the CRC-32 of every byte after it. Any change of
+* layout takes a new version; a snapshot of another version, size or
+* checksum is ignored. ParamLayout identifies the registry the
+* parameters were saved from; they are only restored into the same one.
+*/
+
+struct PersistSnapshot
+{
+    uint32_t Magic;                         // PersistMagic
+    uint32_t Version;                       // PersistVersion
+    uint32_t Size;                          // Size of the snapshot in bytes
+    uint32_t Checksum;                      // CRC-32 of the fields below
+    int32_t SustainDuty;                    // Learnt minimum sustain duty of the start assist
+    int32_t ParamCount;                     // Parameters held in Params
+    uint32_t ParamLayout;                   // ParamLayout of the registry they were saved from
+    uint32_t Params[PersistMaxParams];      // Parameter values in the order of the registry
+};
+
+// FUNCTION DECLARATIONS //
+
+int PersistStart(int, char **);    // Maps the snapshot given on the command
+                                   // line and restores the state it holds.
+
+
+void PersistPoll(int, int);    // Learns the settled speed at full on-time and
+                               // rewrites the snapshot when the state has changed.
+
+
+void PersistEnd(void);    // Saves any last change and unmaps the snapshot.
+
+#endif
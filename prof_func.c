@@ -0,0 +1,368 @@
+/*
+*  prof_func.c
+*  profile functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO PLAY DUTY CYCLE PROFILES         */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "prof_func.h"
+
+// Including other necessary custom headers
+#include "misc_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Built-in profiles
+
+// Auto-mode: up from 0 to 100 and back down, one duty cycle every 50 ms
+static const struct ProfileStep AutoSteps[] = {
+    {ProfileRamp, 100, 500, 0},
+    {ProfileRamp, 0, 500, 0},
+};
+
+// Step response: holds at rising and falling levels for 20 s each
+static const struct ProfileStep StepSteps[] = {
+    {ProfileHold, 20, 2000, 0},
+    {ProfileHold, 50, 2000, 0},
+    {ProfileHold, 80, 2000, 0},
+    {ProfileHold, 50, 2000, 0},
+    {ProfileHold, 20, 2000, 0},
+};
+
+// Sine: 30 around 50 at periods from 20 s down to 1 s
+static const struct ProfileStep SineSteps[] = {
+    {ProfileRamp, 50, 500, 0},
+    {ProfileSine, 30, 6000, 2000},
+    {ProfileSine, 30, 3000, 1000},
+    {ProfileSine, 30, 1500, 500},
+    {ProfileSine, 30, 600, 200},
+    {ProfileSine, 30, 300, 100},
+};
+
+// PRBS: switching between 30 and 70 with a 2 s bit time for 127 bits
+static const struct ProfileStep PrbsSteps[] = {
+    {ProfileRamp, 30, 500, 0},
+    {ProfilePrbs, 70, 25400, 200},
+};
+
+static const struct Profile BuiltIn[] = {
+    {AutoSteps, 2, 1},
+    {StepSteps, 5, 1},
+    {SineSteps, 6, 1},
+    {PrbsSteps, 2, 1},
+};
+
+static const char *BuiltInNames[] = {"auto", "steps", "sine", "prbs"};
+
+static struct ProfileStep FileSteps[ProfileMaxSteps];   // Steps read from a file
+static struct Profile FileProfile = {FileSteps, 0, 0};  // Profile read from a file
+
+static const struct Profile *Selected = &BuiltIn[0];   // Profile being played
+static int Index;                   // Step being played
+static unsigned long long Elapsed;  // Time into the step (in ticks at a scale of 1)
+static unsigned long long Carry;    // Counter ticks not yet added to Elapsed
+static unsigned long long PrevTime; // Time of the previous call
+static int StartLevel;              // Duty cycle at the start of the step
+static int Restarted = 1;           // Set until the first call after a restart
+static unsigned int Lfsr;           // State of the PRBS generator
+static unsigned long long Bits;     // PRBS bits generated in the step
+
+/*
+* Function: EndLevel
+* --------------------------------
+* Works out the duty cycle a step finishes at. Holds and ramps finish
+* at their level; sines and PRBS sequences return to the level they
+* started from.
+*
+* *Step: Pointer to the step.
+* Start: The duty cycle at the start of the step.
+*
+* Returns: The duty cycle at the end of the step.
+*/
+
+static int EndLevel(const struct ProfileStep *Step, int Start)
+{
+
+    if (Step->Kind == ProfileHold || Step->Kind == ProfileRamp)
+    {
+        return Step->Level;
+    }
+
+    return Start;
+}
+
+/*
+* Function: ProfileSelect
+* --------------------------------
+* Selects the profile played in mode 1: a built-in profile ("auto",
+* "steps", "sine" or "prbs") or a profile read from a file, one step
+* per line with times in milliseconds:
+*
+*   loop                          play the profile repeatedly
+*   hold LEVEL TIME               jump to LEVEL and hold it
+*   ramp LEVEL TIME               move in a straight line to LEVEL
+*   sine AMPLITUDE TIME PERIOD    sine wave around the current level
+*   prbs LEVEL TIME BIT           pseudo-random switching between the
+*                                 current level and LEVEL
+*
+* Lines starting with # are ignored. A recorded field load can be
+* played back as a list of ramps between its samples.
+*
+* Name: Name of a built-in profile or path of a profile file.
+*
+* Returns: 1 if the profile was selected or 0 if it could not be read.
+*/
+
+int ProfileSelect(const char *Name)
+{
+
+    FILE *File;
+    char Line[128];
+    char Kind[16];
+    int Level, Time, Period;
+    int Fields;
+    int i;
+
+    for (i = 0; i < (int)(sizeof(BuiltIn)/sizeof(BuiltIn[0])); i++)
+    {
+        if (strcmp(Name, BuiltInNames[i]) == 0)
+        {
+            Selected = &BuiltIn[i];
+            ProfileRestart();
+            return 1;
+        }
+    }
+
+    File = fopen(Name, "r");
+    if (File == NULL)
+    {
+        return 0;
+    }
+
+    FileProfile.Count = 0;
+    FileProfile.Loop = 0;
+    while (fgets(Line, sizeof(Line), File) != NULL && FileProfile.Count < ProfileMaxSteps)
+    {
+        Period = 0;
+        Fields = sscanf(Line, "%15s %d %d %d", Kind, &Level, &Time, &Period);
+        if (Fields < 1 || Kind[0] == '#')
+        {
+            continue;
+        }
+        if (strcmp(Kind, "loop") == 0)
+        {
+            FileProfile.Loop = 1;
+            continue;
+        }
+        if (Fields < 3 || Level < 0 || Level > 100 || Time < 10 || Time > 655350 || Period < 0 || Period > 655350)
+        {
+            fclose(File);
+            return 0;
+        }
+
+        FileSteps[FileProfile.Count].Level = Level;
+        FileSteps[FileProfile.Count].Time = Time/10;
+        FileSteps[FileProfile.Count].Period = Period/10;
+        if (strcmp(Kind, "hold") == 0)
+        {
+            FileSteps[FileProfile.Count].Kind = ProfileHold;
+        }
+        else if (strcmp(Kind, "ramp") == 0)
+        {
+            FileSteps[FileProfile.Count].Kind = ProfileRamp;
+        }
+        else if (strcmp(Kind, "sine") == 0 && Period >= 10)
+        {
+            FileSteps[FileProfile.Count].Kind = ProfileSine;
+        }
+        else if (strcmp(Kind, "prbs") == 0 && Period >= 10)
+        {
+            FileSteps[FileProfile.Count].Kind = ProfilePrbs;
+        }
+        else
+        {
+            fclose(File);
+            return 0;
+        }
+        FileProfile.Count++;
+    }
+    fclose(File);
+
+    if (FileProfile.Count == 0)
+    {
+        return 0;
+    }
+
+    Selected = &FileProfile;
+    ProfileRestart();
+
+    return 1;
+}
+
+/*
+* Function: ProfileRestart
+* --------------------------------
+* Plays the selected profile from its first step at the next call to
+* ProfilePlay, starting from a duty cycle of 0.
+*/
+
+void ProfileRestart(void)
+{
+
+    Index = 0;
+    Elapsed = 0;
+    Carry = 0;
+    StartLevel = 0;
+    Restarted = 1;
+    Lfsr = 0x7F;
+    Bits = 0;
+
+}
+
+/*
+* Function: ProfileSeek
+* --------------------------------
+* Plays the selected profile from the first point at which it passes
+* through a duty cycle, so that auto-mode can take over a fan running
+* at that duty cycle without a jump. Ramps are searched for the exact
+* duty cycle; otherwise the profile starts from the step whose first
+* level is closest.
+*
+* DutyCycle: The duty cycle to start from (0-100).
+*/
+
+void ProfileSeek(int DutyCycle)
+{
+
+    const struct ProfileStep *Step;
+    int Start = 0; // Duty cycle at the start of the step
+    int First; // Duty cycle the step begins with
+    int Closest = 101; // Distance of the closest start found so far
+    int i;
+
+    ProfileRestart();
+
+    for (i = 0; i < Selected->Count; i++)
+    {
+        Step = &Selected->Steps[i];
+
+        // A ramp that passes through the duty cycle is entered part of the way along
+        if (Step->Kind == ProfileRamp && Step->Level != Start &&
+            (DutyCycle - Start)*(DutyCycle - Step->Level) <= 0)
+        {
+            Index = i;
+            StartLevel = Start;
+            Elapsed = (long long)Step->Time*ProfileTickTime*(DutyCycle - Start)/(Step->Level - Start);
+            return;
+        }
+
+        // Holds jump straight to their level; other steps begin where the previous one ended
+        First = (Step->Kind == ProfileHold) ? Step->Level : Start;
+        if (abs(First - DutyCycle) < Closest)
+        {
+            Closest = abs(First - DutyCycle);
+            Index = i;
+            StartLevel = Start;
+        }
+
+        Start = EndLevel(Step, Start);
+    }
+
+}
+
+/*
+* Function: ProfilePlay
+* --------------------------------
+* Gives the duty cycle of the selected profile at the current time.
+* The profile follows the time base rather than the number of loop
+* passes, so it plays at the same rate whatever the loop speed. Once a
+* profile that does not loop has finished, its last level is held.
+*
+* Scale: Factor by which the profile is slowed down (1 or more); the
+* responsiveness in mode 1.
+*
+* Returns: DutyCycle, the duty cycle of the profile (0-100).
+*/
+
+int ProfilePlay(int Scale)
+{
+
+    const struct ProfileStep *Step;
+    unsigned long long Now = TimeNow();
+    unsigned long long Length; // Length of the step in ticks
+    unsigned long long Bit; // Period of a sine or bit time of a PRBS in ticks
+    int DutyCycle;
+
+    // Time advances at 1/Scale of the counter
+    Scale = (Scale < 1) ? 1 : Scale;
+    if (!Restarted)
+    {
+        Carry += Now - PrevTime;
+        Elapsed += Carry/Scale;
+        Carry %= Scale;
+    }
+    Restarted = 0;
+    PrevTime = Now;
+
+    // Moving on to the step that holds the current time
+    Step = &Selected->Steps[Index];
+    Length = (unsigned long long)Step->Time*ProfileTickTime;
+    while (Elapsed >= Length)
+    {
+        if (Index + 1 >= Selected->Count && !Selected->Loop)
+        {
+            return EndLevel(Step, StartLevel);
+        }
+
+        Elapsed -= Length;
+        StartLevel = EndLevel(Step, StartLevel);
+        Index = (Index + 1 >= Selected->Count) ? 0 : Index + 1;
+        Lfsr = 0x7F;
+        Bits = 0;
+
+        Step = &Selected->Steps[Index];
+        Length = (unsigned long long)Step->Time*ProfileTickTime;
+    }
+
+    switch (Step->Kind)
+    {
+    case ProfileRamp:
+        DutyCycle = StartLevel + (int)(((long long)(Step->Level - StartLevel)*(long long)Elapsed)/(long long)Length);
+        break;
+    case ProfileSine:
+        Bit = (unsigned long long)Step->Period*ProfileTickTime;
+        DutyCycle = StartLevel + (Step->Level*SineLookup((unsigned int)((Elapsed%Bit)*1024/Bit)))/1000;
+        break;
+    case ProfilePrbs:
+        // One bit of the 7-bit maximal-length sequence (x^7 + x^6 + 1)
+        // per bit time
+        Bit = (unsigned long long)Step->Period*ProfileTickTime;
+        while (Bits < Elapsed/Bit)
+        {
+            Lfsr = ((Lfsr << 1) | (((Lfsr >> 6) ^ (Lfsr >> 5)) & 0x01)) & 0x7F;
+            Bits++;
+        }
+        DutyCycle = (Lfsr & 0x01) ? Step->Level : StartLevel;
+        break;
+    default:
+        DutyCycle = Step->Level;
+        break;
+    }
+
+    // Restricting the value of the duty cycle between 0 and 100
+    DutyCycle = (DutyCycle > 100) ? 100 : DutyCycle;
+    DutyCycle = (DutyCycle < 0) ? 0 : DutyCycle;
+
+    return DutyCycle;
+}
@@ -0,0 +1,65 @@
+/*
+*  prof_func.h
+*  profile functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO PLAY DUTY CYCLE PROFILES         */
+/* ------------------------------------------------------------------ */
+
+#ifndef PROF_FUNC_H
+#define PROF_FUNC_H
+
+// Kinds of profile step
+#define ProfileHold 0       // Jump to Level and hold it
+#define ProfileRamp 1       // Move in a straight line to Level
+#define ProfileSine 2       // Sine wave of amplitude Level around the starting level
+#define ProfilePrbs 3       // Pseudo-random switching between the starting level and Level
+
+// Profile constants
+#define ProfileTickTime 500000      // Counter ticks per unit of step time (10 ms)
+#define ProfileMaxSteps 256         // Largest number of steps in a profile read from a file
+
+/*
+* One step of a profile. Levels are duty cycles (0-100) and times are
+* in units of ProfileTickTime.
+*/
+
+struct ProfileStep
+{
+    unsigned char Kind;         // ProfileHold, ProfileRamp, ProfileSine or ProfilePrbs
+    unsigned char Level;        // Level reached, amplitude of a sine or high level of a PRBS
+    unsigned short Time;        // Length of the step
+    unsigned short Period;      // Period of a sine or bit time of a PRBS
+};
+
+/*
+* A table of steps played one after the other, from a duty cycle of 0.
+*/
+
+struct Profile
+{
+    const struct ProfileStep *Steps;    // The steps
+    int Count;                          // Number of steps
+    int Loop;                           // Set to start again after the last step
+};
+
+// FUNCTION DECLARATIONS //
+
+int ProfileSelect(const char *);    // Selects a built-in profile by name or
+                                    // reads one from a file.
+
+
+void ProfileRestart(void);    // Plays the selected profile from the start.
+
+
+void ProfileSeek(int);    // Plays the selected profile from the point
+                          // closest to a duty cycle.
+
+
+int ProfilePlay(int);    // Gives the duty cycle of the profile at the
+                         // current time.
+
+#endif
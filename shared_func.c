@@ -0,0 +1,104 @@
+/*
+*  shared_func.c
+*  shared state functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO SHARE STATE BETWEEN THE THREADS  */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "shared_func.h"
+
+// Including other necessary custom headers
+#include "globals.h"
+
+/*
+* Function: SharedWrite
+* --------------------------------
+* Publishes a structure made of ints. The sequence is made odd, the
+* structure is copied and the sequence is made even again, so the
+* writer never waits; readers that overlap the update see the odd or
+* changed sequence and discard their copy. There must be only one
+* writer for each shared structure.
+*
+* *Share: Pointer to the shared structure.
+* *Source: Pointer to the structure to publish.
+* Size: Size of the structure in bytes (at most SharedMaxWords ints).
+*/
+
+void SharedWrite(struct Shared *Share, const void *Source, int Size)
+{
+
+    const int *Words = (const int *)Source;
+    unsigned int Sequence = __atomic_load_n(&Share->Sequence, __ATOMIC_RELAXED);
+    int i;
+
+    // Marking the structure as being updated before any word changes
+    __atomic_store_n(&Share->Sequence, Sequence + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for (i = 0; i < Size/(int)sizeof(int); i++)
+    {
+        __atomic_store_n(&Share->Data[i], Words[i], __ATOMIC_RELAXED);
+    }
+
+    // Marking the update as complete after every word has changed
+    __atomic_store_n(&Share->Sequence, Sequence + 2, __ATOMIC_RELEASE);
+
+}
+
+/*
+* Function: SharedRead
+* --------------------------------
+* Takes a copy of a published structure. Only one attempt is made, so
+* the caller never waits for the writer; if the copy overlapped an
+* update the destination is left unchanged and the caller can keep its
+* previous copy or try again.
+*
+* *Share: Pointer to the shared structure.
+* *Destination: Pointer to the structure to copy into.
+* Size: Size of the structure in bytes (at most SharedMaxWords ints).
+*
+* Returns: 1 if a consistent copy was taken or 0 if not.
+*/
+
+int SharedRead(struct Shared *Share, void *Destination, int Size)
+{
+
+    int Copy[SharedMaxWords]; // Copy taken before it is known to be consistent
+    unsigned int Before; // Sequence before the copy
+    unsigned int After; // Sequence after the copy
+    int i;
+
+    Before = __atomic_load_n(&Share->Sequence, __ATOMIC_ACQUIRE);
+    if (Before & 0x01)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < Size/(int)sizeof(int); i++)
+    {
+        Copy[i] = __atomic_load_n(&Share->Data[i], __ATOMIC_RELAXED);
+    }
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    After = __atomic_load_n(&Share->Sequence, __ATOMIC_RELAXED);
+    if (After != Before)
+    {
+        return 0;
+    }
+
+    for (i = 0; i < Size/(int)sizeof(int); i++)
+    {
+        ((int *)Destination)[i] = Copy[i];
+    }
+
+    return 1;
+}
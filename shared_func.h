@@ -0,0 +1,38 @@
+/*
+*  shared_func.h
+*  shared state functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO SHARE STATE BETWEEN THE THREADS  */
+/* ------------------------------------------------------------------ */
+
+#ifndef SHARED_FUNC_H
+#define SHARED_FUNC_H
+
+// Largest structure (in ints) that can be shared
+#define SharedMaxWords 16
+
+/*
+* A structure shared through a sequence lock. The sequence is odd
+* while the writer is updating Data.
+*/
+
+struct Shared
+{
+    unsigned int Sequence;      // Incremented before and after every update
+    int Data[SharedMaxWords];   // Copy of the shared structure
+};
+
+// FUNCTION DECLARATIONS //
+
+void SharedWrite(struct Shared *, const void *, int);    // Publishes a structure without
+                                                         // ever waiting for readers.
+
+
+int SharedRead(struct Shared *, void *, int);    // Makes one attempt to take a consistent
+                                                 // copy of a published structure.
+
+#endif
@@ -0,0 +1,296 @@
+/*
+*  stats_func.c
+*  windowed statistics functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------- */
+/* SOURCE FILE FOR FUNCTIONS USED TO KEEP STATISTICS OF THE SIGNALS */
+/* ---------------------------------------------------------------- */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "stats_func.h"
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "shared_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+/*
+* Running sums of one signal over one window and the two monotonic
+* deques that give its extremes. A deque holds sample indices in
+* MinSlots or MaxSlots; Head and Tail count the indices pushed to and
+* removed from it, so the front is at Head and the back just before
+* Tail.
+*/
+
+struct StatsState
+{
+    long long Sum;              // Sum of the samples in the window
+    long long Squares;          // Sum of their squares
+    unsigned int MinHead;       // Front of the deque of increasing values
+    unsigned int MinTail;       // End of the deque of increasing values
+    unsigned int MaxHead;       // Front of the deque of decreasing values
+    unsigned int MaxTail;       // End of the deque of decreasing values
+};
+
+// Length of each window in samples and the first deque slot it uses
+static const int WindowSamples[StatsWindows] = {StatsSampleRate, StatsSampleRate*10, StatsSampleRate*60};
+static const int WindowSlots[StatsWindows] = {0, StatsSampleRate, StatsSampleRate*11};
+
+static int History[StatsSignals][StatsHistory];                     // Latest samples of each signal
+static unsigned int MinSlots[StatsSignals][StatsSlots];             // Deques of increasing values
+static unsigned int MaxSlots[StatsSignals][StatsSlots];             // Deques of decreasing values
+static struct StatsState States[StatsSignals][StatsWindows];        // Sums and deques of every window
+static struct StatsSummary Summaries[StatsSignals][StatsWindows];   // Latest statistics
+static struct Shared Published[StatsSignals][StatsWindows];         // Statistics published for other threads
+static unsigned int Samples;                                        // Samples taken of each signal
+static struct TimeWindow SampleWindow;                              // Current sampling period
+
+/*
+* Function: Slot
+* --------------------------------
+* Finds the deque slot of a position in the deque of a window.
+*
+* Window: The window (Stats1s, Stats10s or Stats60s).
+* Position: Count of indices pushed to or removed from the deque.
+*
+* Returns: The slot in MinSlots or MaxSlots.
+*/
+
+static int Slot(int Window, unsigned int Position)
+{
+
+    return WindowSlots[Window] + Position%WindowSamples[Window];
+}
+
+/*
+* Function: SquareRoot
+* --------------------------------
+* Works out the square root of a number, rounded down, one bit at a
+* time.
+*
+* Value: The number (at least 0).
+*
+* Returns: The square root.
+*/
+
+static int SquareRoot(long long Value)
+{
+
+    long long Root = 0;
+    long long Bit = 1ll << 40; // Highest power of four used
+
+    while (Bit > Value)
+    {
+        Bit >>= 2;
+    }
+
+    while (Bit != 0)
+    {
+        if (Value >= Root + Bit)
+        {
+            Value -= Root + Bit;
+            Root = (Root >> 1) + Bit;
+        }
+        else
+        {
+            Root >>= 1;
+        }
+        Bit >>= 2;
+    }
+
+    return (int)Root;
+}
+
+/*
+* Function: Push
+* --------------------------------
+* Adds the latest sample of a signal, already stored in History, to
+* every window. The sample that leaves a window is taken off its sums
+* and, if it is still there, off the front of its deques; samples that
+* can no longer be the smallest or largest in the window are taken off
+* the back before the new one is added. Every sample is added to and
+* removed from each deque once, so the work per sample is constant on
+* average however long the window.
+*
+* Signal: The signal (StatsSpeed, StatsOnTime or StatsError).
+* Index: Index of the sample.
+*/
+
+static void Push(int Signal, unsigned int Index)
+{
+
+    struct StatsState *State;
+    int *Values = History[Signal];
+    int Value = Values[Index%StatsHistory];
+    int Old; // Sample leaving the window
+    int Window;
+
+    for (Window = 0; Window < StatsWindows; Window++)
+    {
+        State = &States[Signal][Window];
+
+        State->Sum += Value;
+        State->Squares += (long long)Value*Value;
+
+        // Removing the sample that has left the window
+        if (Index >= (unsigned int)WindowSamples[Window])
+        {
+            Old = Values[(Index - WindowSamples[Window])%StatsHistory];
+            State->Sum -= Old;
+            State->Squares -= (long long)Old*Old;
+
+            if (State->MinHead != State->MinTail
+                && MinSlots[Signal][Slot(Window, State->MinHead)] == Index - WindowSamples[Window])
+            {
+                State->MinHead++;
+            }
+            if (State->MaxHead != State->MaxTail
+                && MaxSlots[Signal][Slot(Window, State->MaxHead)] == Index - WindowSamples[Window])
+            {
+                State->MaxHead++;
+            }
+        }
+
+        // Keeping the values in each deque in order
+        while (State->MinTail != State->MinHead
+               && Values[MinSlots[Signal][Slot(Window, State->MinTail - 1)]%StatsHistory] >= Value)
+        {
+            State->MinTail--;
+        }
+        MinSlots[Signal][Slot(Window, State->MinTail++)] = Index;
+
+        while (State->MaxTail != State->MaxHead
+               && Values[MaxSlots[Signal][Slot(Window, State->MaxTail - 1)]%StatsHistory] <= Value)
+        {
+            State->MaxTail--;
+        }
+        MaxSlots[Signal][Slot(Window, State->MaxTail++)] = Index;
+    }
+
+}
+
+/*
+* Function: Summarise
+* --------------------------------
+* Works out the statistics of a signal over a window from its sums and
+* deques. The variance is taken from the exact integer sums, so it
+* does not lose precision however long the window.
+*
+* Signal: The signal (StatsSpeed, StatsOnTime or StatsError).
+* Window: The window (Stats1s, Stats10s or Stats60s).
+*/
+
+static void Summarise(int Signal, int Window)
+{
+
+    const struct StatsState *State = &States[Signal][Window];
+    struct StatsSummary *Summary = &Summaries[Signal][Window];
+    long long Count = (Samples < (unsigned int)WindowSamples[Window]) ? Samples : (unsigned int)WindowSamples[Window];
+
+    Summary->Samples = (int)Count;
+    Summary->Min = History[Signal][MinSlots[Signal][Slot(Window, State->MinHead)]%StatsHistory];
+    Summary->Max = History[Signal][MaxSlots[Signal][Slot(Window, State->MaxHead)]%StatsHistory];
+    Summary->Mean = (int)(State->Sum*100/Count);
+    Summary->Variance = (int)((State->Squares*Count - State->Sum*State->Sum)*100/(Count*Count));
+    Summary->Deviation = SquareRoot((long long)Summary->Variance*100);
+
+}
+
+/*
+* Function: StatsSample
+* --------------------------------
+* Called on every pass of the control path. Once every
+* StatsSampleTicks takes a sample of the speed, the on-time and the
+* tracking error, adds it to the 1 s, 10 s and 60 s windows and
+* publishes the new statistics. A pass that is later than a whole
+* sampling period loses the samples it missed, so a window can span
+* slightly more than its length.
+*
+* *Control: Pointer to the state of the control path.
+*/
+
+void StatsSample(const struct ControlState *Control)
+{
+
+    int Values[StatsSignals]; // Sample of each signal
+    int Signal;
+    int Window;
+
+    if (!TimeWindowUpdate(&SampleWindow, StatsSampleTicks))
+    {
+        return;
+    }
+
+    Values[StatsSpeed] = Control->RPS;
+    Values[StatsOnTime] = Control->OnTime;
+    Values[StatsError] = Control->DesiredSpeed - (Control->RPS*50)/MaxRPS;
+
+    for (Signal = 0; Signal < StatsSignals; Signal++)
+    {
+        History[Signal][Samples%StatsHistory] = Values[Signal];
+        Push(Signal, Samples);
+    }
+    Samples++;
+
+    for (Signal = 0; Signal < StatsSignals; Signal++)
+    {
+        for (Window = 0; Window < StatsWindows; Window++)
+        {
+            Summarise(Signal, Window);
+            SharedWrite(&Published[Signal][Window], &Summaries[Signal][Window], sizeof(struct StatsSummary));
+        }
+    }
+
+}
+
+/*
+* Function: StatsSummaryGet
+* --------------------------------
+* Gives the control path access to the latest statistics of one
+* signal over one window. Other threads use StatsRead.
+*
+* Signal: The signal (StatsSpeed, StatsOnTime or StatsError).
+* Window: The window (Stats1s, Stats10s or Stats60s).
+*
+* Returns: A pointer to the statistics.
+*/
+
+const struct StatsSummary *StatsSummaryGet(int Signal, int Window)
+{
+
+    return &Summaries[Signal][Window];
+}
+
+/*
+* Function: StatsRead
+* --------------------------------
+* Takes a copy of the latest statistics of one signal over one window
+* without waiting for the control path.
+*
+* Signal: The signal (StatsSpeed, StatsOnTime or StatsError).
+* Window: The window (Stats1s, Stats10s or Stats60s).
+* *Summary: Pointer to the structure to copy into.
+*
+* Returns: 1 if a copy was taken or 0 if the signal or window does not
+* exist, no sample has been taken yet or the statistics were being
+* updated.
+*/
+
+int StatsRead(int Signal, int Window, struct StatsSummary *Summary)
+{
+
+    if (Signal < 0 || Signal >= StatsSignals || Window < 0 || Window >= StatsWindows)
+    {
+        return 0;
+    }
+
+    return SharedRead(&Published[Signal][Window], Summary, sizeof(*Summary)) && Summary->Samples > 0;
+}
@@ -0,0 +1,67 @@
+/*
+*  stats_func.h
+*  windowed statistics functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------- */
+/* HEADER FILE FOR FUNCTIONS USED TO KEEP STATISTICS OF THE SIGNALS */
+/* ---------------------------------------------------------------- */
+
+#ifndef STATS_FUNC_H
+#define STATS_FUNC_H
+
+// Signals the statistics are kept for
+#define StatsSpeed 0            // Measured speed in RPS
+#define StatsOnTime 1           // On-time of the PWM (0-100)
+#define StatsError 2            // Desired speed less the scaled measured speed (0-50 scale)
+#define StatsSignals 3
+
+// Sliding windows the statistics are kept over
+#define Stats1s 0               // Last second
+#define Stats10s 1              // Last 10 seconds
+#define Stats60s 2              // Last minute
+#define StatsWindows 3
+
+// Sampling constants
+#define StatsSampleTicks 2500000    // Time between samples (50 ms)
+#define StatsSampleRate 20          // Samples per second
+#define StatsHistory 1201           // Samples kept per signal (the longest window and one more)
+#define StatsSlots 1420             // Deque slots per signal (the lengths of the three windows)
+
+// Diagnostic display page
+#define StatsPageSwitches 0b1000    // SW8 to SW5 pattern (SW8 alone) that shows the page
+#define StatsPageTicks 100000000    // Time each signal and window is shown for (2 s)
+
+/*
+* Statistics of one signal over one window. The mean and variance are
+* in hundredths so that slow drift and small hunting show up.
+*/
+
+struct StatsSummary
+{
+    int Samples;            // Samples in the window (fewer until the window has filled)
+    int Min;                // Smallest value in the window
+    int Max;                // Largest value in the window
+    int Mean;               // Mean in hundredths
+    int Variance;           // Variance in hundredths of the squared unit
+    int Deviation;          // Standard deviation in hundredths
+};
+
+struct ControlState;
+
+// FUNCTION DECLARATIONS //
+
+void StatsSample(const struct ControlState *);    // Adds a sample of every signal once
+                                                  // every StatsSampleTicks.
+
+
+const struct StatsSummary *StatsSummaryGet(int, int);    // Gives the control path access to
+                                                         // the statistics of one signal and window.
+
+
+int StatsRead(int, int, struct StatsSummary *);    // Takes a copy of the statistics of one
+                                                   // signal and window from another thread.
+
+#endif
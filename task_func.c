@@ -0,0 +1,261 @@
+/*
+*  task_func.c
+*  task functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO RUN THE CONTROLLER'S TASKS       */
+/* ------------------------------------------------------------------ */
+
+// Needed on Linux for the thread affinity functions
+#ifdef FAN_LINUX
+#define _GNU_SOURCE
+#endif
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "task_func.h"
+
+#ifdef FAN_LINUX
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <sys/mman.h>
+#endif
+
+// Including other necessary custom headers
+#include "ctrl_func.h"
+#include "board_func.h"
+#include "wdog_func.h"
+#include "globals.h"
+
+static struct ControlState Control;    // State of the control path
+static struct UiState Ui;              // State of the user interface
+
+#ifdef FAN_LINUX
+
+static int Stop;    // Set once either task has seen the board stop
+
+/*
+* Function: PinThread
+* --------------------------------
+* Pins a thread to one core and, if a priority is given, makes it a
+* SCHED_FIFO thread. Failures are reported but not fatal, so that the
+* controller still runs without the privileges needed for real-time
+* scheduling.
+*
+* Thread: The thread to place.
+* Cpu: Core the thread should run on.
+* Priority: SCHED_FIFO priority, or 0 to keep the normal scheduler.
+* Name: Name of the thread used in messages.
+*/
+
+static void PinThread(pthread_t Thread, int Cpu, int Priority, const char *Name)
+{
+
+    cpu_set_t Cpus;
+    struct sched_param Param;
+    int Error;
+
+    CPU_ZERO(&Cpus);
+    CPU_SET(Cpu, &Cpus);
+    Error = pthread_setaffinity_np(Thread, sizeof(Cpus), &Cpus);
+    if (Error != 0)
+    {
+        fprintf(stderr, "%s thread: cannot pin to cpu %d: %s\n", Name, Cpu, strerror(Error));
+    }
+
+    if (Priority > 0)
+    {
+        Param.sched_priority = Priority;
+        Error = pthread_setschedparam(Thread, SCHED_FIFO, &Param);
+        if (Error != 0)
+        {
+            fprintf(stderr, "%s thread: cannot use SCHED_FIFO priority %d: %s\n", Name, Priority, strerror(Error));
+        }
+    }
+
+}
+
+/*
+* Function: ControlTask
+* --------------------------------
+* Body of the real-time thread: polls the board and runs the control
+* path as fast as it can. It shares nothing with the user interface
+* but the two sequence-locked structures, so it never blocks on it.
+*
+* Argument: Unused.
+*
+* Returns: NULL once the board stops.
+*/
+
+static void *ControlTask(void *Argument)
+{
+
+    (void)Argument;
+
+    while (!__atomic_load_n(&Stop, __ATOMIC_RELAXED) && BoardPoll())
+    {
+        ControlTick(&Control);
+        WdogBegin(WdogIdle);
+        BoardIdle(Control.Deadline);
+    }
+    __atomic_store_n(&Stop, 1, __ATOMIC_RELAXED);
+
+    return NULL;
+}
+
+/*
+* Function: RunSplit
+* --------------------------------
+* Runs the control path in a SCHED_FIFO thread pinned to one core and
+* the user interface in the calling thread pinned to the other. The
+* process memory is locked so the control thread does not take page
+* faults.
+*
+* RtCpu: Core of the control thread.
+* UiCpu: Core of the user interface thread.
+* RtPriority: SCHED_FIFO priority of the control thread.
+*
+* Returns: 1 if the tasks ran or 0 if the control thread could not be
+* started.
+*/
+
+static int RunSplit(int RtCpu, int UiCpu, int RtPriority)
+{
+
+    pthread_t RtThread;
+    struct timespec Wait;
+    int Error;
+
+    Wait.tv_sec = 0;
+    Wait.tv_nsec = TaskUiPeriod;
+
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0)
+    {
+        perror("mlockall");
+    }
+
+    // The user interface can no longer hold up the control path
+    WdogSplit();
+
+    Error = pthread_create(&RtThread, NULL, ControlTask, NULL);
+    if (Error != 0)
+    {
+        fprintf(stderr, "cannot start control thread: %s\n", strerror(Error));
+        return 0;
+    }
+    PinThread(RtThread, RtCpu, RtPriority, "control");
+    PinThread(pthread_self(), UiCpu, 0, "interface");
+
+    while (!__atomic_load_n(&Stop, __ATOMIC_RELAXED))
+    {
+        UiTick(&Ui);
+        nanosleep(&Wait, NULL);
+    }
+
+    pthread_join(RtThread, NULL);
+
+    return 1;
+}
+
+#endif
+
+/*
+* Function: RunTasks
+* --------------------------------
+* Runs the control path and the user interface until the board stops.
+* By default both run in turn in one loop, as on the bare-metal build.
+* On the Linux build (FAN_LINUX) they can be split across the two cores:
+*
+*   --split               run the control path in its own thread
+*   --rt-cpu CPU          core of the control thread (default 1)
+*   --ui-cpu CPU          core of the user interface thread (default 0)
+*   --rt-priority PRIO    SCHED_FIFO priority of the control thread
+*                         (default 80)
+*
+* The split is meant for the hardware backends; a replayed trace is
+* only reproducible with the single loop, so --split is ignored with
+* --replay.
+*
+* argc: Number of command line arguments.
+* argv: The command line arguments.
+*
+* Returns: 1 if the tasks ran or 0 if they could not be started.
+*/
+
+int RunTasks(int argc, char **argv)
+{
+
+    ControlInit(&Control);
+    UiInit(&Ui);
+
+#ifdef FAN_LINUX
+    int Split = 0; // Set to run the tasks in separate threads
+    int RtCpu = TaskRtCpu;
+    int UiCpu = TaskUiCpu;
+    int RtPriority = TaskRtPriority;
+    int Replaying = 0; // Set if a trace is replayed
+    int Arg;
+
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--split") == 0)
+        {
+            Split = 1;
+        }
+        else if (Arg + 1 >= argc)
+        {
+            break;
+        }
+        else if (strcmp(argv[Arg], "--replay") == 0)
+        {
+            Replaying = 1;
+            Arg++;
+        }
+        else if (strcmp(argv[Arg], "--rt-cpu") == 0)
+        {
+            RtCpu = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--ui-cpu") == 0)
+        {
+            UiCpu = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--rt-priority") == 0)
+        {
+            RtPriority = atoi(argv[++Arg]);
+        }
+    }
+
+    if (Split && Replaying)
+    {
+        fprintf(stderr, "%s: --split ignored, a replayed trace runs on a single loop\n", argv[0]);
+    }
+    else if (Split)
+    {
+        return RunSplit(RtCpu, UiCpu, RtPriority);
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
+    // Start of the main loop which runs continuously (or until a
+    // replayed trace ends)
+    while (BoardPoll())
+    {
+        UiTick(&Ui);
+        ControlTick(&Control);
+        WdogBegin(WdogIdle);
+        BoardIdle(Control.Deadline);
+    }
+
+    return 1;
+}
@@ -0,0 +1,28 @@
+/*
+*  task_func.h
+*  task functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO RUN THE CONTROLLER'S TASKS       */
+/* ------------------------------------------------------------------ */
+
+#ifndef TASK_FUNC_H
+#define TASK_FUNC_H
+
+// Default placement and priority of the split tasks on Linux
+#define TaskRtCpu 1             // Core the control thread is pinned to
+#define TaskUiCpu 0             // Core the user interface thread is pinned to
+#define TaskRtPriority 80       // SCHED_FIFO priority of the control thread
+
+// Time the user interface thread sleeps between passes (1 ms)
+#define TaskUiPeriod 1000000
+
+// FUNCTION DECLARATIONS //
+
+int RunTasks(int, char **);    // Runs the control path and the user interface
+                               // until the board stops.
+
+#endif
@@ -0,0 +1,291 @@
+/*
+*  temp_func.c
+*  temperature functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED FOR THERMOSTATIC CONTROL OF THE FAN */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "temp_func.h"
+#include "time_func.h"
+
+// Including other necessary custom headers
+#include "globals.h"
+
+// Simulated sensor constants (temperatures in millidegrees Celsius,
+// rates per half-second step)
+#define SimAmbient 25000        // Temperature the simulated sensor cools towards
+#define SimLoadBusy 900         // Heating per step while the simulated load is busy
+#define SimLoadIdle 300         // Heating per step while the simulated load is idle
+#define SimLoadPeriod 240       // Number of steps in one busy/idle load cycle
+
+// Fan curve constants
+#define CurvePoints 5           // Number of points in the fan curve
+#define TempHysteresis 2000     // Drop in temperature needed before the fan slows down
+#define RateUp 512              // Largest increase of the desired speed per step (24.8)
+#define RateDown 256            // Largest decrease of the desired speed per step (24.8)
+
+// Fan curve as pairs of temperature (millidegrees Celsius) and desired
+// speed (0-50); temperatures must be in ascending order
+static const int CurveTemp[CurvePoints]  = {30000, 40000, 55000, 70000, 80000};
+static const int CurveSpeed[CurvePoints] = {    0,    12,    25,    40,    50};
+
+static int Source = TempSourceSim;    // Selected temperature source
+static char Path[128];                // Path of the file read by the file and hwmon sources
+
+/*
+* Function: TempSourceSelect
+* --------------------------------
+* Selects where ReadTemperature takes the temperature from. The file
+* source reads a file holding a single integer in millidegrees Celsius
+* (the format of a Linux hwmon tempN_input file). The hwmon source
+* takes a sensor name such as "hwmon0/temp1" and reads the matching
+* file under /sys/class/hwmon.
+*
+* NewSource: One of TempSourceSim, TempSourceFile or TempSourceHwmon.
+* Name: File path or sensor name; unused by the simulated source.
+*
+* Returns: 1 if the source was selected or 0 if it was not recognised,
+* in which case the simulated source is used.
+*/
+
+int TempSourceSelect(int NewSource, const char *Name)
+{
+
+    switch (NewSource)
+    {
+    case TempSourceFile:
+        snprintf(Path, sizeof(Path), "%s", Name);
+        break;
+    case TempSourceHwmon:
+        snprintf(Path, sizeof(Path), "/sys/class/hwmon/%s_input", Name);
+        break;
+    case TempSourceSim:
+        break;
+    default:
+        Source = TempSourceSim;
+        return 0;
+    }
+
+    Source = NewSource;
+
+    return 1;
+}
+
+/*
+* Function: SimulatedTemperature
+* --------------------------------
+* Models a heat source cooled by the fan. Every half-second the
+* temperature rises by the current load and falls in proportion to
+* its difference from ambient; the cooling grows with the speed of
+* the fan. The load switches between busy and idle so that the fan
+* curve is exercised without any external input.
+*
+* RPS: The measured speed of the fan in revolutions per second.
+*
+* Returns: Temperature, the simulated temperature in millidegrees
+* Celsius.
+*/
+
+static int SimulatedTemperature(int RPS)
+{
+
+    static int Temperature = SimAmbient; // Simulated temperature
+    static int Step = 0; // Number of steps taken through the load cycle
+    int Load; // Heating during this step
+    int Cooling; // Fraction of the temperature difference removed (per mille)
+
+    Load = (Step < SimLoadPeriod/2) ? SimLoadBusy : SimLoadIdle;
+    Cooling = 10 + (12*RPS)/10;
+
+    Temperature += Load - (Cooling*(Temperature - SimAmbient))/1000;
+
+    Step = (Step + 1 >= SimLoadPeriod) ? 0 : Step + 1;
+
+    return Temperature;
+}
+
+/*
+* Function: TempPoll
+* --------------------------------
+* Called by the user interface on every pass, so that a file or hwmon
+* sensor is never read by the control path: file access can block,
+* which the control path must never do. The sensor is read on the
+* first call and then every half-second. If the file cannot be read
+* the fail-safe temperature is given so that the fan runs at full
+* speed. Nothing is read for the simulated sensor, which is stepped
+* by ReadTemperature.
+*
+* *Temperature: Pointer to the integer that is set to the temperature
+* read, in millidegrees Celsius, for the control path (Setpoints).
+*/
+
+void TempPoll(int *Temperature)
+{
+
+    static struct TimeWindow Window; // Current half-second window
+    static int Started = 0; // Set after the first read
+    FILE *File; // File holding the temperature
+
+    if (Source == TempSourceSim || (!TimeWindowUpdate(&Window, ClockFrequency/2) && Started))
+    {
+        return;
+    }
+    Started = 1;
+
+    *Temperature = TempFailSafe;
+    File = fopen(Path, "r");
+    if (File != NULL)
+    {
+        if (fscanf(File, "%d", Temperature) != 1)
+        {
+            *Temperature = TempFailSafe;
+        }
+        fclose(File);
+    }
+
+}
+
+/*
+* Function: ReadTemperature
+* --------------------------------
+* Gives the temperature of the source chosen by TempSourceSelect: the
+* simulated sensor is stepped here, while a file or hwmon sensor has
+* already been read by TempPoll on the user interface side. Intended
+* to be called every half-second, which is the step size of the
+* simulated sensor.
+*
+* RPS: The measured speed of the fan, used by the simulated sensor.
+* Sensed: The temperature last read by TempPoll.
+*
+* Returns: Temperature, the measured temperature in millidegrees
+* Celsius.
+*/
+
+int ReadTemperature(int RPS, int Sensed)
+{
+
+    if (Source == TempSourceSim)
+    {
+        return SimulatedTemperature(RPS);
+    }
+
+    return Sensed;
+}
+
+/*
+* Function: FanCurve
+* --------------------------------
+* Maps a temperature onto a desired speed by linear interpolation
+* between the points of the fan curve. Temperatures outside the
+* curve use the speed of the nearest end point. The interpolation
+* is done in integer arithmetic with an 8-bit fractional part.
+*
+* Temperature: The temperature in millidegrees Celsius.
+*
+* Returns: Speed, the desired speed (0-50) in 24.8 fixed point.
+*/
+
+int FanCurve(int Temperature)
+{
+
+    int i = 1; // Index of the curve point above the temperature
+    int Span; // Temperature difference between the two curve points
+
+    if (Temperature <= CurveTemp[0])
+    {
+        return CurveSpeed[0] << 8;
+    }
+    if (Temperature >= CurveTemp[CurvePoints - 1])
+    {
+        return CurveSpeed[CurvePoints - 1] << 8;
+    }
+
+    // Finding the segment of the curve containing the temperature
+    while (Temperature > CurveTemp[i])
+    {
+        i++;
+    }
+
+    // Interpolating between the two points of the segment
+    Span = CurveTemp[i] - CurveTemp[i-1];
+
+    return (CurveSpeed[i-1] << 8) +
+           (((CurveSpeed[i] - CurveSpeed[i-1]) << 8)*(Temperature - CurveTemp[i-1]))/Span;
+}
+
+/*
+* Function: Thermostat
+* --------------------------------
+* Sets the desired speed of the fan from the measured temperature
+* every half-second. The temperature only counts as falling once it
+* has dropped by TempHysteresis, which stops the fan hunting around a
+* curve point, and the desired speed is moved towards the fan curve
+* by at most RateUp or RateDown per step. If DesiredSpeed has been
+* changed elsewhere (e.g. reset by ModeSelect) the ramp restarts from
+* its new value.
+*
+* DesiredSpeed: The current desired speed of the fan (0-50).
+* RPS: The measured speed of the fan in revolutions per second.
+* Sensed: The temperature last read by TempPoll (file and hwmon
+* sources) in millidegrees Celsius.
+* *Temperature: Pointer to the integer that is set to the last
+* measured temperature in millidegrees Celsius.
+*
+* Returns: DesiredSpeed, the new desired speed of the fan (0-50).
+*/
+
+int Thermostat(int DesiredSpeed, int RPS, int Sensed, int *Temperature)
+{
+
+    static struct TimeWindow Window; // Current half-second window
+
+    static int Tracked = SimAmbient; // Temperature after hysteresis
+    static int Speed = 0; // Desired speed in 24.8 fixed point
+    int Target; // Desired speed given by the fan curve (24.8)
+
+    // Restarting the ramp if the desired speed was changed elsewhere
+    if ((Speed >> 8) != DesiredSpeed)
+    {
+        Speed = DesiredSpeed << 8;
+    }
+
+    // Updating the desired speed only when a half-second has passed
+    if (TimeWindowUpdate(&Window, ClockFrequency/2))
+    {
+        *Temperature = ReadTemperature(RPS, Sensed);
+
+        // Following rising temperatures immediately and falling
+        // temperatures only once they pass the hysteresis band
+        if (*Temperature > Tracked)
+        {
+            Tracked = *Temperature;
+        }
+        else if (*Temperature < Tracked - TempHysteresis)
+        {
+            Tracked = *Temperature + TempHysteresis;
+        }
+
+        // Moving towards the fan curve at a limited rate
+        Target = FanCurve(Tracked);
+        if (Target > Speed)
+        {
+            Speed = (Target - Speed > RateUp) ? Speed + RateUp : Target;
+        }
+        else
+        {
+            Speed = (Speed - Target > RateDown) ? Speed - RateDown : Target;
+        }
+    }
+
+
+    return Speed >> 8;
+}
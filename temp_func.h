@@ -0,0 +1,45 @@
+/*
+*  temp_func.h
+*  temperature functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED FOR THERMOSTATIC CONTROL OF THE FAN */
+/* ------------------------------------------------------------------ */
+
+#ifndef TEMP_FUNC_H
+#define TEMP_FUNC_H
+
+// Temperature sources
+#define TempSourceSim 0         // Simulated sensor heated by a load and cooled by the fan
+#define TempSourceFile 1        // File holding a temperature in millidegrees Celsius
+#define TempSourceHwmon 2       // Linux hwmon sensor such as "hwmon0/temp1"
+
+// Temperature used when a source cannot be read (millidegrees Celsius)
+#define TempFailSafe 100000
+
+// FUNCTION DECLARATIONS //
+
+int TempSourceSelect(int, const char *);    // Selects the source that is used to read
+                                            // the temperature.
+
+
+void TempPoll(int *);    // Reads a file or hwmon sensor on the user
+                         // interface side every half-second.
+
+
+int ReadTemperature(int, int);    // Gives the temperature in millidegrees
+                                  // Celsius from the selected source.
+
+
+int FanCurve(int);    // Maps a temperature onto a desired speed
+                      // (0-50) in 24.8 fixed point.
+
+
+int Thermostat(int, int, int, int *);    // Sets the desired speed from the measured
+                                         // temperature with hysteresis and rate
+                                         // limiting.
+
+#endif
@@ -0,0 +1,168 @@
+/*
+*  time_func.c
+*  time functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO KEEP THE CONTROLLER'S TIME BASE  */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "time_func.h"
+
+// Including other necessary custom headers
+#include "globals.h"
+
+static unsigned long long Now;          // Time read by the last TimeUpdate
+static unsigned int PrevCounter;        // Counter value read by the last TimeUpdate
+
+/*
+* Function: TimeUpdate
+* --------------------------------
+* Reads * Counter and extends it to 64 bits by counting the times it
+* has wrapped since the previous read. Called once per pass of the main
+* loop (from BoardPoll), so it must run at least once every 2^32 ticks
+* (about 86 seconds at 50 MHz). Only the control path calls it; other
+* threads only read the result.
+*/
+
+void TimeUpdate(void)
+{
+
+    unsigned int Value = *Counter;
+    unsigned long long Time = __atomic_load_n(&Now, __ATOMIC_RELAXED);
+
+    // Counting a wrap of the 32-bit counter
+    if (Value < PrevCounter)
+    {
+        Time += 0x100000000ull;
+    }
+    Time = (Time & ~0xFFFFFFFFull) | Value;
+    PrevCounter = Value;
+
+    __atomic_store_n(&Now, Time, __ATOMIC_RELAXED);
+
+}
+
+/*
+* Function: TimeNow
+* --------------------------------
+* Gives the time read by the last TimeUpdate, so that every function
+* in one pass of the loop sees the same time.
+*
+* Returns: The time in counter ticks since the counter started.
+*/
+
+unsigned long long TimeNow(void)
+{
+
+    return __atomic_load_n(&Now, __ATOMIC_RELAXED);
+}
+
+/*
+* Function: TimeMicroseconds
+* --------------------------------
+* Converts a time in microseconds to counter ticks.
+*
+* Microseconds: The time in microseconds.
+*
+* Returns: The time in counter ticks.
+*/
+
+unsigned long long TimeMicroseconds(unsigned long long Microseconds)
+{
+
+    return Microseconds*(ClockFrequency/1000000);
+}
+
+/*
+* Function: TimeToMicroseconds
+* --------------------------------
+* Converts a time in counter ticks to microseconds, rounding down.
+*
+* Ticks: The time in counter ticks.
+*
+* Returns: The time in microseconds.
+*/
+
+unsigned long long TimeToMicroseconds(unsigned long long Ticks)
+{
+
+    return Ticks/(ClockFrequency/1000000);
+}
+
+/*
+* Function: TimePeriod
+* --------------------------------
+* Gives the length of one period of a frequency.
+*
+* Frequency: The frequency in Hz (at least 1).
+*
+* Returns: The period in counter ticks.
+*/
+
+unsigned long long TimePeriod(int Frequency)
+{
+
+    return ClockFrequency/Frequency;
+}
+
+/*
+* Function: TimeReached
+* --------------------------------
+* Checks whether the time read by the last TimeUpdate has reached a
+* deadline.
+*
+* Deadline: The deadline in counter ticks.
+*
+* Returns: 1 if the deadline has been reached or 0 if not.
+*/
+
+int TimeReached(unsigned long long Deadline)
+{
+
+    return TimeNow() >= Deadline;
+}
+
+/*
+* Function: TimeWindowUpdate
+* --------------------------------
+* Moves a window to the one holding the current time, if the time has
+* left it. Used to run something once every fixed period (e.g. every
+* half-second) aligned to multiples of the period, with one division
+* per period rather than one per pass. A change of length also moves
+* the window.
+*
+* *Window: Pointer to the window.
+* Length: Length of the window in counter ticks.
+*
+* Returns: 1 if the window moved or 0 if the time is still inside it.
+*/
+
+int TimeWindowUpdate(struct TimeWindow *Window, unsigned long long Length)
+{
+
+    unsigned long long Time = TimeNow();
+
+    // A zeroed window is the first window after time 0
+    if (Window->End == 0)
+    {
+        Window->End = Length;
+    }
+
+    if (Time >= Window->Start && Time < Window->End && Window->End - Window->Start == Length)
+    {
+        return 0;
+    }
+
+    Window->Start = Time - Time%Length;
+    Window->End = Window->Start + Length;
+
+    return 1;
+}
@@ -0,0 +1,55 @@
+/*
+*  time_func.h
+*  time functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO KEEP THE CONTROLLER'S TIME BASE  */
+/* ------------------------------------------------------------------ */
+
+#ifndef TIME_FUNC_H
+#define TIME_FUNC_H
+
+/*
+* A window of time of fixed length, aligned to a multiple of its
+* length. A zeroed window starts out as the first window after time 0.
+*/
+
+struct TimeWindow
+{
+    unsigned long long Start;       // Time at which the window starts
+    unsigned long long End;         // Time at which the next window starts
+};
+
+// FUNCTION DECLARATIONS //
+
+void TimeUpdate(void);    // Reads * Counter once and extends it to
+                          // 64 bits.
+
+
+unsigned long long TimeNow(void);    // Gives the time read by the last
+                                     // TimeUpdate.
+
+
+unsigned long long TimeMicroseconds(unsigned long long);    // Converts microseconds
+                                                            // to counter ticks.
+
+
+unsigned long long TimeToMicroseconds(unsigned long long);    // Converts counter ticks
+                                                              // to microseconds.
+
+
+unsigned long long TimePeriod(int);    // Gives the length of one period of a
+                                       // frequency in counter ticks.
+
+
+int TimeReached(unsigned long long);    // Checks whether a deadline has
+                                        // been reached.
+
+
+int TimeWindowUpdate(struct TimeWindow *, unsigned long long);    // Moves a window to the current
+                                                                  // time and reports whether it moved.
+
+#endif
@@ -0,0 +1,256 @@
+/*
+*  batch_bench.c
+*  benchmark of the batched PID and PWM functions
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------------- */
+/* HOST TOOL FOR MEASURING AND CHECKING THE BATCHED FAN FUNCTIONS    */
+/* ----------------------------------------------------------------- */
+
+/*
+* Runs BatchPid and BatchPwm over batches of 1 to 4096 channels and
+* reports the time per channel against the scalar reference, and
+* whether every integral, error, timing, on-time and mask word agreed
+* with the reference bit for bit. The checked run drives each channel
+* with a simple fan model and with random setpoints, including values
+* far outside the limits, so that every saturation is exercised.
+*
+* Build (from the repository root), for the instruction set to test:
+*
+*   gcc -O2 -mavx2 -Ihost -I. tools/batch_bench.c batch_func.c -o batch_bench
+*   gcc -O2 -msse4.1 -Ihost -I. tools/batch_bench.c batch_func.c -o batch_bench
+*   gcc -O2 -mfpu=neon -Ihost -I. tools/batch_bench.c batch_func.c -o batch_bench
+*
+* Usage:
+*
+*   batch_bench [--steps N] [--check-steps N]
+*/
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// Including the controller header under test
+#include "batch_func.h"
+
+// Benchmark constants
+#define DefaultSteps 20000          // Timed updates of each batch
+#define DefaultCheckSteps 2000      // Checked updates of each batch
+#define MaxChannels 4096
+
+static const int Counts[] = {1, 3, 8, 13, 32, 33, 64, 100, 256, 1000, 4096};
+
+/*
+* Arrays of one batch of channels.
+*/
+
+struct Arrays
+{
+    int32_t Setpoint[MaxChannels];
+    int32_t Measured[MaxChannels];
+    int32_t Integral[MaxChannels];
+    int32_t PrevError[MaxChannels];
+    int32_t Timing[MaxChannels];
+    int32_t OnTime[MaxChannels];
+    int32_t Cycle[MaxChannels];
+    uint32_t Mask[MaxChannels/BatchMaskBits];
+};
+
+static struct Arrays Kernel;        // Updated by the batched functions
+static struct Arrays Reference;     // Updated by the scalar references
+
+/*
+* Function: Channels
+* --------------------------------
+* Points a batch at a set of arrays.
+*
+* *Batch: Pointer to the batch to fill in.
+* *Set: Pointer to the arrays.
+* Count: The number of channels.
+*/
+
+static void Channels(struct BatchChannels *Batch, struct Arrays *Set, int Count)
+{
+
+    Batch->Count = Count;
+    Batch->Setpoint = Set->Setpoint;
+    Batch->Measured = Set->Measured;
+    Batch->Integral = Set->Integral;
+    Batch->PrevError = Set->PrevError;
+    Batch->Timing = Set->Timing;
+    Batch->OnTime = Set->OnTime;
+
+}
+
+/*
+* Function: Seconds
+* --------------------------------
+* Reads the monotonic clock.
+*
+* Returns: The time in seconds.
+*/
+
+static double Seconds(void)
+{
+
+    struct timespec Now;
+
+    clock_gettime(CLOCK_MONOTONIC, &Now);
+
+    return Now.tv_sec + Now.tv_nsec*1e-9;
+}
+
+/*
+* Function: Check
+* --------------------------------
+* Runs both versions side by side with the same inputs and compares
+* every output after every step.
+*
+* Count: The number of channels.
+* Steps: The number of steps.
+* *Gains: Pointer to the gains.
+*
+* Returns: 1 if every output agreed or 0 if not.
+*/
+
+static int Check(int Count, int Steps, const struct BatchGains *Gains)
+{
+
+    struct BatchChannels Batch;
+    struct BatchChannels Scalar;
+    int Words = (Count + BatchMaskBits - 1)/BatchMaskBits;
+    int Step;
+    int i;
+
+    memset(&Kernel, 0, sizeof(Kernel));
+    memset(&Reference, 0, sizeof(Reference));
+    Channels(&Batch, &Kernel, Count);
+    Channels(&Scalar, &Reference, Count);
+
+    for (Step = 0; Step < Steps; Step++)
+    {
+        for (i = 0; i < Count; i++)
+        {
+            // Mostly desired speeds, sometimes values far beyond the limits
+            Reference.Setpoint[i] = (rand() % 50 == 0) ? rand() - RAND_MAX/2 : rand() % 51;
+            // A fan heading for its on-time, sometimes a faulty reading
+            Reference.Measured[i] += (Reference.OnTime[i]/2 - Reference.Measured[i])/4;
+            Reference.Measured[i] = (rand() % 100 == 0) ? -rand() : Reference.Measured[i];
+            Reference.Cycle[i] = rand() % 101;
+            Kernel.Setpoint[i] = Reference.Setpoint[i];
+            Kernel.Measured[i] = Reference.Measured[i];
+            Kernel.Cycle[i] = Reference.Cycle[i];
+        }
+
+        BatchPid(&Batch, Gains);
+        BatchPidScalar(&Scalar, Gains);
+        BatchPwm(Count, Kernel.Cycle, Kernel.OnTime, Kernel.Mask);
+        BatchPwmScalar(Count, Reference.Cycle, Reference.OnTime, Reference.Mask);
+
+        if (memcmp(Kernel.Integral, Reference.Integral, Count*sizeof(int32_t)) != 0 ||
+            memcmp(Kernel.PrevError, Reference.PrevError, Count*sizeof(int32_t)) != 0 ||
+            memcmp(Kernel.Timing, Reference.Timing, Count*sizeof(int32_t)) != 0 ||
+            memcmp(Kernel.OnTime, Reference.OnTime, Count*sizeof(int32_t)) != 0 ||
+            memcmp(Kernel.Mask, Reference.Mask, Words*sizeof(uint32_t)) != 0)
+        {
+            fprintf(stderr, "%d channels: mismatch at step %d\n", Count, Step);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/*
+* Function: Time
+* --------------------------------
+* Times one version over a batch of steady inputs.
+*
+* Count: The number of channels.
+* Steps: The number of steps.
+* *Gains: Pointer to the gains.
+* Scalar: Set to time the scalar references instead.
+*
+* Returns: The time per channel and step in nanoseconds.
+*/
+
+static double Time(int Count, int Steps, const struct BatchGains *Gains, int Scalar)
+{
+
+    struct BatchChannels Batch;
+    double Start;
+    int Step;
+
+    Channels(&Batch, &Kernel, Count);
+    Start = Seconds();
+    for (Step = 0; Step < Steps; Step++)
+    {
+        // Moving the cycle count on, as Timer does
+        Kernel.Cycle[Step % Count] = Step % 100;
+        if (Scalar)
+        {
+            BatchPidScalar(&Batch, Gains);
+            BatchPwmScalar(Count, Kernel.Cycle, Kernel.OnTime, Kernel.Mask);
+        }
+        else
+        {
+            BatchPid(&Batch, Gains);
+            BatchPwm(Count, Kernel.Cycle, Kernel.OnTime, Kernel.Mask);
+        }
+    }
+
+    return (Seconds() - Start)*1e9/((double)Steps*Count);
+}
+
+int main(int argc, char **argv)
+{
+
+    // Gains of ClosedLoopController where they can be represented: Kd 0.8 and small Kp and Ki
+    struct BatchGains Gains = {3277, 1, 52429};
+    int Steps = DefaultSteps;
+    int CheckSteps = DefaultCheckSteps;
+    int Failed = 0;
+    double ScalarTime, KernelTime;
+    int Exact;
+    int Arg;
+    int n;
+
+    for (Arg = 1; Arg + 1 < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--steps") == 0)
+        {
+            Steps = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--check-steps") == 0)
+        {
+            CheckSteps = atoi(argv[++Arg]);
+        }
+    }
+    if (Steps < 1 || CheckSteps < 1)
+    {
+        fprintf(stderr, "usage: %s [--steps N] [--check-steps N]\n", argv[0]);
+        return 2;
+    }
+
+    srand(1);
+    printf("kernel %s\n", BatchKernel());
+    printf("%8s %12s %12s %8s %14s %6s\n", "channels", "scalar ns", "kernel ns", "speedup", "Mupdates/s", "exact");
+    for (n = 0; n < (int)(sizeof(Counts)/sizeof(Counts[0])); n++)
+    {
+        Exact = Check(Counts[n], CheckSteps, &Gains);
+        ScalarTime = Time(Counts[n], Steps, &Gains, 1);
+        KernelTime = Time(Counts[n], Steps, &Gains, 0);
+        printf("%8d %12.2f %12.2f %8.2f %14.1f %6s\n", Counts[n], ScalarTime, KernelTime,
+               ScalarTime/KernelTime, 1e3/KernelTime, Exact ? "yes" : "no");
+        Failed = Failed || !Exact;
+    }
+
+    return Failed;
+}
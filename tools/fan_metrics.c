@@ -0,0 +1,376 @@
+/*
+*  fan_metrics.c
+*  reader and exporter for the metrics page
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HOST TOOL FOR READING THE CONTROLLER'S METRICS PAGE                */
+/* ------------------------------------------------------------------ */
+
+/*
+* Maps the metrics page published by the controller (--metrics PATH)
+* read-only and prints it, either once, every --watch milliseconds, or
+* in the Prometheus text format. With --listen the metrics are served
+* over HTTP for a Prometheus server to scrape. Reading the page never
+* involves the controller: a copy is simply retried if it overlapped
+* an update.
+*
+* Build (from the repository root):
+*
+*   gcc -O2 -I. tools/fan_metrics.c -o fan_metrics
+*
+* Usage:
+*
+*   fan_metrics [--watch MS] [--prometheus] [--listen PORT] PAGE
+*/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+
+#include "metrics_func.h"
+
+// Names of the signals and windows of the statistics
+static const char *SignalNames[StatsSignals] = {"speed", "on_time", "error"};
+static const char *WindowNames[StatsWindows] = {"1s", "10s", "60s"};
+
+// Attempts made to take a consistent copy before giving up
+#define ReadAttempts 1000
+
+// Largest response of the exporter
+#define ExportLength 8192
+
+/*
+* Function: ReadPage
+* --------------------------------
+* Takes a consistent copy of the metrics page.
+*
+* *Page: Pointer to the mapped page.
+* *Copy: Pointer to the copy.
+*
+* Returns: 1 if a consistent copy was taken or 0 if the controller was
+* updating the page on every attempt.
+*/
+
+static int ReadPage(const volatile struct MetricsPage *Page, struct MetricsPage *Copy)
+{
+
+    unsigned int Before;
+    int Attempt;
+
+    for (Attempt = 0; Attempt < ReadAttempts; Attempt++)
+    {
+        Before = __atomic_load_n(&Page->Sequence, __ATOMIC_ACQUIRE);
+        if (Before & 0x01)
+        {
+            continue;
+        }
+        memcpy(Copy, (const void *)Page, sizeof(*Copy));
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (Page->Sequence == Before)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+* Function: PrintPage
+* --------------------------------
+* Prints the metrics in a form meant for people.
+*
+* *Copy: Pointer to a consistent copy of the page.
+*/
+
+static void PrintPage(const struct MetricsPage *Copy)
+{
+
+    const struct StatsSummary *Stats;
+    int i;
+    int j;
+
+    printf("loops %u (%u/s)  mode %d  duty %d  on-time %d  desired %d  rps %d  freq %d Hz  temp %.1f C\n",
+           Copy->Loops, Copy->LoopRate, Copy->Mode, Copy->DutyCycle, Copy->OnTime, Copy->DesiredSpeed,
+           Copy->RPS, Copy->PWMFrequency, Copy->Temperature/1000.0);
+    printf("pid P %.3f I %.3f D %.3f  tach edges %u  encoder steps %u missed %u  gpio writes %u\n",
+           Copy->Proportional, Copy->Integral, Copy->Derivative, Copy->TachEdges,
+           Copy->EncoderSteps, Copy->EncoderMissed, Copy->GpioWrites);
+    printf("idle %.1f%%  sleeps %u  mean lateness %.2f us\n", Copy->IdleShare/10.0, Copy->Sleeps,
+           Copy->Sleeps ? Copy->LateTicks*1e6/Copy->ClockFrequency/Copy->Sleeps : 0.0);
+    printf("kicks %u  stalls %u  faults %u  sustain duty %d\n", Copy->Kicks, Copy->Stalls, Copy->Faults,
+           Copy->SustainDuty);
+    printf("shed level %d  misses control %u ui %u leds %u ipc %u display %u metrics %u idle %u\n",
+           Copy->ShedLevel, Copy->Misses[WdogControl], Copy->Misses[WdogUi], Copy->Misses[WdogLeds],
+           Copy->Misses[WdogIpc], Copy->Misses[WdogDisplay], Copy->Misses[WdogMetrics], Copy->Misses[WdogIdle]);
+    for (i = 0; i < StatsSignals; i++)
+    {
+        printf("%-8s", SignalNames[i]);
+        for (j = 0; j < StatsWindows; j++)
+        {
+            Stats = &Copy->Stats[i][j];
+            printf("  %3s min %3d max %3d mean %6.2f sd %5.2f", WindowNames[j], Stats->Min, Stats->Max,
+                   Stats->Mean/100.0, Stats->Deviation/100.0);
+        }
+        printf("\n");
+    }
+    fflush(stdout);
+
+}
+
+/*
+* Function: ExportPage
+* --------------------------------
+* Formats the metrics in the Prometheus text format.
+*
+* *Copy: Pointer to a consistent copy of the page.
+* Text: Buffer of ExportLength bytes for the result.
+*
+* Returns: The length of the text.
+*/
+
+static int ExportPage(const struct MetricsPage *Copy, char *Text)
+{
+
+    static const char *StatNames[4] = {"min", "max", "mean", "variance"};
+    const struct StatsSummary *Stats;
+    double Value;
+    int Length;
+    int i;
+    int j;
+    int k;
+
+    Length = snprintf(Text, ExportLength,
+        "# TYPE fan_loops_total counter\nfan_loops_total %u\n"
+        "# TYPE fan_loop_rate gauge\nfan_loop_rate %u\n"
+        "# TYPE fan_mode gauge\nfan_mode %d\n"
+        "# TYPE fan_duty_cycle gauge\nfan_duty_cycle %d\n"
+        "# TYPE fan_on_time gauge\nfan_on_time %d\n"
+        "# TYPE fan_desired_speed gauge\nfan_desired_speed %d\n"
+        "# TYPE fan_rps gauge\nfan_rps %d\n"
+        "# TYPE fan_pwm_frequency_hertz gauge\nfan_pwm_frequency_hertz %d\n"
+        "# TYPE fan_temperature_celsius gauge\nfan_temperature_celsius %.3f\n"
+        "# TYPE fan_pid_term gauge\nfan_pid_term{term=\"p\"} %g\nfan_pid_term{term=\"i\"} %g\n"
+        "fan_pid_term{term=\"d\"} %g\n"
+        "# TYPE fan_tach_edges_total counter\nfan_tach_edges_total %u\n"
+        "# TYPE fan_encoder_steps_total counter\nfan_encoder_steps_total %u\n"
+        "# TYPE fan_encoder_missed_total counter\nfan_encoder_missed_total %u\n"
+        "# TYPE fan_gpio_writes_total counter\nfan_gpio_writes_total %u\n"
+        "# TYPE fan_idle_seconds_total counter\nfan_idle_seconds_total %.6f\n"
+        "# TYPE fan_sleeps_total counter\nfan_sleeps_total %u\n"
+        "# TYPE fan_wake_late_seconds_total counter\nfan_wake_late_seconds_total %.6f\n"
+        "# TYPE fan_idle_ratio gauge\nfan_idle_ratio %.3f\n"
+        "# TYPE fan_kicks_total counter\nfan_kicks_total %u\n"
+        "# TYPE fan_stalls_total counter\nfan_stalls_total %u\n"
+        "# TYPE fan_stall_faults_total counter\nfan_stall_faults_total %u\n"
+        "# TYPE fan_sustain_duty gauge\nfan_sustain_duty %d\n"
+        "# TYPE fan_deadline_misses_total counter\n"
+        "fan_deadline_misses_total{stage=\"control\"} %u\nfan_deadline_misses_total{stage=\"ui\"} %u\n"
+        "fan_deadline_misses_total{stage=\"leds\"} %u\nfan_deadline_misses_total{stage=\"ipc\"} %u\n"
+        "fan_deadline_misses_total{stage=\"display\"} %u\nfan_deadline_misses_total{stage=\"metrics\"} %u\n"
+        "fan_deadline_misses_total{stage=\"idle\"} %u\n"
+        "# TYPE fan_shed_level gauge\nfan_shed_level %d\n",
+        Copy->Loops, Copy->LoopRate, Copy->Mode, Copy->DutyCycle, Copy->OnTime, Copy->DesiredSpeed,
+        Copy->RPS, Copy->PWMFrequency, Copy->Temperature/1000.0, Copy->Proportional, Copy->Integral,
+        Copy->Derivative, Copy->TachEdges, Copy->EncoderSteps, Copy->EncoderMissed, Copy->GpioWrites,
+        (double)Copy->IdleTicks/Copy->ClockFrequency, Copy->Sleeps, (double)Copy->LateTicks/Copy->ClockFrequency,
+        Copy->IdleShare/1000.0, Copy->Kicks, Copy->Stalls, Copy->Faults, Copy->SustainDuty,
+        Copy->Misses[WdogControl], Copy->Misses[WdogUi], Copy->Misses[WdogLeds], Copy->Misses[WdogIpc],
+        Copy->Misses[WdogDisplay], Copy->Misses[WdogMetrics], Copy->Misses[WdogIdle], Copy->ShedLevel);
+
+    // One gauge per statistic, labelled with its signal and window
+    for (k = 0; k < 4; k++)
+    {
+        Length += snprintf(Text + Length, ExportLength - Length, "# TYPE fan_window_%s gauge\n", StatNames[k]);
+        for (i = 0; i < StatsSignals; i++)
+        {
+            for (j = 0; j < StatsWindows; j++)
+            {
+                Stats = &Copy->Stats[i][j];
+                Value = (k == 0) ? Stats->Min : (k == 1) ? Stats->Max
+                      : (k == 2) ? Stats->Mean/100.0 : Stats->Variance/100.0;
+                Length += snprintf(Text + Length, ExportLength - Length,
+                    "fan_window_%s{signal=\"%s\",window=\"%s\"} %g\n", StatNames[k], SignalNames[i], WindowNames[j], Value);
+            }
+        }
+    }
+
+    return Length;
+}
+
+/*
+* Function: Serve
+* --------------------------------
+* Answers every HTTP request on a port with the current metrics, one
+* connection at a time.
+*
+* *Page: Pointer to the mapped page.
+* Port: TCP port to listen on.
+*
+* Returns: 1 if the port could not be opened (otherwise runs forever).
+*/
+
+static int Serve(const volatile struct MetricsPage *Page, int Port)
+{
+
+    struct sockaddr_in Address;
+    struct MetricsPage Copy;
+    char Request[1024];
+    char Body[ExportLength];
+    char Header[128];
+    int Listener;
+    int Client;
+    int One = 1;
+    int Length;
+
+    Listener = socket(AF_INET, SOCK_STREAM, 0);
+    memset(&Address, 0, sizeof(Address));
+    Address.sin_family = AF_INET;
+    Address.sin_port = htons(Port);
+    Address.sin_addr.s_addr = htonl(INADDR_ANY);
+    setsockopt(Listener, SOL_SOCKET, SO_REUSEADDR, &One, sizeof(One));
+    if (Listener < 0 || bind(Listener, (struct sockaddr *)&Address, sizeof(Address)) != 0 ||
+        listen(Listener, 8) != 0)
+    {
+        perror("listen");
+        return 1;
+    }
+
+    for (;;)
+    {
+        Client = accept(Listener, NULL, NULL);
+        if (Client < 0)
+        {
+            continue;
+        }
+        // The request itself is not looked at; every path gets the metrics
+        if (recv(Client, Request, sizeof(Request), 0) > 0)
+        {
+            if (ReadPage(Page, &Copy))
+            {
+                Length = ExportPage(&Copy, Body);
+                snprintf(Header, sizeof(Header), "HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\n"
+                                                  "Content-Length: %d\r\n\r\n", Length);
+            }
+            else
+            {
+                Length = 0;
+                snprintf(Header, sizeof(Header), "HTTP/1.0 503 Service Unavailable\r\nContent-Length: 0\r\n\r\n");
+            }
+            send(Client, Header, strlen(Header), MSG_NOSIGNAL);
+            send(Client, Body, Length, MSG_NOSIGNAL);
+        }
+        close(Client);
+    }
+}
+
+int main(int argc, char **argv)
+{
+
+    const char *Path = NULL;
+    int Watch = 0;
+    int Prometheus = 0;
+    int Port = 0;
+    int Descriptor;
+    struct stat Status;
+    const volatile struct MetricsPage *Page;
+    struct MetricsPage Copy;
+    char Text[ExportLength];
+    struct timespec Wait;
+    int Arg;
+
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--watch") == 0 && Arg + 1 < argc)
+        {
+            Watch = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--prometheus") == 0)
+        {
+            Prometheus = 1;
+        }
+        else if (strcmp(argv[Arg], "--listen") == 0 && Arg + 1 < argc)
+        {
+            Port = atoi(argv[++Arg]);
+        }
+        else
+        {
+            Path = argv[Arg];
+        }
+    }
+
+    if (Path == NULL)
+    {
+        fprintf(stderr, "usage: %s [--watch MS] [--prometheus] [--listen PORT] PAGE\n", argv[0]);
+        return 2;
+    }
+
+    Descriptor = open(Path, O_RDONLY);
+    if (Descriptor < 0)
+    {
+        perror(Path);
+        return 1;
+    }
+    // A page that is empty or cut short, for instance while the
+    // controller is still creating it, would fault when read
+    if (fstat(Descriptor, &Status) != 0 || Status.st_size < (off_t)sizeof(struct MetricsPage))
+    {
+        fprintf(stderr, "%s: not a metrics page of version %d or later\n", Path, MetricsVersion);
+        close(Descriptor);
+        return 1;
+    }
+    Page = mmap(NULL, sizeof(struct MetricsPage), PROT_READ, MAP_SHARED, Descriptor, 0);
+    close(Descriptor);
+    if (Page == MAP_FAILED)
+    {
+        perror(Path);
+        return 1;
+    }
+
+    // Later versions only add fields at the end, so they can still be read
+    if (Page->Magic != MetricsMagic || Page->Version < MetricsVersion || Page->Size < sizeof(struct MetricsPage))
+    {
+        fprintf(stderr, "%s: not a metrics page of version %d or later\n", Path, MetricsVersion);
+        return 1;
+    }
+
+    if (Port > 0)
+    {
+        return Serve(Page, Port);
+    }
+
+    Wait.tv_sec = Watch/1000;
+    Wait.tv_nsec = (Watch%1000)*1000000L;
+
+    do
+    {
+        if (!ReadPage(Page, &Copy))
+        {
+            fprintf(stderr, "%s: page is being updated continuously\n", Path);
+            return 1;
+        }
+        if (Prometheus)
+        {
+            ExportPage(&Copy, Text);
+            fputs(Text, stdout);
+            fflush(stdout);
+        }
+        else
+        {
+            PrintPage(&Copy);
+        }
+    } while (Watch > 0 && nanosleep(&Wait, NULL) == 0);
+
+    return 0;
+}
@@ -0,0 +1,255 @@
+/*
+*  mpc_gen.c
+*  generator of the model-predictive control table
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HOST TOOL FOR SOLVING THE MPC PROBLEM OFFLINE                      */
+/* ------------------------------------------------------------------ */
+
+/*
+* Solves the constrained model-predictive control problem of mode 6 at
+* every point of the grid in mpc_func.h and writes the first on-time of
+* each solution as a C table, so that the controller only has to look
+* it up. The fan is modelled as a first-order lag from the on-time to
+* the speed,
+*
+*   speed' = (Gain*OnTime - speed)/Tau
+*
+* sampled every half-second, as often as the tachometer measures the
+* speed. The gain and time constant can be read from the results of
+* mode 5 (the gain at the lowest frequency and the frequency at which
+* the phase reaches -45 degrees, Tau = 1/(2*pi*f)).
+*
+* A measurement is the mean speed over the half-second before it, so
+* the speed when the on-time is chosen is predicted from it and the
+* on-time that was applied during that half-second. Over the horizon
+* the controller minimises
+*
+*   sum of (speed - target)^2 + Weight*(change of on-time)^2
+*
+* with the on-time held between 0 and 100, by projected gradient
+* descent.
+*
+* Build and use (from the repository root):
+*
+*   gcc -O2 -I. tools/mpc_gen.c -o mpc_gen -lm
+*   ./mpc_gen [--gain RPS_PER_PERCENT] [--tau SECONDS] [--weight W]
+*             [--horizon STEPS] > mpc_table.c
+*/
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mpc_func.h"
+
+// Default model of the fan: MaxRPS at full on-time, 1 s time constant
+#define DefaultGain 0.42
+#define DefaultTau 1.0
+#define DefaultWeight 0.05
+#define DefaultHorizon 10
+#define MaxHorizon 40
+
+// Sample time of the controller in seconds
+#define SampleTime 0.5
+
+// Iterations of the projected gradient descent
+#define Iterations 400
+
+/*
+* Function: Solve
+* --------------------------------
+* Solves the problem for one point of the grid with accelerated
+* projected gradient descent (FISTA).
+*
+* Measured: The measured (mean) speed in RPS.
+* Target: The target speed in RPS.
+* Previous: The on-time applied while the speed was measured.
+* Gain, Tau, Weight, Horizon: The model and tuning.
+*
+* Returns: The first on-time of the solution (0-100).
+*/
+
+static double Solve(double Measured, double Target, double Previous, double Gain, double Tau, double Weight, int Horizon)
+{
+
+    double Decay = exp(-SampleTime/Tau);
+    double HalfDecay = exp(-SampleTime/(2*Tau));
+    double Step[MaxHorizon][MaxHorizon]; // Effect of each on-time on each future speed
+    double Free[MaxHorizon]; // Future speeds with all on-times at 0
+    double Hessian[MaxHorizon][MaxHorizon] = {{0}};
+    double Linear[MaxHorizon] = {0};
+    double U[MaxHorizon], Y[MaxHorizon], Prev[MaxHorizon], Gradient[MaxHorizon], V[MaxHorizon];
+    double Now, Lipschitz, Norm, T = 1, TNext;
+    int i, j, k, n;
+
+    // Speed when the on-time is chosen, from the middle of the measurement
+    Now = HalfDecay*Measured + (1 - HalfDecay)*Gain*Previous;
+
+    for (i = 0; i < Horizon; i++)
+    {
+        Free[i] = pow(Decay, i + 1)*Now;
+        for (j = 0; j < Horizon; j++)
+        {
+            Step[i][j] = (j <= i) ? pow(Decay, i - j)*(1 - Decay)*Gain : 0;
+        }
+    }
+
+    // Cost = |Step*U + Free - Target|^2 + Weight*|changes of U|^2
+    for (i = 0; i < Horizon; i++)
+    {
+        Linear[i] = 0;
+        for (k = 0; k < Horizon; k++)
+        {
+            Linear[i] += Step[k][i]*(Free[k] - Target);
+        }
+        for (j = 0; j < Horizon; j++)
+        {
+            Hessian[i][j] = 0;
+            for (k = 0; k < Horizon; k++)
+            {
+                Hessian[i][j] += Step[k][i]*Step[k][j];
+            }
+        }
+        Hessian[i][i] += 2*Weight;
+        if (i > 0)
+        {
+            Hessian[i][i - 1] -= Weight;
+            Hessian[i - 1][i] -= Weight;
+        }
+    }
+    Hessian[Horizon - 1][Horizon - 1] -= Weight;
+    Linear[0] -= Weight*Previous;
+
+    // Largest eigenvalue of the Hessian by power iteration
+    for (i = 0; i < Horizon; i++)
+    {
+        V[i] = 1;
+    }
+    Lipschitz = 1;
+    for (n = 0; n < 100; n++)
+    {
+        Norm = 0;
+        for (i = 0; i < Horizon; i++)
+        {
+            Gradient[i] = 0;
+            for (j = 0; j < Horizon; j++)
+            {
+                Gradient[i] += Hessian[i][j]*V[j];
+            }
+            Norm += Gradient[i]*Gradient[i];
+        }
+        Lipschitz = sqrt(Norm);
+        for (i = 0; i < Horizon; i++)
+        {
+            V[i] = Gradient[i]/Lipschitz;
+        }
+    }
+
+    for (i = 0; i < Horizon; i++)
+    {
+        U[i] = Y[i] = Previous;
+    }
+
+    for (n = 0; n < Iterations; n++)
+    {
+        for (i = 0; i < Horizon; i++)
+        {
+            Gradient[i] = Linear[i];
+            for (j = 0; j < Horizon; j++)
+            {
+                Gradient[i] += Hessian[i][j]*Y[j];
+            }
+        }
+        TNext = (1 + sqrt(1 + 4*T*T))/2;
+        for (i = 0; i < Horizon; i++)
+        {
+            Prev[i] = U[i];
+            U[i] = Y[i] - Gradient[i]/Lipschitz;
+            U[i] = (U[i] > 100) ? 100 : (U[i] < 0) ? 0 : U[i];
+        }
+        for (i = 0; i < Horizon; i++)
+        {
+            Y[i] = U[i] + (T - 1)/TNext*(U[i] - Prev[i]);
+        }
+        T = TNext;
+    }
+
+    return U[0];
+}
+
+int main(int argc, char **argv)
+{
+
+    double Gain = DefaultGain;
+    double Tau = DefaultTau;
+    double Weight = DefaultWeight;
+    int Horizon = DefaultHorizon;
+    int Speed, Target, OnTime;
+    int Arg;
+
+    for (Arg = 1; Arg + 1 < argc; Arg += 2)
+    {
+        if (strcmp(argv[Arg], "--gain") == 0)
+        {
+            Gain = atof(argv[Arg + 1]);
+        }
+        else if (strcmp(argv[Arg], "--tau") == 0)
+        {
+            Tau = atof(argv[Arg + 1]);
+        }
+        else if (strcmp(argv[Arg], "--weight") == 0)
+        {
+            Weight = atof(argv[Arg + 1]);
+        }
+        else if (strcmp(argv[Arg], "--horizon") == 0)
+        {
+            Horizon = atoi(argv[Arg + 1]);
+        }
+        else
+        {
+            break;
+        }
+    }
+    if (Arg < argc || Gain <= 0 || Tau <= 0 || Weight < 0 || Horizon < 1 || Horizon > MaxHorizon)
+    {
+        fprintf(stderr, "usage: %s [--gain RPS_PER_PERCENT] [--tau SECONDS] [--weight W] [--horizon STEPS (1-%d)]\n",
+                argv[0], MaxHorizon);
+        return 1;
+    }
+
+    printf("/*\n"
+           "*  mpc_table.c\n"
+           "*  model-predictive control table\n"
+           "*\n"
+           "*  Generated by tools/mpc_gen.c with --gain %g --tau %g --weight %g --horizon %d.\n"
+           "*  Do not edit; run the generator again instead.\n"
+           "*/\n\n", Gain, Tau, Weight, Horizon);
+    printf("#include \"mpc_func.h\"\n\n");
+    printf("const int MpcDecay = %d;\n", (int)lround(exp(-SampleTime/Tau)*256));
+    printf("const int MpcGain = %d;\n\n", (int)lround(Gain*256));
+    printf("// On-time by measured speed, target speed and previous on-time\n");
+    printf("const unsigned char MpcTable[MpcSpeedPoints][MpcTargetPoints][MpcOnTimePoints] = {\n");
+    for (Speed = 0; Speed < MpcSpeedPoints; Speed++)
+    {
+        printf("    {\n");
+        for (Target = 0; Target < MpcTargetPoints; Target++)
+        {
+            printf("        {");
+            for (OnTime = 0; OnTime < MpcOnTimePoints; OnTime++)
+            {
+                printf("%s%3d", OnTime ? ", " : "", (int)lround(Solve(Speed*MpcSpeedStep, Target*MpcSpeedStep,
+                       OnTime*MpcOnTimeStep, Gain, Tau, Weight, Horizon)));
+            }
+            printf("}%s\n", (Target + 1 < MpcTargetPoints) ? "," : "");
+        }
+        printf("    }%s\n", (Speed + 1 < MpcSpeedPoints) ? "," : "");
+    }
+    printf("};\n");
+
+    return 0;
+}
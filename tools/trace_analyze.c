@@ -0,0 +1,862 @@
+/*
+*  trace_analyze.c
+*  offline analyzer for densely sampled GPIO-0 traces
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ----------------------------------------------------------------- */
+/* HOST TOOL FOR ANALYSING LONG TACHOMETER AND ROTARY ENCODER TRACES */
+/* ----------------------------------------------------------------- */
+
+/*
+* The trace is a file of little-endian 32-bit samples of * GpioPort
+* taken every --period counter ticks, starting at counter value
+* --start. Each sample is treated as one pass of the main loop, i.e.
+* one call to InputFilter followed by one call to Tachometer and one
+* call to RotaryEncoder.
+*
+* The tachometer and encoder channels are packed into 64-sample words
+* and every stage after that works on whole words: the N-of-M input
+* filter, edge detection and the per-window edge counts use AVX2 or
+* SSE2 when the compiler targets them and plain 64-bit operations
+* otherwise. Only the held state of the filter is carried from word
+* to word, by propagating it with a single add.
+*
+* --check runs the controller's own InputFilter, Tachometer and
+* RotaryEncoder over the same trace and compares the results.
+*
+* Build (from the repository root):
+*
+*   gcc -O2 -mavx2 -mpopcnt -Ihost -I. tools/trace_analyze.c input_func.c fan_func.c misc_func.c time_func.c -o trace_analyze
+*
+* Usage:
+*
+*   trace_analyze [--period TICKS] [--start TICKS] [--filter N M HOLD]
+*                 [--resp R] [--windows] [--check] FILE
+*/
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define SimdName "avx2"
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SimdName "sse2"
+#else
+#define SimdName "scalar"
+#endif
+
+// Including the controller headers used by --check
+#include "fan_func.h"
+#include "input_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+// Analyzer constants
+#define ChunkWords 16384            // Words (of 64 samples) processed at a time
+#define ChunkSamples (ChunkWords*64)
+#define TachBit 1                   // GPIO-0 pin of the tachometer
+#define EncoderABit 17              // GPIO-0 pin A of the rotary encoder
+#define EncoderBBit 19              // GPIO-0 pin B of the rotary encoder
+#define HistogramBuckets 24         // Power-of-two buckets of the pulse width histogram (us)
+
+// Registers used by the controller functions in --check
+static volatile int Registers[7];
+static volatile unsigned int CounterRegister;
+
+volatile int * LEDs = &Registers[0];
+volatile int * Switches = &Registers[1];
+volatile unsigned int * Counter = &CounterRegister;
+volatile int * Keys = &Registers[2];
+volatile int * GpioPort = &Registers[3];
+volatile int * Hex3to0 = &Registers[5];
+volatile int * Hex5to4 = &Registers[6];
+
+const int ClockFrequency = 50000000;
+int MaxRPS = 42;
+float Kp = 0.000025;
+float Ki = 0.000000000015;
+float Kd = 0.8;
+int EncoderStep = 1;
+
+/*
+* Packed state of one channel. Every array has one extra word at the
+* front holding the last word of the previous chunk, so that streams
+* can be shifted across word boundaries.
+*/
+
+struct Channel
+{
+    uint64_t Raw[ChunkWords + 8];       // Raw samples
+    uint64_t High[ChunkWords + 8];      // At least N of the last M samples high
+    uint64_t Low[ChunkWords + 8];       // At least N of the last M samples low
+    uint64_t Out[ChunkWords + 8];       // Filtered samples
+    int Lock;                           // Samples left in the current hold-off period
+};
+
+/*
+* Results gathered over the whole trace.
+*/
+
+struct Results
+{
+    uint64_t Samples;                       // Number of samples analysed
+    uint64_t RisingEdges;                   // Rising edges of the filtered tachometer
+    uint64_t EncoderUp;                     // Encoder steps that increase the duty cycle
+    uint64_t EncoderDown;                   // Encoder steps that decrease the duty cycle
+    int DutyCycle;                          // Duty cycle after the last step (0-100)
+    int *Rps;                               // RPS reported at the end of every window
+    size_t Windows;                         // Number of entries in Rps
+    size_t Capacity;                        // Allocated entries in Rps
+    uint64_t Histogram[HistogramBuckets];   // Tachometer high pulse widths
+};
+
+// Options
+static unsigned int Period = 50;    // Counter ticks between samples
+static unsigned int Start = 0;      // Counter value of the first sample
+static int FilterN = 2;             // N of the N-of-M input filter
+static int FilterM = 3;             // M of the N-of-M input filter
+static int FilterHold = 0;          // Hold-off of the input filter
+static int Responsiveness = 1;      // Duty cycle change per encoder step
+static int PrintWindows = 0;        // Set to print every half-second window
+
+// Working buffers
+static uint32_t Samples[ChunkSamples];
+static struct Channel Tach, EncA, EncB;
+static uint64_t Rise[ChunkWords + 8], Fall[ChunkWords + 8];
+static uint64_t Up[ChunkWords + 8], Down[ChunkWords + 8];
+
+#if defined(__AVX2__)
+
+// Four words per vector
+typedef __m256i Vec;
+#define VecWords 4
+#define VecLoad(P) _mm256_loadu_si256((const __m256i *)(P))
+#define VecStore(P, V) _mm256_storeu_si256((__m256i *)(P), V)
+#define VecAnd(X, Y) _mm256_and_si256(X, Y)
+#define VecOr(X, Y) _mm256_or_si256(X, Y)
+#define VecXor(X, Y) _mm256_xor_si256(X, Y)
+#define VecAndNot(X, Y) _mm256_andnot_si256(X, Y)
+#define VecZero() _mm256_setzero_si256()
+#define VecOnes() _mm256_set1_epi64x(-1)
+#define VecShiftIn(Cur, Prev, K) \
+    _mm256_or_si256(_mm256_slli_epi64(Cur, K), _mm256_srli_epi64(Prev, 64 - (K)))
+
+#elif defined(__SSE2__)
+
+// Two words per vector
+typedef __m128i Vec;
+#define VecWords 2
+#define VecLoad(P) _mm_loadu_si128((const __m128i *)(P))
+#define VecStore(P, V) _mm_storeu_si128((__m128i *)(P), V)
+#define VecAnd(X, Y) _mm_and_si128(X, Y)
+#define VecOr(X, Y) _mm_or_si128(X, Y)
+#define VecXor(X, Y) _mm_xor_si128(X, Y)
+#define VecAndNot(X, Y) _mm_andnot_si128(X, Y)
+#define VecZero() _mm_setzero_si128()
+#define VecOnes() _mm_set1_epi32(-1)
+#define VecShiftIn(Cur, Prev, K) \
+    _mm_or_si128(_mm_slli_epi64(Cur, K), _mm_srli_epi64(Prev, 64 - (K)))
+
+#else
+
+// One word per "vector"
+typedef uint64_t Vec;
+#define VecWords 1
+#define VecLoad(P) (*(P))
+#define VecStore(P, V) (*(P) = (V))
+#define VecAnd(X, Y) ((X) & (Y))
+#define VecOr(X, Y) ((X) | (Y))
+#define VecXor(X, Y) ((X) ^ (Y))
+#define VecAndNot(X, Y) (~(X) & (Y))
+#define VecZero() ((uint64_t)0)
+#define VecOnes() (~(uint64_t)0)
+#define VecShiftIn(Cur, Prev, K) (((Cur) << (K)) | ((Prev) >> (64 - (K))))
+
+#endif
+
+/*
+* Function: PackChannels
+* --------------------------------
+* Packs the tachometer and encoder pins of every sample into one bit
+* per sample, least significant bit first. The vector paths shift
+* each pin into the sign bit of its 32-bit lane and gather the sign
+* bits with movemask.
+*
+* Count: The number of samples in Samples; the last word is padded
+* with zeros.
+*/
+
+static void PackChannels(size_t Count)
+{
+
+    size_t Word;
+    size_t Words = (Count + 63)/64;
+
+    for (Word = 0; Word < Words; Word++)
+    {
+        const uint32_t *Block = Samples + Word*64;
+        size_t Length = (Count - Word*64 < 64) ? Count - Word*64 : 64;
+        uint64_t T = 0, A = 0, B = 0;
+        size_t i = 0;
+
+#if defined(__AVX2__)
+        for (; i + 8 <= Length; i += 8)
+        {
+            __m256i V = _mm256_loadu_si256((const __m256i *)(Block + i));
+            T |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(V, 31 - TachBit))) << i;
+            A |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(V, 31 - EncoderABit))) << i;
+            B |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_slli_epi32(V, 31 - EncoderBBit))) << i;
+        }
+#elif defined(__SSE2__)
+        for (; i + 4 <= Length; i += 4)
+        {
+            __m128i V = _mm_loadu_si128((const __m128i *)(Block + i));
+            T |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(V, 31 - TachBit))) << i;
+            A |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(V, 31 - EncoderABit))) << i;
+            B |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_slli_epi32(V, 31 - EncoderBBit))) << i;
+        }
+#endif
+        for (; i < Length; i++)
+        {
+            T |= (uint64_t)((Block[i] >> TachBit) & 0x01) << i;
+            A |= (uint64_t)((Block[i] >> EncoderABit) & 0x01) << i;
+            B |= (uint64_t)((Block[i] >> EncoderBBit) & 0x01) << i;
+        }
+
+        Tach.Raw[Word + 1] = T;
+        EncA.Raw[Word + 1] = A;
+        EncB.Raw[Word + 1] = B;
+    }
+
+}
+
+/*
+* Function: VecAtLeast
+* --------------------------------
+* Compares a bit-sliced count against a constant, as CountAtLeast
+* does in InputFilter.
+*
+* Count[]: The four slices of the count.
+* Value: The constant to compare against.
+*
+* Returns: A set bit for every sample whose count is at least Value.
+*/
+
+static inline Vec VecAtLeast(const Vec Count[4], int Value)
+{
+
+    Vec Greater = VecZero();
+    Vec Equal = VecOnes();
+    int i;
+
+    for (i = 3; i >= 0; i--)
+    {
+        if ((Value >> i) & 0x01)
+        {
+            Equal = VecAnd(Equal, Count[i]);
+        }
+        else
+        {
+            Greater = VecOr(Greater, VecAnd(Equal, Count[i]));
+            Equal = VecAndNot(Count[i], Equal);
+        }
+    }
+
+    return VecOr(Greater, Equal);
+}
+
+/*
+* Function: MajorityKernel
+* --------------------------------
+* Computes, for every sample, whether at least N of the last M raw
+* samples are high and whether at least N are low. The number of
+* high samples is built up as a bit-sliced counter from the stream
+* shifted by 0 to M-1 samples and compared against the thresholds.
+* Words that do not fill a vector are padded into the next chunk's
+* history, so the whole chunk is processed with vectors.
+*
+* C: The channel; C->Raw[1..Words] must hold the packed samples.
+* Words: The number of words to process.
+*/
+
+static void MajorityKernel(struct Channel *C, size_t Words)
+{
+
+    size_t Word;
+    int i, k;
+
+    for (Word = 1; Word <= Words; Word += VecWords)
+    {
+        Vec Cur = VecLoad(C->Raw + Word);
+        Vec Prev = VecLoad(C->Raw + Word - 1);
+        Vec Count[4] = {VecZero(), VecZero(), VecZero(), VecZero()};
+        Vec Carry, Slice;
+
+        for (k = 0; k < FilterM; k++)
+        {
+            Carry = (k == 0) ? Cur : VecShiftIn(Cur, Prev, k);
+            for (i = 0; i < 4; i++)
+            {
+                Slice = Count[i];
+                Count[i] = VecXor(Slice, Carry);
+                Carry = VecAnd(Carry, Slice);
+            }
+        }
+
+        VecStore(C->High + Word, VecAtLeast(Count, FilterN));
+        VecStore(C->Low + Word, VecXor(VecAtLeast(Count, FilterM - FilterN + 1), VecOnes()));
+    }
+
+}
+
+/*
+* Function: ResolveChannel
+* --------------------------------
+* Applies the hysteresis and hold-off of the filter. A filtered sample
+* is high if the high rule is met, or if the previous filtered sample
+* was high and the low rule is not met. That is the carry chain of
+* an add, so each word is resolved with one 64-bit add from the state
+* at the end of the previous word. With a hold-off, words in which
+* the state changes (or a hold-off is still running) are resolved
+* sample by sample.
+*
+* C: The channel.
+* Words: The number of words to resolve.
+*/
+
+static void ResolveChannel(struct Channel *C, size_t Words)
+{
+
+    uint64_t State = C->Out[0] >> 63; // Filtered state before the current word
+    size_t Word;
+    int i;
+
+    for (Word = 1; Word <= Words; Word++)
+    {
+        uint64_t G = C->High[Word];
+        uint64_t P = ~(C->High[Word] | C->Low[Word]);
+        uint64_t B = G | P;
+        uint64_t Carries = (G + B + State) ^ G ^ B;
+        uint64_t Result = G | (P & Carries);
+
+        if (FilterHold > 0 && (C->Lock > 0 || Result != (State ? ~(uint64_t)0 : 0)))
+        {
+            uint64_t Cur = State;
+            uint64_t Next;
+
+            Result = 0;
+            for (i = 0; i < 64; i++)
+            {
+                Next = ((G >> i) & 1) ? 1 : (((C->Low[Word] >> i) & 1) ? 0 : Cur);
+                if (C->Lock > 0)
+                {
+                    Next = Cur;
+                    C->Lock--;
+                }
+                else if (Next != Cur)
+                {
+                    C->Lock = FilterHold;
+                }
+                Cur = Next;
+                Result |= Cur << i;
+            }
+        }
+
+        C->Out[Word] = Result;
+        State = Result >> 63;
+    }
+
+}
+
+/*
+* Function: EdgeKernel
+* --------------------------------
+* Finds the rising and falling edges of the filtered tachometer and
+* the encoder steps, as Tachometer and RotaryEncoder see them: pin A
+* changing while A and B differ increases the duty cycle, and pin A
+* changing while they match decreases it.
+*
+* Words: The number of words to process.
+*/
+
+static void EdgeKernel(size_t Words)
+{
+
+    size_t Word;
+
+    for (Word = 1; Word <= Words; Word += VecWords)
+    {
+        Vec T = VecLoad(Tach.Out + Word);
+        Vec TPrev = VecShiftIn(T, VecLoad(Tach.Out + Word - 1), 1);
+        Vec A = VecLoad(EncA.Out + Word);
+        Vec APrev = VecShiftIn(A, VecLoad(EncA.Out + Word - 1), 1);
+        Vec Changed = VecXor(A, APrev);
+        Vec Differ = VecXor(A, VecLoad(EncB.Out + Word));
+
+        VecStore(Rise + Word, VecAndNot(TPrev, T));
+        VecStore(Fall + Word, VecAndNot(T, TPrev));
+        VecStore(Up + Word, VecAnd(Changed, Differ));
+        VecStore(Down + Word, VecAndNot(Differ, Changed));
+    }
+
+}
+
+/*
+* Function: RangeCount
+* --------------------------------
+* Counts the set bits of a packed array between two sample positions.
+*
+* Bits: The packed array (word 1 holds samples 0-63).
+* From: First sample position.
+* To: Sample position after the last one.
+*
+* Returns: The number of set bits.
+*/
+
+static uint64_t RangeCount(const uint64_t *Bits, size_t From, size_t To)
+{
+
+    uint64_t Total = 0;
+    size_t First = From/64 + 1;
+    size_t Last = To/64 + 1;
+    size_t Word;
+
+    if (From >= To)
+    {
+        return 0;
+    }
+    if (First == Last)
+    {
+        return __builtin_popcountll(Bits[First] & (((uint64_t)1 << (To % 64)) - 1) & (~(uint64_t)0 << (From % 64)));
+    }
+
+    Total += __builtin_popcountll(Bits[First] & (~(uint64_t)0 << (From % 64)));
+    Word = First + 1;
+
+#if defined(__AVX2__)
+    // Counting four words at a time with a nibble lookup table
+    {
+        const __m256i Table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i Nibble = _mm256_set1_epi8(0x0F);
+        __m256i Sum = _mm256_setzero_si256();
+        uint64_t Lanes[4];
+
+        for (; Word + 4 <= Last; Word += 4)
+        {
+            __m256i V = _mm256_loadu_si256((const __m256i *)(Bits + Word));
+            __m256i Count = _mm256_add_epi8(_mm256_shuffle_epi8(Table, _mm256_and_si256(V, Nibble)),
+                                            _mm256_shuffle_epi8(Table, _mm256_and_si256(_mm256_srli_epi16(V, 4), Nibble)));
+            Sum = _mm256_add_epi64(Sum, _mm256_sad_epu8(Count, _mm256_setzero_si256()));
+        }
+        _mm256_storeu_si256((__m256i *)Lanes, Sum);
+        Total += Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+    }
+#endif
+    for (; Word < Last; Word++)
+    {
+        Total += __builtin_popcountll(Bits[Word]);
+    }
+
+    if (To % 64)
+    {
+        Total += __builtin_popcountll(Bits[Last] & (((uint64_t)1 << (To % 64)) - 1));
+    }
+
+    return Total;
+}
+
+/*
+* Function: WindowIndex
+* --------------------------------
+* Works out the half-second window Tachometer sees for a sample, from
+* the 64-bit time at that sample (see TimeUpdate).
+*
+* Sample: Position of the sample in the trace.
+*
+* Returns: The time divided by half a second.
+*/
+
+static uint64_t WindowIndex(uint64_t Sample)
+{
+
+    return ((uint64_t)Start + Sample*Period)/(ClockFrequency/2);
+}
+
+/*
+* Function: NextWindowChange
+* --------------------------------
+* Finds the first sample after a given one at which Tachometer starts
+* a new half-second window, i.e. the next half-second boundary of the
+* 64-bit time. The wrap of the 32-bit counter does not start a window.
+*
+* Sample: Position of the sample in the trace.
+*
+* Returns: Position of the next sample in a different window.
+*/
+
+static uint64_t NextWindowChange(uint64_t Sample)
+{
+
+    uint64_t Next = (WindowIndex(Sample) + 1)*(uint64_t)(ClockFrequency/2);
+
+    return (Next - Start + Period - 1)/Period;
+}
+
+/*
+* Function: AddWindow
+* --------------------------------
+* Stores the RPS reported at the end of a window.
+*
+* R: The results.
+* Rps: The RPS value.
+*/
+
+static void AddWindow(struct Results *R, int Rps)
+{
+
+    if (R->Windows == R->Capacity)
+    {
+        R->Capacity = R->Capacity ? R->Capacity*2 : 1024;
+        R->Rps = realloc(R->Rps, R->Capacity*sizeof(int));
+    }
+    R->Rps[R->Windows++] = Rps;
+
+}
+
+/*
+* Function: Analyze
+* --------------------------------
+* Runs the packed analysis over the whole trace.
+*
+* File: The trace file.
+* R: The results.
+*
+* Returns: 1 on success or 0 if the file could not be read.
+*/
+
+static int Analyze(FILE *File, struct Results *R)
+{
+
+    uint64_t Base = 0; // Position of the first sample of the chunk
+    uint64_t Change; // Position of the next window change
+    uint64_t CountFrom = 0; // Position from which rising edges count towards the window
+    uint64_t StepFrom = 0; // Position from which encoder steps count towards the window
+    uint64_t HalfRevolutions = 0; // Rising edges in the current window
+    int64_t LastRise = -1; // Position of the last rising edge
+    size_t Count, Words, Word;
+
+    memset(&Tach, 0, sizeof(Tach));
+    memset(&EncA, 0, sizeof(EncA));
+    memset(&EncB, 0, sizeof(EncB));
+    memset(Rise, 0, sizeof(Rise));
+    memset(Fall, 0, sizeof(Fall));
+    memset(Up, 0, sizeof(Up));
+    memset(Down, 0, sizeof(Down));
+
+    // Tachometer starts with a previous count of zero
+    Change = (WindowIndex(0) != 0) ? 0 : NextWindowChange(0);
+
+    while ((Count = fread(Samples, sizeof(uint32_t), ChunkSamples, File)) > 0)
+    {
+        Words = (Count + 63)/64;
+
+        PackChannels(Count);
+        MajorityKernel(&Tach, Words);
+        MajorityKernel(&EncA, Words);
+        MajorityKernel(&EncB, Words);
+        ResolveChannel(&Tach, Words);
+        ResolveChannel(&EncA, Words);
+        ResolveChannel(&EncB, Words);
+        EdgeKernel(Words);
+
+        // Closing every window that ends in this chunk; the rising edge
+        // on the sample that closes a window is not counted
+        while (Change < Base + Count)
+        {
+            HalfRevolutions += RangeCount(Rise, CountFrom - Base, Change - Base);
+            AddWindow(R, (int)HalfRevolutions);
+
+            if (PrintWindows)
+            {
+                uint64_t Ups = RangeCount(Up, StepFrom - Base, Change - Base);
+                uint64_t Downs = RangeCount(Down, StepFrom - Base, Change - Base);
+                printf("window %8zu  t=%12.6f s  rps=%3" PRIu64 "  up=%" PRIu64 " down=%" PRIu64 "\n",
+                       R->Windows, (double)(Change*Period)/ClockFrequency, HalfRevolutions, Ups, Downs);
+            }
+
+            R->RisingEdges += HalfRevolutions;
+            HalfRevolutions = 0;
+            CountFrom = Change + 1;
+            StepFrom = Change;
+            Change = NextWindowChange(Change);
+        }
+        if (CountFrom < Base + Count)
+        {
+            HalfRevolutions += RangeCount(Rise, CountFrom - Base, Count);
+            CountFrom = Base + Count;
+        }
+        if (StepFrom < Base)
+        {
+            StepFrom = Base;
+        }
+
+        // Walking the (rare) edges and steps in order for the pulse widths
+        // and the clamped duty cycle
+        for (Word = 1; Word <= Words; Word++)
+        {
+            uint64_t Edges = Rise[Word] | Fall[Word];
+            uint64_t Steps = Up[Word] | Down[Word];
+
+            while (Edges)
+            {
+                int Bit = __builtin_ctzll(Edges);
+                int64_t Position = (int64_t)(Base + (Word - 1)*64 + Bit);
+
+                Edges &= Edges - 1;
+                if ((size_t)((Word - 1)*64 + Bit) >= Count)
+                {
+                    break;
+                }
+                if ((Rise[Word] >> Bit) & 1)
+                {
+                    LastRise = Position;
+                }
+                else if (LastRise >= 0)
+                {
+                    uint64_t Micros = (uint64_t)(Position - LastRise)*Period/(ClockFrequency/1000000);
+                    int Bucket = 0;
+
+                    while (Micros > 1 && Bucket < HistogramBuckets - 1)
+                    {
+                        Micros >>= 1;
+                        Bucket++;
+                    }
+                    R->Histogram[Bucket]++;
+                    LastRise = -1;
+                }
+            }
+
+            while (Steps)
+            {
+                int Bit = __builtin_ctzll(Steps);
+
+                Steps &= Steps - 1;
+                if ((size_t)((Word - 1)*64 + Bit) >= Count)
+                {
+                    break;
+                }
+                if ((Up[Word] >> Bit) & 1)
+                {
+                    R->EncoderUp++;
+                    R->DutyCycle += Responsiveness;
+                }
+                else
+                {
+                    R->EncoderDown++;
+                    R->DutyCycle -= Responsiveness;
+                }
+                R->DutyCycle = (R->DutyCycle > 100) ? 100 : R->DutyCycle;
+                R->DutyCycle = (R->DutyCycle < 0) ? 0 : R->DutyCycle;
+            }
+        }
+
+        // Carrying the last word of every array into the next chunk
+        Tach.Raw[0] = Tach.Raw[Words];
+        EncA.Raw[0] = EncA.Raw[Words];
+        EncB.Raw[0] = EncB.Raw[Words];
+        Tach.Out[0] = Tach.Out[Words];
+        EncA.Out[0] = EncA.Out[Words];
+        EncB.Out[0] = EncB.Out[Words];
+
+        Base += Count;
+    }
+
+    R->Samples = Base;
+
+    return !ferror(File);
+}
+
+/*
+* Function: Reference
+* --------------------------------
+* Runs the controller's own InputFilter, Tachometer and RotaryEncoder
+* over the trace one sample at a time.
+*
+* File: The trace file.
+* R: The results.
+*
+* Returns: 1 on success or 0 if the file could not be read.
+*/
+
+static int Reference(FILE *File, struct Results *R)
+{
+
+    uint64_t Sample = 0;
+    uint64_t PrevCount = 0;
+    unsigned int GpioInputs;
+    int Rps = 0;
+    size_t Count, i;
+
+    InputFilterConfig(FilterN, FilterM, FilterHold);
+
+    while ((Count = fread(Samples, sizeof(uint32_t), ChunkSamples, File)) > 0)
+    {
+        for (i = 0; i < Count; i++, Sample++)
+        {
+            *Counter = (unsigned int)(Start + Sample*Period);
+            TimeUpdate();
+
+            GpioInputs = InputFilter(Samples[i]);
+            Rps = Tachometer(Rps, GpioInputs);
+            R->DutyCycle = RotaryEncoder(R->DutyCycle, Responsiveness, GpioInputs);
+
+            if (TimeNow()/(ClockFrequency/2) != PrevCount)
+            {
+                AddWindow(R, Rps);
+            }
+            PrevCount = TimeNow()/(ClockFrequency/2);
+        }
+    }
+
+    R->Samples = Sample;
+
+    return !ferror(File);
+}
+
+int main(int argc, char **argv)
+{
+
+    const char *Path = NULL;
+    int Check = 0;
+    struct Results Packed, Scalar;
+    FILE *File;
+    clock_t Begin;
+    double PackedSeconds, ScalarSeconds;
+    size_t i;
+    int Arg;
+
+    for (Arg = 1; Arg < argc; Arg++)
+    {
+        if (strcmp(argv[Arg], "--period") == 0 && Arg + 1 < argc)
+        {
+            Period = strtoul(argv[++Arg], NULL, 0);
+        }
+        else if (strcmp(argv[Arg], "--start") == 0 && Arg + 1 < argc)
+        {
+            Start = strtoul(argv[++Arg], NULL, 0);
+        }
+        else if (strcmp(argv[Arg], "--filter") == 0 && Arg + 3 < argc)
+        {
+            FilterN = atoi(argv[++Arg]);
+            FilterM = atoi(argv[++Arg]);
+            FilterHold = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--resp") == 0 && Arg + 1 < argc)
+        {
+            Responsiveness = atoi(argv[++Arg]);
+        }
+        else if (strcmp(argv[Arg], "--windows") == 0)
+        {
+            PrintWindows = 1;
+        }
+        else if (strcmp(argv[Arg], "--check") == 0)
+        {
+            Check = 1;
+        }
+        else
+        {
+            Path = argv[Arg];
+        }
+    }
+
+    if (Path == NULL || Period == 0)
+    {
+        fprintf(stderr, "usage: %s [--period TICKS] [--start TICKS] [--filter N M HOLD] "
+                        "[--resp R] [--windows] [--check] FILE\n", argv[0]);
+        return 2;
+    }
+
+    // Restricting the filter settings as InputFilterConfig does
+    FilterM = (FilterM > FilterMaxWindow) ? FilterMaxWindow : FilterM;
+    FilterM = (FilterM < 1) ? 1 : FilterM;
+    FilterHold = (FilterHold > FilterMaxHoldOff) ? FilterMaxHoldOff : FilterHold;
+    FilterHold = (FilterHold < 0) ? 0 : FilterHold;
+    FilterN = (FilterN > FilterM) ? FilterM : FilterN;
+    FilterN = (FilterN <= FilterM/2) ? FilterM/2 + 1 : FilterN;
+
+    File = fopen(Path, "rb");
+    if (File == NULL)
+    {
+        fprintf(stderr, "%s: cannot open %s\n", argv[0], Path);
+        return 1;
+    }
+
+    memset(&Packed, 0, sizeof(Packed));
+    Begin = clock();
+    if (!Analyze(File, &Packed))
+    {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], Path);
+        return 1;
+    }
+    PackedSeconds = (double)(clock() - Begin)/CLOCKS_PER_SEC;
+
+    printf("kernel:          %s\n", SimdName);
+    printf("samples:         %" PRIu64 " (%.3f s of trace)\n", Packed.Samples,
+           (double)(Packed.Samples*Period)/ClockFrequency);
+    printf("filter:          %d of %d, hold-off %d\n", FilterN, FilterM, FilterHold);
+    printf("windows:         %zu\n", Packed.Windows);
+    printf("rising edges:    %" PRIu64 "\n", Packed.RisingEdges);
+    printf("encoder steps:   +%" PRIu64 " -%" PRIu64 " (duty cycle %d)\n",
+           Packed.EncoderUp, Packed.EncoderDown, Packed.DutyCycle);
+    printf("analysis time:   %.3f s (%.0f Msamples/s)\n", PackedSeconds,
+           PackedSeconds > 0 ? Packed.Samples/PackedSeconds/1e6 : 0.0);
+    printf("tach high pulse widths:\n");
+    for (i = 0; i < HistogramBuckets; i++)
+    {
+        if (Packed.Histogram[i])
+        {
+            printf("  %8lu-%-8lu us  %" PRIu64 "\n", i ? 1ul << i : 0ul, (2ul << i) - 1, Packed.Histogram[i]);
+        }
+    }
+
+    if (Check)
+    {
+        rewind(File);
+        memset(&Scalar, 0, sizeof(Scalar));
+        Begin = clock();
+        Reference(File, &Scalar);
+        ScalarSeconds = (double)(clock() - Begin)/CLOCKS_PER_SEC;
+
+        printf("reference time:  %.3f s\n", ScalarSeconds);
+        if (Scalar.Windows != Packed.Windows || Scalar.DutyCycle != Packed.DutyCycle ||
+            (Packed.Windows && memcmp(Scalar.Rps, Packed.Rps, Packed.Windows*sizeof(int)) != 0))
+        {
+            for (i = 0; i < Packed.Windows && i < Scalar.Windows; i++)
+            {
+                if (Packed.Rps[i] != Scalar.Rps[i])
+                {
+                    break;
+                }
+            }
+            printf("check:           MISMATCH (windows %zu/%zu, first difference at window %zu, duty cycle %d/%d)\n",
+                   Packed.Windows, Scalar.Windows, i, Packed.DutyCycle, Scalar.DutyCycle);
+            return 1;
+        }
+        printf("check:           matches Tachometer and RotaryEncoder\n");
+    }
+
+    fclose(File);
+
+    return 0;
+}
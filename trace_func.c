@@ -0,0 +1,619 @@
+/*
+*  trace_func.c
+*  trace functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------- */
+/* SOURCE FILE FOR FUNCTIONS USED TO RECORD AND REPLAY BOARD INPUTS */
+/* ---------------------------------------------------------------- */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "trace_func.h"
+
+// Including other necessary custom headers
+#include "misc_func.h"
+#include "globals.h"
+
+// Recorder constants
+#define TraceBufferSize 4096        // Bytes buffered before they are written to the file
+#define TraceKeepAlive 0x40000000u  // Longest gap between records, kept well inside the counter wrap
+
+// Replay constants
+#define ReplayFineStep 50           // Ticks per loop pass just after an input change (1 us)
+#define ReplaySettlePasses 16       // Loop passes that use the fine step after a change
+
+/*
+* A single record: the time since the previous record and the bits
+* of * GpioPort, * Switches and * Keys that changed (as an XOR mask).
+*/
+
+struct TraceEntry
+{
+    unsigned int Delta;         // Counter ticks since the previous record
+    int Mask;                   // TraceGpio, TraceSwitches and TraceKeys bits
+    unsigned int Change[3];     // Changed bits of each input
+};
+
+// Recorder state
+static FILE *RecordFile;                                // File the trace is written to
+static unsigned char Buffer[TraceBufferSize];           // Encoded records waiting to be written
+static int BufferLength;                                // Number of bytes in Buffer
+static unsigned int RecordTime;                         // Counter value of the last record
+static unsigned int RecordValue[3];                     // Input values at the last record
+static struct TraceEntry RecordHistory[TraceMaxPeriod]; // Last records, most recent first
+static int RecordHistoryLength;                         // Number of valid entries in RecordHistory
+static int RunPeriod;                                   // Period of the pattern being repeated (0 if none)
+static unsigned int RunCount;                           // Number of records repeated so far
+
+// Replay state
+static FILE *ReplayFile;                                // File the trace is read from
+static unsigned long long ReplayTime;                   // Replayed time in counter ticks
+static unsigned long long EventTime;                    // Time of the next record
+static struct TraceEntry Event;                         // Next record to apply
+static int EventValid;                                  // Set while Event holds a record
+static unsigned int ReplayValue[3];                     // Replayed input values
+static struct TraceEntry ReplayHistory[TraceMaxPeriod]; // Last records, most recent first
+static int ReplayHistoryLength;                         // Number of valid entries in ReplayHistory
+static int RepeatPeriod;                                // Period of the pattern being repeated
+static unsigned int RepeatLeft;                         // Number of records still to be repeated
+static unsigned int CoarseStep;                         // Ticks per loop pass while inputs are idle
+static int Settle;                                      // Loop passes left that use the fine step
+static unsigned long long ReplayRecords;                // Number of records applied
+static unsigned long long ReplayPasses;                 // Number of loop passes replayed
+static clock_t ReplayStartClock;                        // Processor time at the start of the replay
+
+/*
+* Function: PushHistory
+* --------------------------------
+* Adds a record to the front of a history of recent records, which
+* is used to detect and expand repeated patterns.
+*
+* History[]: The history, most recent record first.
+* *Length: Pointer to the number of valid entries in the history.
+* Entry: The record to add.
+*/
+
+static void PushHistory(struct TraceEntry History[], int *Length, struct TraceEntry Entry)
+{
+
+    int i;
+
+    for (i = TraceMaxPeriod - 1; i > 0; i--)
+    {
+        History[i] = History[i-1];
+    }
+    History[0] = Entry;
+
+    Set(Length, (*Length < TraceMaxPeriod) ? *Length + 1 : TraceMaxPeriod);
+
+}
+
+/*
+* Function: WriteByte
+* --------------------------------
+* Appends a byte to the record buffer, writing the buffer to the
+* trace file when it is full.
+*
+* Byte: The byte to append.
+*/
+
+static void WriteByte(int Byte)
+{
+
+    if (BufferLength >= TraceBufferSize)
+    {
+        fwrite(Buffer, 1, BufferLength, RecordFile);
+        BufferLength = 0;
+    }
+
+    Buffer[BufferLength++] = (unsigned char)Byte;
+
+}
+
+/*
+* Function: WriteVarint
+* --------------------------------
+* Appends an unsigned integer to the record buffer using seven bits
+* per byte, so that small values take a single byte.
+*
+* Value: The integer to append.
+*/
+
+static void WriteVarint(unsigned int Value)
+{
+
+    while (Value >= 0x80)
+    {
+        WriteByte((Value & 0x7F) | 0x80);
+        Value >>= 7;
+    }
+    WriteByte(Value);
+
+}
+
+/*
+* Function: FlushRun
+* --------------------------------
+* Writes the repeat record for the pattern currently being repeated,
+* if there is one.
+*/
+
+static void FlushRun(void)
+{
+
+    if (RunPeriod)
+    {
+        WriteByte(TraceRepeat | RunPeriod);
+        WriteVarint(RunCount);
+        RunPeriod = 0;
+        RunCount = 0;
+    }
+
+}
+
+/*
+* Function: SameEntry
+* --------------------------------
+* Compares two records.
+*
+* A, B: The records to compare.
+*
+* Returns: 1 if the records are identical or 0 if not.
+*/
+
+static int SameEntry(struct TraceEntry A, struct TraceEntry B)
+{
+
+    return A.Delta == B.Delta && A.Mask == B.Mask &&
+           A.Change[0] == B.Change[0] && A.Change[1] == B.Change[1] && A.Change[2] == B.Change[2];
+}
+
+/*
+* Function: EmitRecord
+* --------------------------------
+* Encodes a record. A record that repeats the pattern of the last
+* 1-4 records is folded into a run, so a steady signal costs a few
+* bytes however long it lasts; any other record is written as a tag
+* followed by the time delta and the XOR mask of each changed input.
+*
+* Entry: The record to encode.
+*/
+
+static void EmitRecord(struct TraceEntry Entry)
+{
+
+    int Period;
+    int i;
+
+    // Extending the current run if the record continues its pattern
+    if (RunPeriod && SameEntry(Entry, RecordHistory[RunPeriod - 1]))
+    {
+        RunCount++;
+        PushHistory(RecordHistory, &RecordHistoryLength, Entry);
+        return;
+    }
+    FlushRun();
+
+    // Starting a new run if the record matches one of the recent records
+    for (Period = 1; Period <= RecordHistoryLength; Period++)
+    {
+        if (SameEntry(Entry, RecordHistory[Period - 1]))
+        {
+            RunPeriod = Period;
+            RunCount = 1;
+            PushHistory(RecordHistory, &RecordHistoryLength, Entry);
+            return;
+        }
+    }
+
+    // Writing the record in full
+    WriteByte(Entry.Mask);
+    WriteVarint(Entry.Delta);
+    for (i = 0; i < 3; i++)
+    {
+        if (Entry.Mask & (1 << i))
+        {
+            WriteVarint(Entry.Change[i]);
+        }
+    }
+
+    PushHistory(RecordHistory, &RecordHistoryLength, Entry);
+
+}
+
+/*
+* Function: TraceRecordStart
+* --------------------------------
+* Creates a trace file and writes its header. The values of the
+* inputs at this point are written as the first record.
+*
+* Path: The path of the trace file.
+*
+* Returns: 1 if recording has started or 0 if the file could not
+* be created.
+*/
+
+int TraceRecordStart(const char *Path)
+{
+
+    unsigned char Header[TraceHeaderSize] = {0};
+
+    RecordFile = fopen(Path, "wb");
+    if (RecordFile == NULL)
+    {
+        return 0;
+    }
+
+    // Magic, version and the clock frequency (little-endian)
+    memcpy(Header, TraceMagic, 8);
+    Header[8] = TraceVersion;
+    Header[12] = ClockFrequency & 0xFF;
+    Header[13] = (ClockFrequency >> 8) & 0xFF;
+    Header[14] = (ClockFrequency >> 16) & 0xFF;
+    Header[15] = (ClockFrequency >> 24) & 0xFF;
+    fwrite(Header, 1, TraceHeaderSize, RecordFile);
+
+    // All inputs are taken to start at zero at counter value zero
+    BufferLength = 0;
+    RecordTime = 0;
+    RecordValue[0] = 0;
+    RecordValue[1] = 0;
+    RecordValue[2] = 0;
+    RecordHistoryLength = 0;
+    RunPeriod = 0;
+    RunCount = 0;
+
+    return 1;
+}
+
+/*
+* Function: TraceRecord
+* --------------------------------
+* Reads * GpioPort, * Switches and * Keys and records the inputs that
+* changed since the previous call, timestamped with * Counter. Pins
+* that are driven by the controller (set in the data direction
+* register) are left out. Nothing is written while the inputs are
+* idle apart from a short record every ~21 seconds that keeps the
+* timestamps unambiguous across counter wraps.
+*/
+
+void TraceRecord(void)
+{
+
+    struct TraceEntry Entry; // Record describing the changes
+    unsigned int Value[3]; // Current input values
+    unsigned int Now; // Current value of the counter
+    int i;
+
+    if (RecordFile == NULL)
+    {
+        return;
+    }
+
+    Now = *Counter;
+    Value[0] = *GpioPort & ~*(GpioPort + 1);
+    Value[1] = *Switches;
+    Value[2] = *Keys;
+
+    Entry.Mask = 0;
+    for (i = 0; i < 3; i++)
+    {
+        Entry.Change[i] = Value[i] ^ RecordValue[i];
+        Entry.Mask |= (Entry.Change[i] != 0) << i;
+    }
+
+    // Only writing a record if an input changed or the keep-alive is due
+    if (Entry.Mask || (Now - RecordTime) >= TraceKeepAlive)
+    {
+        Entry.Delta = Now - RecordTime;
+        EmitRecord(Entry);
+
+        RecordTime = Now;
+        for (i = 0; i < 3; i++)
+        {
+            RecordValue[i] = Value[i];
+        }
+    }
+
+}
+
+/*
+* Function: TraceRecordStop
+* --------------------------------
+* Writes any pending run and buffered records and closes the trace
+* file.
+*/
+
+void TraceRecordStop(void)
+{
+
+    if (RecordFile == NULL)
+    {
+        return;
+    }
+
+    FlushRun();
+    fwrite(Buffer, 1, BufferLength, RecordFile);
+    fclose(RecordFile);
+
+    RecordFile = NULL;
+    BufferLength = 0;
+
+}
+
+/*
+* Function: ReadVarint
+* --------------------------------
+* Reads an unsigned integer written by WriteVarint.
+*
+* *Value: Pointer to the integer that is set to the value read.
+*
+* Returns: 1 if a value was read or 0 at the end of the file.
+*/
+
+static int ReadVarint(unsigned int *Value)
+{
+
+    int Byte;
+    int Shift = 0;
+
+    *Value = 0;
+    do
+    {
+        Byte = fgetc(ReplayFile);
+        if (Byte == EOF)
+        {
+            return 0;
+        }
+        *Value |= (unsigned int)(Byte & 0x7F) << Shift;
+        Shift += 7;
+    } while (Byte & 0x80);
+
+    return 1;
+}
+
+/*
+* Function: NextEvent
+* --------------------------------
+* Decodes the next record of the trace into Event, expanding runs of
+* repeated records.
+*
+* Returns: 1 if a record was decoded or 0 at the end of the trace.
+*/
+
+static int NextEvent(void)
+{
+
+    int Tag;
+    int i;
+
+    // Taking the next record of a run from the history
+    if (RepeatLeft == 0)
+    {
+        Tag = fgetc(ReplayFile);
+        if (Tag == EOF)
+        {
+            return 0;
+        }
+
+        if (Tag & TraceRepeat)
+        {
+            RepeatPeriod = Tag & 0x07;
+            if (RepeatPeriod < 1 || RepeatPeriod > ReplayHistoryLength || !ReadVarint(&RepeatLeft))
+            {
+                return 0;
+            }
+        }
+        else
+        {
+            Event.Mask = Tag & 0x07;
+            if (!ReadVarint(&Event.Delta))
+            {
+                return 0;
+            }
+            for (i = 0; i < 3; i++)
+            {
+                Event.Change[i] = 0;
+                if ((Event.Mask & (1 << i)) && !ReadVarint(&Event.Change[i]))
+                {
+                    return 0;
+                }
+            }
+        }
+    }
+
+    if (RepeatLeft > 0)
+    {
+        Event = ReplayHistory[RepeatPeriod - 1];
+        RepeatLeft--;
+    }
+
+    PushHistory(ReplayHistory, &ReplayHistoryLength, Event);
+    EventTime += Event.Delta;
+
+    return 1;
+}
+
+/*
+* Function: ApplyEvents
+* --------------------------------
+* Applies every record up to the replayed time to the input registers.
+* The bits of * GpioPort that are driven by the controller are kept.
+*
+* Returns: The number of records applied.
+*/
+
+static int ApplyEvents(void)
+{
+
+    int Applied = 0;
+    unsigned int Driven = *(GpioPort + 1); // Pins driven by the controller
+
+    while (EventValid && EventTime <= ReplayTime)
+    {
+        ReplayValue[0] ^= Event.Change[0];
+        ReplayValue[1] ^= Event.Change[1];
+        ReplayValue[2] ^= Event.Change[2];
+        Applied++;
+
+        EventValid = NextEvent();
+    }
+
+    if (Applied)
+    {
+        *GpioPort = (*GpioPort & Driven) | (ReplayValue[0] & ~Driven);
+        *Switches = ReplayValue[1];
+        *Keys = ReplayValue[2];
+        ReplayRecords += Applied;
+    }
+
+    *Counter = (unsigned int)ReplayTime;
+
+    return Applied;
+}
+
+/*
+* Function: TraceReplayStart
+* --------------------------------
+* Opens a trace file for replay into the input registers, which must
+* be backed by memory rather than the FPGA. The replayed time moves
+* forward by Step ticks per loop pass while the inputs are idle and
+* by 1 us per loop pass just after they change, so that the input
+* filter sees each change over several passes as it would on the
+* board. A pass never moves past the next record, so each change is
+* applied at its recorded time; idle stretches are still replayed
+* pass by pass, as the controller's timers run from the replayed time.
+*
+* Path: The path of the trace file.
+* Step: Counter ticks per loop pass while the inputs are idle.
+*
+* Returns: 1 if the trace was opened or 0 if the file could not be
+* opened or is not a trace file.
+*/
+
+int TraceReplayStart(const char *Path, unsigned int Step)
+{
+
+    unsigned char Header[TraceHeaderSize];
+
+    ReplayFile = fopen(Path, "rb");
+    if (ReplayFile == NULL)
+    {
+        return 0;
+    }
+
+    if (fread(Header, 1, TraceHeaderSize, ReplayFile) != TraceHeaderSize ||
+        memcmp(Header, TraceMagic, 8) != 0 || Header[8] != TraceVersion)
+    {
+        fclose(ReplayFile);
+        ReplayFile = NULL;
+        return 0;
+    }
+
+    ReplayTime = 0;
+    EventTime = 0;
+    ReplayValue[0] = 0;
+    ReplayValue[1] = 0;
+    ReplayValue[2] = 0;
+    ReplayHistoryLength = 0;
+    RepeatLeft = 0;
+    CoarseStep = (Step < ReplayFineStep) ? ReplayFineStep : Step;
+    Settle = 0;
+    ReplayRecords = 0;
+    ReplayPasses = 0;
+    ReplayStartClock = clock();
+
+    // Applying the values at the start of the trace
+    EventValid = NextEvent();
+    ReplayTime = EventTime;
+    ApplyEvents();
+
+    return 1;
+}
+
+/*
+* Function: TraceReplayPoll
+* --------------------------------
+* Advances the replayed time by one loop pass, stopping at the next
+* record if it comes first, and applies the inputs that changed.
+*
+* Returns: 1 while the trace is being replayed or 0 once it has
+* ended.
+*/
+
+int TraceReplayPoll(void)
+{
+
+    unsigned long long Next; // Replayed time at the end of this pass
+
+    if (ReplayFile == NULL || !EventValid)
+    {
+        return 0;
+    }
+
+    Next = ReplayTime + ((Settle > 0) ? ReplayFineStep : CoarseStep);
+    Next = (EventTime < Next) ? EventTime : Next;
+    ReplayTime = Next;
+
+    Settle = ApplyEvents() ? ReplaySettlePasses : Settle - 1;
+    ReplayPasses++;
+
+    return 1;
+}
+
+/*
+* Function: TraceReplayAdvance
+* --------------------------------
+* Advances the replayed time without a loop pass, as happens while the
+* controller waits in Delay. Inputs that change during the wait are
+* applied at its end.
+*
+* Ticks: The number of counter ticks to advance by.
+*/
+
+void TraceReplayAdvance(unsigned int Ticks)
+{
+
+    if (ReplayFile == NULL)
+    {
+        return;
+    }
+
+    ReplayTime += Ticks;
+    ApplyEvents();
+
+}
+
+/*
+* Function: TraceReplayStop
+* --------------------------------
+* Closes the replayed trace and prints how much was replayed and how
+* long it took.
+*/
+
+void TraceReplayStop(void)
+{
+
+    double Seconds; // Processor time taken by the replay
+
+    if (ReplayFile == NULL)
+    {
+        return;
+    }
+
+    Seconds = (double)(clock() - ReplayStartClock)/CLOCKS_PER_SEC;
+    fprintf(stderr, "replay: %llu records, %llu passes, %.3f s of trace in %.3f s\n",
+            ReplayRecords, ReplayPasses, (double)ReplayTime/ClockFrequency, Seconds);
+
+    fclose(ReplayFile);
+    ReplayFile = NULL;
+
+}
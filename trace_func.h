@@ -0,0 +1,56 @@
+/*
+*  trace_func.h
+*  trace functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ---------------------------------------------------------------- */
+/* HEADER FILE FOR FUNCTIONS USED TO RECORD AND REPLAY BOARD INPUTS */
+/* ---------------------------------------------------------------- */
+
+#ifndef TRACE_FUNC_H
+#define TRACE_FUNC_H
+
+// Trace file layout
+#define TraceMagic "FANTRACE"   // First eight bytes of every trace file
+#define TraceVersion 1          // Version of the record format
+#define TraceHeaderSize 16      // Magic, version, three reserved bytes and the clock frequency
+
+// Record tags; a plain record has a tag made of the change bits
+#define TraceGpio 0x01          // Record carries a change of * GpioPort
+#define TraceSwitches 0x02      // Record carries a change of * Switches
+#define TraceKeys 0x04          // Record carries a change of * Keys
+#define TraceRepeat 0x80        // Record repeats the pattern of the last 1-4 records
+#define TraceMaxPeriod 4        // Longest repeated pattern
+
+// FUNCTION DECLARATIONS //
+
+int TraceRecordStart(const char *);    // Opens a trace file and starts recording
+                                       // the board inputs.
+
+
+void TraceRecord(void);    // Records any change of the board inputs since
+                           // the previous call.
+
+
+void TraceRecordStop(void);    // Writes any buffered records and closes the
+                               // trace file.
+
+
+int TraceReplayStart(const char *, unsigned int);    // Opens a trace file and prepares
+                                                     // it for replay.
+
+
+int TraceReplayPoll(void);    // Advances the replayed time by one loop pass and
+                              // applies any inputs that changed.
+
+
+void TraceReplayAdvance(unsigned int);    // Advances the replayed time by a number
+                                          // of counter ticks.
+
+
+void TraceReplayStop(void);    // Closes the replayed trace file and prints a
+                               // summary.
+
+#endif
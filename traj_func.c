@@ -0,0 +1,252 @@
+/*
+*  traj_func.c
+*  trajectory functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO PLAN SMOOTH SPEED CHANGES        */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include "traj_func.h"
+
+// Including other necessary custom headers
+#include "time_func.h"
+#include "globals.h"
+
+// Length of one trajectory step in seconds
+#define TrajStep ((float)TrajStepTicks/ClockFrequency)
+
+static int FeedForward = 0;                 // Set if the feed-forward is turned on
+static float Position = 0.0f;               // Planned desired speed (units)
+static float Velocity = 0.0f;               // Rate of change of the planned speed (units/s)
+static float Acceleration = 0.0f;           // Rate of change of Velocity (units/s^2)
+static float MeasuredRate = TrajDefaultRate;    // Fastest speed change of the fan seen so far (units/s)
+static int Settling = TrajSettleWindows;    // Windows left to ignore before learning
+static int PrevSpeed = 0;                   // Measured speed in the previous window (units)
+static struct TimeWindow Step;              // Current trajectory step
+static struct TimeWindow Window;            // Current half-second window
+
+/*
+* Function: Limit
+* --------------------------------
+* Limits the size of a value while keeping its sign.
+*
+* Value: The value to limit.
+* Largest: The largest size allowed (positive).
+*
+* Returns: The limited value.
+*/
+
+static float Limit(float Value, float Largest)
+{
+
+    if (Value > Largest)
+    {
+        return Largest;
+    }
+    if (Value < -Largest)
+    {
+        return -Largest;
+    }
+    return Value;
+}
+
+/*
+* Function: Magnitude
+* --------------------------------
+* Gives the size of a value, ignoring its sign.
+*
+* Value: The value.
+*
+* Returns: The size of Value.
+*/
+
+static float Magnitude(float Value)
+{
+
+    return (Value < 0.0f) ? -Value : Value;
+}
+
+/*
+* Function: SquareRoot
+* --------------------------------
+* Works out a square root by Newton's method, so that the controller
+* does not need the maths library. Accurate to float precision for the
+* range of values used here.
+*
+* Value: The value (0 or more).
+*
+* Returns: The square root of Value.
+*/
+
+static float SquareRoot(float Value)
+{
+
+    float Root = (Value > 1.0f) ? Value : 1.0f; // Starting guess, above the root
+    int i;
+
+    if (Value <= 0.0f)
+    {
+        return 0.0f;
+    }
+
+    for (i = 0; i < 24; i++)
+    {
+        Root = 0.5f*(Root + Value/Root);
+    }
+
+    return Root;
+}
+
+/*
+* Function: TrajectoryConfig
+* --------------------------------
+* Turns the derivative feed-forward on or off (it is off by default).
+*
+* On: 1 to add TrajectoryFeedForward to the on-time, 0 otherwise.
+*/
+
+void TrajectoryConfig(int On)
+{
+
+    FeedForward = On;
+
+}
+
+/*
+* Function: TrajectoryReset
+* --------------------------------
+* Restarts the trajectory from a fan turning steadily at a speed, as
+* when a mode is selected: from 0 for a stationary fan, or from the
+* measured speed for a bumpless transfer. The measured acceleration of
+* the fan is kept.
+*
+* Speed: The speed the plan starts from (0-50).
+*/
+
+void TrajectoryReset(int Speed)
+{
+
+    Position = (float)Speed;
+    Velocity = 0.0f;
+    Acceleration = 0.0f;
+    PrevSpeed = Speed;
+    Settling = TrajSettleWindows;
+
+}
+
+/*
+* Function: Trajectory
+* --------------------------------
+* Moves the planned desired speed towards the target along an S-curve:
+* the rate of change of the speed is limited to what the fan has been
+* measured to manage, its acceleration and jerk are limited so that it
+* builds up and dies away smoothly, and it is slowed early enough to
+* arrive at the target without overshooting. The plan advances in
+* fixed steps of TrajStepTicks, so it does not depend on the loop rate.
+*
+* Every half-second the measured speed change is used to learn how
+* quickly the fan can change speed; the limits follow from it.
+*
+* Target: The desired speed set by the user (0-50).
+* RPS: The measured speed of the fan in RPS.
+*
+* Returns: The planned desired speed (0-50) to give the controller.
+*/
+
+int Trajectory(int Target, int RPS)
+{
+
+    int Speed = (RPS*50)/MaxRPS; // Measured speed (0-50)
+    float RateLimit; // Largest rate of change of the planned speed
+    float AccelLimit; // Largest acceleration of the planned speed
+    float Jerk; // Largest jerk of the planned speed
+    float Distance; // Distance from the planned speed to the target
+    float Braking; // Fastest rate from which the plan can still stop at the target
+    float DesiredRate; // Rate the plan should be moving at
+    float DesiredAccel; // Acceleration the plan should have
+
+    // Learning how quickly the fan changes speed
+    if (TimeWindowUpdate(&Window, ClockFrequency/2))
+    {
+        if (Settling > 0)
+        {
+            Settling--;
+        }
+        else if ((float)abs(Speed - PrevSpeed)*2 > MeasuredRate)
+        {
+            MeasuredRate = (float)abs(Speed - PrevSpeed)*2;
+        }
+        PrevSpeed = Speed;
+    }
+
+    RateLimit = MeasuredRate*TrajRateMargin;
+    RateLimit = (RateLimit < TrajMinRate) ? TrajMinRate : RateLimit;
+    RateLimit = (RateLimit > TrajMaxRate) ? TrajMaxRate : RateLimit;
+    AccelLimit = RateLimit/TrajRiseTime;
+    Jerk = AccelLimit/TrajRiseTime;
+
+    if (!TimeWindowUpdate(&Step, TrajStepTicks))
+    {
+        return (int)(Position + 0.5f);
+    }
+
+    // Finding the fastest rate from which the plan can still come to
+    // rest at the target, allowing for the time taken to bring the
+    // acceleration back to zero
+    Distance = Target - Position;
+    Braking = 0.5f*(-AccelLimit*AccelLimit/Jerk +
+                    SquareRoot(AccelLimit*AccelLimit*AccelLimit*AccelLimit/(Jerk*Jerk) + 8.0f*AccelLimit*Magnitude(Distance)));
+    DesiredRate = Limit((Distance < 0) ? -Braking : Braking, RateLimit);
+
+    // Finding the acceleration that reaches that rate without
+    // overshooting it, then moving towards it at the jerk limit
+    DesiredAccel = SquareRoot(2.0f*Jerk*Magnitude(DesiredRate - Velocity));
+    DesiredAccel = Limit((DesiredRate < Velocity) ? -DesiredAccel : DesiredAccel, AccelLimit);
+    Acceleration += Limit(DesiredAccel - Acceleration, Jerk*TrajStep);
+
+    Velocity += Acceleration*TrajStep;
+    Position += Velocity*TrajStep;
+
+    // Arriving at the target once the plan would pass it or has all
+    // but stopped next to it
+    if ((Distance > 0 && Position >= Target) || (Distance < 0 && Position <= Target) ||
+        (Magnitude(Target - Position) < 0.05f && Magnitude(Velocity) < AccelLimit*TrajStep))
+    {
+        Position = Target;
+        Velocity = 0.0f;
+        Acceleration = 0.0f;
+    }
+
+    return (int)(Position + 0.5f);
+}
+
+/*
+* Function: TrajectoryFeedForward
+* --------------------------------
+* Gives the on-time that anticipates the planned change in speed, so
+* that the controller does not have to wait for an error to build up
+* before the fan starts to accelerate. Zero unless turned on with
+* TrajectoryConfig.
+*
+* Returns: The on-time to add (may be negative).
+*/
+
+int TrajectoryFeedForward(void)
+{
+
+    if (!FeedForward)
+    {
+        return 0;
+    }
+
+    return (int)(Kff*Velocity);
+}
@@ -0,0 +1,40 @@
+/*
+*  traj_func.h
+*  trajectory functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO PLAN SMOOTH SPEED CHANGES        */
+/* ------------------------------------------------------------------ */
+
+#ifndef TRAJ_FUNC_H
+#define TRAJ_FUNC_H
+
+// Trajectory constants (speeds in desired-speed units, 0-50)
+#define TrajStepTicks 500000        // Counter ticks per trajectory step (10 ms)
+#define TrajDefaultRate 20.0f       // Fan acceleration assumed until one is measured (units/s)
+#define TrajMinRate 5.0f            // Lowest speed slew the planner will use (units/s)
+#define TrajMaxRate 100.0f          // Highest speed slew the planner will use (units/s)
+#define TrajRateMargin 0.8f         // Share of the measured fan acceleration used as the slew limit
+#define TrajRiseTime 0.25f          // Time to reach the slew limit, and to reach full acceleration (s)
+#define TrajSettleWindows 2         // Half-second windows ignored after a reset before learning
+
+// FUNCTION DECLARATIONS //
+
+void TrajectoryConfig(int);    // Turns the derivative feed-forward on
+                               // or off.
+
+
+void TrajectoryReset(int);    // Restarts the trajectory from a steady speed.
+
+
+int Trajectory(int, int);    // Moves the planned desired speed towards
+                             // the target with limited acceleration and jerk.
+
+
+int TrajectoryFeedForward(void);    // Gives the on-time to add for the rate
+                                    // of change of the planned speed.
+
+#endif
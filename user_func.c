@@ -19,13 +19,17 @@
 // Including other necessary custom headers
 #include "disp_func.h"
 #include "misc_func.h"
+#include "autof_func.h"
 #include "globals.h"
 
 /*
 * Function: ModeSelect
 * --------------------------------
 * Uses the keys on the FPGA (*Keys) to determine what operating mode
-* should be selected. Resets the values of DutyCycle and RPS when a
+* should be selected. Pressing KEY2 and KEY3 together selects the
+* thermostatic mode, pressing KEY1 and KEY2 together selects the
+* frequency-response mode and pressing KEY1 and KEY3 together selects
+* the predictive mode. Resets the values of DutyCycle and RPS when a
 * new mode is selected and displays the mode name on the seven-segment
 * displays.
 *
@@ -41,7 +45,7 @@
 int ModeSelect(int Mode, int *DutyCycle, int *RPS, int *ResetClosed)
 {
 
-    int ModeArray[4] = {0, 1, 2, 3}; // Array of all possible modes
+    int ModeArray[7] = {0, 1, 2, 3, 4, 5, 6}; // Array of all possible modes
     int SegArray[6]; // Array to hold segment values
     static int PrevMode; // Previously selected mode
 
@@ -138,6 +142,73 @@ int ModeSelect(int Mode, int *DutyCycle, int *RPS, int *ResetClosed)
 			ScrollDisplay(SegArray);
         }
         break;
+    // Thermostatic
+    case key23:
+    	// Setting mode to 5th item in the array
+        Mode = ModeArray[4];
+
+        // Checking if the mode has been changed
+        if (Mode != PrevMode)
+        {
+        	// Resetting variables to initial conditions
+        	Set(DutyCycle, 0);
+			Set(RPS, 0);
+			Set(ResetClosed, 1);
+
+			// tHErnO displayed on seven-segment displays (scrolls right to left)
+			SegArray[0] = segT;
+			SegArray[1] = segH;
+			SegArray[2] = segE;
+			SegArray[3] = segR;
+			SegArray[4] = segN;
+			SegArray[5] = segO;
+			ScrollDisplay(SegArray);
+        }
+        break;
+    // Frequency response
+    case key12:
+    	// Setting mode to 6th item in the array
+        Mode = ModeArray[5];
+
+        // Checking if the mode has been changed
+        if (Mode != PrevMode)
+        {
+        	// Resetting variables to initial conditions
+        	Set(DutyCycle, 0);
+			Set(RPS, 0);
+
+			// bOdE displayed on seven-segment displays (scrolls right to left)
+			SegArray[0] = segB;
+			SegArray[1] = segO;
+			SegArray[2] = segD;
+			SegArray[3] = segE;
+			SegArray[4] = segBlank;
+			SegArray[5] = segBlank;
+			ScrollDisplay(SegArray);
+        }
+        break;
+    // Predictive
+    case key13:
+    	// Setting mode to 7th item in the array
+        Mode = ModeArray[6];
+
+        // Checking if the mode has been changed
+        if (Mode != PrevMode)
+        {
+        	// Resetting variables to initial conditions
+        	Set(DutyCycle, 0);
+			Set(RPS, 0);
+
+			// PrEd displayed on seven-segment displays (scrolls right to left)
+			SegArray[0] = segP;
+			SegArray[1] = segR;
+			SegArray[2] = segE;
+			SegArray[3] = segD;
+			SegArray[4] = segBlank;
+			SegArray[5] = segBlank;
+			ScrollDisplay(SegArray);
+        }
+        break;
     default:
         break;
     }
@@ -158,6 +229,8 @@ int ModeSelect(int Mode, int *DutyCycle, int *RPS, int *ResetClosed)
 *
 * Returns: PWMFrequency, the PWM frequency that was selected
 * based on which switches are flipped.
+* It is left as it was when the frequency is to be chosen
+* automatically (see AutofTick).
 */
 
 int FreqSelect(int Switches4to0, int PWMFrequency)
@@ -171,26 +244,28 @@ int FreqSelect(int Switches4to0, int PWMFrequency)
     switch (Switches4to0)
     {
     case 0b00001:
-        PWMFrequency = 100;
+        PWMFrequency = FreqChoices[1];
         break;
     case 0b00011:
-        PWMFrequency = 1000;
+        PWMFrequency = FreqChoices[2];
         break;
     case 0b00111:
-        PWMFrequency = 3000;
+        PWMFrequency = FreqChoices[3];
         break;
     case 0b01111:
-        PWMFrequency = 5000;
+        PWMFrequency = FreqChoices[4];
         break;
     case 0b11111:
-        PWMFrequency = 7500;
+        PWMFrequency = FreqChoices[5];
         break;
+    case AutofSwitches:
+        break; // Chosen by AutofTick
     default:
-        PWMFrequency = 10;
+        PWMFrequency = FreqChoices[0];
         break;
     }
 
-    if (CurrentSwitches != PrevSwitches)
+    if (CurrentSwitches != PrevSwitches && CurrentSwitches != AutofSwitches)
     {
         // Displaying the frequency selected by the user if a change is made
         *Hex5to4 = segF << 8 | segBlank;
@@ -229,19 +304,19 @@ int RespSelect(int Switches8to5, int Responsiveness)
     switch (Switches8to5)
     {
     case 0b0001:
-        Responsiveness = 2;
+        Responsiveness = RespChoices[1];
         break;
     case 0b0011:
-        Responsiveness = 5;
+        Responsiveness = RespChoices[2];
         break;
     case 0b0111:
-        Responsiveness = 10;
+        Responsiveness = RespChoices[3];
         break;
     case 0b1111:
-        Responsiveness = 20;
+        Responsiveness = RespChoices[4];
         break;
     default:
-        Responsiveness = 1;
+        Responsiveness = RespChoices[0];
         break;
     }
 
@@ -0,0 +1,232 @@
+/*
+*  wdog_func.c
+*  overrun watchdog functions source file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* SOURCE FILE FOR FUNCTIONS USED TO DETECT OVERRUNS AND SHED LOAD    */
+/* ------------------------------------------------------------------ */
+
+#include "EE30186.h"
+#include "system.h"
+#include "socal/socal.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include "wdog_func.h"
+
+// Including other necessary custom headers
+#include "board_func.h"
+#include "time_func.h"
+#include "globals.h"
+
+static struct WdogStats Stats;              // Miss counters and shedding level
+static int Split;                           // Set once the user interface has a thread of its own
+static int Current = WdogIdle;              // Stage running since the last mark
+static unsigned long long Deadline;         // Time by which the next control pass is needed
+static unsigned long long Slack;            // Lateness allowed before a deadline counts as missed
+static int Blamed = 1;                      // Set once the current deadline has been missed
+static struct TimeWindow Window;            // Current window of WdogWindowTicks
+static unsigned int WindowMisses;           // Misses in the current window
+static int CleanWindows;                    // Windows in a row within WdogRecoverLimit
+static unsigned long long NextRun[WdogStages];  // Next time each shed stage may run
+
+/*
+* Function: WdogNow
+* --------------------------------
+* Reads the time as it is now rather than at the start of the pass (see
+* TimeNow), without moving the time base.
+*
+* Returns: The current time in counter ticks.
+*/
+
+static unsigned long long WdogNow(void)
+{
+
+    unsigned long long Pass = TimeNow();
+
+    return Pass + (unsigned int)(BoardTicks() - (unsigned int)Pass);
+}
+
+/*
+* Function: WdogSplit
+* --------------------------------
+* Called when the user interface moves to a thread of its own. Its
+* stages can then no longer hold up the control path, so they are not
+* marked (and WdogBegin is only called from the control thread).
+*/
+
+void WdogSplit(void)
+{
+
+    Split = 1;
+
+}
+
+/*
+* Function: WdogBegin
+* --------------------------------
+* Marks the start of a stage of the loop pass. If the deadline of the
+* control path has passed by more than its slack since the previous
+* mark, the miss is blamed on the stage that was running. Costs one
+* read of the counter.
+*
+* Stage: The stage that is starting (WdogControl to WdogIdle).
+*/
+
+void WdogBegin(int Stage)
+{
+
+    if (Split && Stage >= WdogUi && Stage <= WdogDisplay)
+    {
+        return;
+    }
+
+    if (!Blamed && WdogNow() > Deadline + Slack)
+    {
+        Stats.Misses[Current]++;
+        WindowMisses++;
+        Blamed = 1;
+    }
+
+    Current = Stage;
+
+}
+
+/*
+* Function: WdogDeadline
+* --------------------------------
+* Called at the end of every pass of the control path, after the stage
+* of the control path has been marked, with the time the next pass is
+* needed by. A pass may start up to one percent of a PWM period late
+* before the duty cycle is distorted, so that is the slack allowed. A
+* deadline that has already passed comes from a pass that started late
+* because of an earlier miss, so it is not counted again. Once per
+* window the shedding level is raised if there were more than
+* WdogMissLimit misses, or lowered after WdogRecoverWindows windows in
+* a row with at most WdogRecoverLimit (the odd late wake-up of the
+* processor is not load that shedding would remove).
+*
+* Next: The deadline of the next pass in counter ticks.
+* PWMFrequency: The PWM frequency in Hz, or 0 while the fan is off (no
+* misses are counted then).
+*/
+
+void WdogDeadline(unsigned long long Next, int PWMFrequency)
+{
+
+    int Level = Stats.Level;
+
+    Deadline = Next;
+    Slack = (PWMFrequency > 0) ? TimePeriod(PWMFrequency)/100 : 0;
+    Blamed = (PWMFrequency <= 0) || (WdogNow() > Deadline + Slack);
+
+    if (TimeWindowUpdate(&Window, WdogWindowTicks))
+    {
+        if (WindowMisses > WdogMissLimit)
+        {
+            Level = (Level < WdogShedFrequency) ? Level + 1 : Level;
+            CleanWindows = 0;
+        }
+        else if (WindowMisses <= WdogRecoverLimit && ++CleanWindows >= WdogRecoverWindows)
+        {
+            Level = (Level > WdogShedNone) ? Level - 1 : Level;
+            CleanWindows = 0;
+        }
+        else if (WindowMisses > WdogRecoverLimit)
+        {
+            CleanWindows = 0;
+        }
+        WindowMisses = 0;
+        __atomic_store_n(&Stats.Level, Level, __ATOMIC_RELAXED);
+    }
+
+}
+
+/*
+* Function: WdogAllow
+* --------------------------------
+* Reports whether a stage should run in this pass. Stages that have
+* been shed run once every WdogSlowTicks; the others run on every pass.
+* The display and LED stages are asked from the user interface and the
+* metrics stage from the control path, so each is only asked from one
+* thread.
+*
+* Stage: WdogDisplay, WdogLeds or WdogMetrics.
+*
+* Returns: 1 if the stage should run or 0 if it should be skipped.
+*/
+
+int WdogAllow(int Stage)
+{
+
+    int Level = __atomic_load_n(&Stats.Level, __ATOMIC_RELAXED);
+    int Shed = (Stage == WdogDisplay && Level >= WdogShedDisplay) ||
+               (Stage == WdogLeds && Level >= WdogShedLeds) ||
+               (Stage == WdogMetrics && Level >= WdogShedMetrics);
+
+    if (!Shed)
+    {
+        return 1;
+    }
+    if (!TimeReached(NextRun[Stage]))
+    {
+        return 0;
+    }
+
+    NextRun[Stage] = TimeNow() + WdogSlowTicks;
+
+    return 1;
+}
+
+/*
+* Function: WdogFrequency
+* --------------------------------
+* Gives the PWM frequency to use. At the last shedding level it is
+* stepped down to the next lower frequency the switches can select
+* (FreqChoices), which gives every percent of the duty cycle more
+* counter ticks and so more room for late passes, while the displays
+* still show a frequency of the table. The lowest frequency is kept.
+*
+* PWMFrequency: The selected PWM frequency in Hz.
+*
+* Returns: The PWM frequency to use in Hz.
+*/
+
+int WdogFrequency(int PWMFrequency)
+{
+
+    int Lower = 0; // Highest frequency of the table below the selected one
+    int Choice;
+    int i;
+
+    if (__atomic_load_n(&Stats.Level, __ATOMIC_RELAXED) < WdogShedFrequency)
+    {
+        return PWMFrequency;
+    }
+
+    // The table belongs to the user interface (see ParamApply)
+    for (i = 0; i < FreqChoiceCount; i++)
+    {
+        Choice = __atomic_load_n(&FreqChoices[i], __ATOMIC_RELAXED);
+        Lower = (Choice < PWMFrequency && Choice > Lower) ? Choice : Lower;
+    }
+
+    return (Lower > 0) ? Lower : PWMFrequency;
+}
+
+/*
+* Function: WdogStatsGet
+* --------------------------------
+* Gives access to the miss counters and shedding level, for the
+* metrics page.
+*
+* Returns: A pointer to the statistics, updated in place.
+*/
+
+const struct WdogStats *WdogStatsGet(void)
+{
+
+    return &Stats;
+}
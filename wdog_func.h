@@ -0,0 +1,75 @@
+/*
+*  wdog_func.h
+*  overrun watchdog functions header file
+*
+*  Last modified on 13/12/19.
+*/
+
+/* ------------------------------------------------------------------ */
+/* HEADER FILE FOR FUNCTIONS USED TO DETECT OVERRUNS AND SHED LOAD    */
+/* ------------------------------------------------------------------ */
+
+#ifndef WDOG_FUNC_H
+#define WDOG_FUNC_H
+
+// Stages of a loop pass that deadline misses are blamed on
+#define WdogControl 0       // Control path (ControlTick)
+#define WdogUi 1            // Keys, switches and mode selection
+#define WdogLeds 2          // LED update
+#define WdogIpc 3           // External clients
+#define WdogDisplay 4       // Seven-segment displays
+#define WdogMetrics 5       // Metrics page
+#define WdogIdle 6          // Idling and polling the board
+#define WdogStages 7
+
+// Load shedding levels; each level also sheds the work of the levels below it
+#define WdogShedNone 0          // Everything runs on every pass
+#define WdogShedDisplay 1       // The displays are refreshed every WdogSlowTicks
+#define WdogShedLeds 2          // The LEDs are updated every WdogSlowTicks
+#define WdogShedMetrics 3       // The metrics page is published every WdogSlowTicks
+#define WdogShedFrequency 4     // The PWM frequency steps down to the next one of FreqChoices
+
+// Watchdog constants
+#define WdogSlowTicks 5000000       // Period of shed work (100 ms)
+#define WdogWindowTicks 25000000    // Window over which misses are counted (500 ms)
+#define WdogMissLimit 10            // Misses in a window that shed one more level
+#define WdogRecoverLimit 5          // Misses in a window that still count towards recovery
+#define WdogRecoverWindows 4        // Windows in a row within WdogRecoverLimit that restore one level
+
+/*
+* Deadline misses counted by the watchdog and the current level of
+* load shedding. The counters wrap around.
+*/
+
+struct WdogStats
+{
+    unsigned int Misses[WdogStages];    // Misses blamed on each stage
+    int Level;                          // Current load shedding level
+};
+
+// FUNCTION DECLARATIONS //
+
+void WdogSplit(void);    // Stops blaming the stages of the user interface,
+                         // once it runs in a thread of its own.
+
+
+void WdogBegin(int);    // Marks the start of a stage and blames the previous
+                        // stage if the deadline passed while it ran.
+
+
+void WdogDeadline(unsigned long long, int);    // Sets the deadline of the next pass
+                                               // and adjusts the shedding level.
+
+
+int WdogAllow(int);    // Reports whether a stage that can be shed should
+                       // run in this pass.
+
+
+int WdogFrequency(int);    // Gives the PWM frequency to use at the current
+                           // shedding level.
+
+
+const struct WdogStats *WdogStatsGet(void);    // Gives access to the miss counters
+                                               // and shedding level.
+
+#endif